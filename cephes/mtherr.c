@@ -59,6 +59,11 @@ Direct inquiries to 30 Frost Street, Cambridge, MA 02140
 
 static int cephes_errno = 0;
 
+#if defined(_OPENMP)
+/* the cephes functions may be called from parallel loops */
+#pragma omp threadprivate(cephes_errno)
+#endif
+
 /* Notice: the order of appearance of the following
  * messages is bound to the error codes defined
  * in mconf.h.
@@ -1613,6 +1613,8 @@ static void update_dataset_from_sheet (Spreadsheet *sheet)
 	}
     }
 
+    /* existing series may have been edited */
+    gretl_transforms_invalidate();
     register_data(DATA_APPENDED);
 
     if (missobs) {
@@ -6184,6 +6184,9 @@ int gretl_join_data (const char *fname,
 	if (add_v || modified) {
 	    dset->modflag = 1;
 	}
+	if (modified) {
+	    gretl_transforms_invalidate();
+	}
 	if (gretl_messages_on()) {
 	    if (add_v) {
 		pputs(prn, _("Data appended OK\n"));
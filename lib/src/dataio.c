@@ -2062,6 +2062,8 @@ int merge_or_replace_data (DATASET *dset0, DATASET **pdset1,
 	}
 	err = merge_data(dset0, *pdset1, merge_opt, prn);
 	destroy_dataset(*pdset1);
+	/* existing series may have been modified */
+	gretl_transforms_invalidate();
     } else {
 	/* starting from scratch */
 	*dset0 = **pdset1;
@@ -111,6 +111,7 @@ void free_Z (DATASET *dset)
 	}
 	free(dset->Z);
 	dset->Z = NULL;
+	gretl_transforms_invalidate();
     }
 }
 
@@ -1435,6 +1436,9 @@ static int shrink_dataset_to_size (DATASET *dset, int nv, int drop)
 	dset->varinfo = varinfo;
     }
 
+    /* series IDs are liable to be reused */
+    gretl_transforms_invalidate();
+
     newZ = realloc(dset->Z, nv * sizeof *newZ); 
     if (newZ == NULL) {
 	return E_ALLOC;
@@ -1575,6 +1579,7 @@ int dataset_replace_series (DATASET *dset, int v,
 
     gretl_varinfo_init(dset->varinfo[v]);
     series_set_label(dset, v, descrip);
+    gretl_transforms_invalidate();
 
     if (flag == DS_GRAB_VALUES) {
 	free(dset->Z[v]);
@@ -1627,6 +1632,7 @@ int dataset_replace_series_data (DATASET *dset, int v,
 
     gretl_varinfo_init(dset->varinfo[v]);
     series_set_label(dset, v, descrip);
+    gretl_transforms_invalidate();
 
     s = 0;
     for (t=t1; t<=t2; t++) {
@@ -2272,6 +2278,8 @@ int dataset_sort_by (DATASET *dset, const int *list, gretlopt opt)
 	qsort(sv, dset->n, sizeof *sv, compare_vals_up);
     }
 
+    gretl_transforms_invalidate();
+
     for (i=1; i<dset->v; i++) {
 	for (t=0; t<dset->n; t++) {
 	    x[t] = dset->Z[i][sv[t].obsnum];
@@ -2822,6 +2830,7 @@ int dataset_stack_variables (const char *vname, const char *line,
 	free(dset->Z[genv]);
 	dset->Z[genv] = bigx;
 	gretl_varinfo_init(dset->varinfo[genv]);
+	gretl_transforms_invalidate();
     }
     
     /* complete the details */
@@ -50,6 +50,7 @@ struct op_container_ {
     int ci;           /* model command index (PROBIT or LOGIT) */
     gretlopt opt;     /* option flags */
     int *y;           /* dependent variable */
+    int *tidx;        /* dataset index of each observation used */
     double **Z;       /* data */
     int *list;        /* dependent var plus regular regressors */
     int ymax;         /* max of (possibly normalized) y */
@@ -98,9 +99,13 @@ static double lp_pdf (double x, int ci)
     }
 }
 
+/* rows per chunk within blocks handled by ll_block_sum() */
+#define LL_CHUNK 256
+
 static void op_container_destroy (op_container *OC)
 {
     free(OC->y);
+    free(OC->tidx);
     free(OC->ndx);
     free(OC->dP);
     free(OC->list);
@@ -138,6 +143,7 @@ static op_container *op_container_new (int ci, int ndum,
     OC->opt = opt;
 
     OC->y = NULL;
+    OC->tidx = NULL;
     OC->ndx = NULL;
     OC->dP = NULL;
     OC->list = NULL;
@@ -145,6 +151,7 @@ static op_container *op_container_new (int ci, int ndum,
     OC->g = NULL;
 
     OC->y = malloc(nobs * sizeof *OC->y);
+    OC->tidx = malloc(nobs * sizeof *OC->tidx);
     OC->ndx = malloc(nobs * sizeof *OC->ndx);
     OC->dP = malloc(nobs * sizeof *OC->dP);
 
@@ -153,7 +160,7 @@ static op_container *op_container_new (int ci, int ndum,
     OC->g = malloc(OC->k * sizeof *OC->g);
     OC->theta = malloc(OC->k * sizeof *OC->theta);
 
-    if (OC->y == NULL || OC->ndx == NULL || 
+    if (OC->y == NULL || OC->tidx == NULL || OC->ndx == NULL || 
 	OC->dP == NULL || OC->list == NULL ||
 	OC->G == NULL || OC->g == NULL ||
 	OC->theta == NULL) {
@@ -164,6 +171,7 @@ static op_container *op_container_new (int ci, int ndum,
     i = 0;
     for (t=pmod->t1; t<=pmod->t2; t++) {
 	if (!na(pmod->uhat[t])) {
+	    OC->tidx[i] = t;
 	    OC->y[i++] = (int) Z[vy][t];
 	}
     }
@@ -188,7 +196,8 @@ static op_container *op_container_new (int ci, int ndum,
 
 static int op_compute_score (op_container *OC, int yt, 
 			     double ystar0, double ystar1,
-			     double dP, int t, int s)
+			     double dP, int t, int s,
+			     double *g)
 {
     double gsi, dm, mills0, mills1;
     int M = OC->ymax;
@@ -209,7 +218,7 @@ static int op_compute_score (op_container *OC, int yt,
 	v = OC->list[i+2];
 	gsi = -dm * OC->Z[v][t];
 	gretl_matrix_set(OC->G, s, i, gsi);
-	OC->g[i] += gsi;
+	g[i] += gsi;
     }
 
     for (i=OC->nx; i<OC->k; i++) {
@@ -217,12 +226,12 @@ static int op_compute_score (op_container *OC, int yt,
 	if (i == OC->nx + yt - 1) {
 	    gsi = -mills0;
 	    gretl_matrix_set(OC->G, s, i, gsi);
-	    OC->g[i] += gsi;
+	    g[i] += gsi;
 	}
 	if (i == OC->nx + yt) {
 	    gsi = mills1;
 	    gretl_matrix_set(OC->G, s, i, gsi);
-	    OC->g[i] += gsi;
+	    g[i] += gsi;
 	}
     }
 
@@ -231,51 +240,58 @@ static int op_compute_score (op_container *OC, int yt,
 
 #define dPMIN 1.0e-15
 
-static int op_compute_probs (const double *theta, op_container *OC)
+/* Compute, for observations @s0 to @s1 - 1, the index function,
+   the probability of the observed outcome and the score, adding
+   the loglikelihood and score contributions to @ll and @g.
+*/
+
+static int op_block (void *data, int s0, int s1,
+		     double *ll, double *g)
 {
-    double m0, m1, ystar0 = 0.0, ystar1 = 0.0;
+    op_container *OC = data;
+    const double *theta = OC->theta;
+    double x, m0, m1, ystar0, ystar1;
     int M = OC->ymax;
     int nx = OC->nx;
     double P0, P1, h, adj, dP;
-    int i, t, s, yt;
+    int i, s, t, yt;
 
-    /* initialize analytical score */
-    for (i=0; i<OC->k; i++) {
-	OC->g[i] = 0.0;
-    }
-
-    s = 0;
-
-    for (t=OC->pmod->t1; t<=OC->pmod->t2; t++) {
-	if (na(OC->pmod->uhat[t])) {
-#if LPDEBUG > 1
-	    fprintf(stderr, "obs %4d excluded\n", t);
-#endif
-	    continue;
+    for (s=s0; s<s1; s++) {
+	t = OC->tidx[s];
+	x = 0.0;
+	for (i=0; i<nx; i++) {
+	    /* the independent variables */
+	    x -= theta[i] * OC->Z[OC->list[i+2]][t];
 	}
+	OC->ndx[s] = x;
 
 	yt = OC->y[s];
+	ystar0 = ystar1 = 0.0;
 
 	if (yt == 0) {
 	    m0 = theta[nx];
-	    ystar1 = OC->ndx[s] + m0;
+	    ystar1 = x + m0;
 	} else {
 	    m0 = theta[nx + yt - 1];
-	    ystar0 = OC->ndx[s] + m0;
+	    ystar0 = x + m0;
 	    if (yt < M) {
 		m1 = theta[nx + yt];
-		ystar1 = OC->ndx[s] + m1;
+		ystar1 = x + m1;
 	    }
 	} 
 
 #if LPDEBUG > 1
 	fprintf(stderr, "t:%4d/%d s=%d y=%d, ndx = %10.6f, ystar0 = %9.7f, ystar1 = %9.7f\n", 
-		t, OC->nobs, s, yt, OC->ndx[s], ystar0, ystar1);
+		t, OC->nobs, s, yt, x, ystar0, ystar1);
 #endif
 
-	if (ystar0 < 6.0 || OC->ci == LOGIT) {
+	if (yt == M) {
+	    /* top category: P1 = 1, and we get 1 - P0 via the
+	       symmetry of the distribution, to preserve precision */
+	    dP = lp_cdf(-ystar0, OC->ci);
+	} else if (ystar0 < 6.0 || OC->ci == LOGIT) {
 	    P0 = (yt == 0)? 0.0 : lp_cdf(ystar0, OC->ci);
-	    P1 = (yt == M)? 1.0 : lp_cdf(ystar1, OC->ci);
+	    P1 = lp_cdf(ystar1, OC->ci);
 	    dP = P1 - P0;
 	} else { 
 	    /* Taylor-based 1st order approximation */
@@ -289,14 +305,13 @@ static int op_compute_probs (const double *theta, op_container *OC)
 	} else {
 #if LPDEBUG
 	    fprintf(stderr, "very small dP at obs %d; y=%d, ndx=%g, dP=%g\n", 
- 		    t, yt, OC->ndx[s], dP);
+ 		    t, yt, x, dP);
 #endif
 	    return 1;
 	} 
 
-	op_compute_score(OC, yt, ystar0, ystar1, dP, t, s);
-
-	s++;
+	op_compute_score(OC, yt, ystar0, ystar1, dP, t, s, g);
+	*ll += log(dP);
     }
 
     return 0;
@@ -342,42 +357,17 @@ static void op_get_real_theta (op_container *OC, const double *theta)
 static double op_loglik (const double *theta, void *ptr)
 {
     op_container *OC = (op_container *) ptr;
-    double x, ll = 0.0;
-    int i, s, t, v;
+    double ll = 0.0;
     int err;
 
     if (theta != OC->theta) {
 	op_get_real_theta(OC, theta);
     }
 
-    s = 0;
-    for (t=OC->t1; t<=OC->t2; t++) {
-	if (na(OC->pmod->uhat[t])) {
-	    continue;
-	}
-	x = 0.0;
-	for (i=0; i<OC->nx; i++) {
-	    /* the independent variables */
-	    v = OC->list[i+2];
-	    x -= OC->theta[i] * OC->Z[v][t];
-	}
-	OC->ndx[s++] = x;
-#if LPDEBUG > 2
-	fprintf(stderr, "t = %d, s = %d, x = %g\n", t, s, x);
-#endif
-    }
-    
-    err = op_compute_probs(OC->theta, OC);
+    err = ll_block_sum(op_block, OC, OC->nobs, OC->k, &ll, OC->g);
 
     if (err) {
 	ll = NADBL;
-    } else {
-	s = 0;
-	for (t=OC->t1; t<=OC->t2; t++) {
-	    if (!na(OC->pmod->uhat[t])) {
-		ll += log(OC->dP[s++]);
-	    }
-	}
     }
 
 #if LPDEBUG > 1
@@ -1471,6 +1461,7 @@ struct mnl_info_ {
     int k;            /* number of coeffs per category */
     int npar;         /* total number of parameters */
     int T;            /* number of observations */
+    int cached;       /* score, probs pertain to @b? (1/0) */
     double *theta;    /* coeffs for Newton/BFGS */
     gretl_matrix_block *B;
     gretl_matrix *y;  /* dependent variable */
@@ -1478,6 +1469,7 @@ struct mnl_info_ {
     gretl_matrix *b;  /* coefficients, matrix form */
     gretl_matrix *Xb; /* coeffs times regressors */
     gretl_matrix *P;  /* probabilities */
+    gretl_matrix *g;  /* score vector */
 };
 
 static void mnl_info_destroy (mnl_info *mnl)
@@ -1499,6 +1491,7 @@ static mnl_info *mnl_info_new (int n, int k, int T)
 	mnl->k = k;
 	mnl->T = T;
 	mnl->npar = k * n;
+	mnl->cached = 0;
 	mnl->theta = malloc(mnl->npar * sizeof *mnl->theta);
 	if (mnl->theta == NULL) {
 	    free(mnl);
@@ -1509,6 +1502,7 @@ static mnl_info *mnl_info_new (int n, int k, int T)
 					&mnl->b, k, n,
 					&mnl->Xb, T, n,
 					&mnl->P, T, n,
+					&mnl->g, k * n, 1,
 					NULL);
 	if (mnl->B == NULL) {
 	    free(mnl->theta);
@@ -1524,104 +1518,147 @@ static mnl_info *mnl_info_new (int n, int k, int T)
     return mnl;
 }
 
-/* compute loglikelihood for multinomial logit */
+/* Compute, for observations @s0 to @s1 - 1, the probabilities
+   of the outcomes, adding the loglikelihood and score contributions
+   to @ll and @g. The probabilities are recorded in mnl->P for use
+   in computing the Hessian.
+*/
 
-static double mn_logit_loglik (const double *theta, void *ptr)
+static int mnl_block (void *data, int s0, int s1,
+		      double *ll, double *g)
 {
-    mnl_info *mnl = (mnl_info *) ptr;
-    double x, xti, ll = 0.0;
-    int yt, i, t;
+    mnl_info *mnl = data;
+    const double *X = mnl->X->val;
+    const double *y = mnl->y->val;
+    const double *Xb = mnl->Xb->val;
+    double *P = mnl->P->val;
+    double den[LL_CHUNK];
+    double w[LL_CHUNK];
+    int T = mnl->T;
+    int c0, c1, i, j, t, yt;
+    double gij;
 
     errno = 0;
 
+    for (c0=s0; c0<s1 && !errno; c0+=LL_CHUNK) {
+	c1 = c0 + LL_CHUNK < s1 ? c0 + LL_CHUNK : s1;
+	for (t=c0; t<c1; t++) {
+	    den[t-c0] = 1.0;
+	}
+	for (i=0; i<mnl->n; i++) {
+	    for (t=c0; t<c1; t++) {
+		P[i*T+t] = exp(Xb[i*T+t]);
+		den[t-c0] += P[i*T+t];
+	    }
+	}
+	for (t=c0; t<c1; t++) {
+	    *ll -= log(den[t-c0]);
+	    yt = y[t];
+	    if (yt > 0) {
+		*ll += Xb[(yt-1)*T+t];
+	    }
+	}
+	for (i=0; i<mnl->n; i++) {
+	    for (t=c0; t<c1; t++) {
+		P[i*T+t] /= den[t-c0];
+		w[t-c0] = ((int) y[t] == i + 1) - P[i*T+t];
+	    }
+	    for (j=0; j<mnl->k; j++) {
+		gij = 0.0;
+		for (t=c0; t<c1; t++) {
+		    gij += w[t-c0] * X[j*T+t];
+		}
+		g[i*mnl->k+j] += gij;
+	    }
+	}
+    }
+
+    return errno ? E_NAN : 0;
+}
+
+/* compute loglikelihood for multinomial logit: the score and
+   outcome probabilities are computed in the same pass */
+
+static double mn_logit_loglik (const double *theta, void *ptr)
+{
+    mnl_info *mnl = (mnl_info *) ptr;
+    double ll = 0.0;
+    int i, err;
+
     for (i=0; i<mnl->npar; i++) {
 	mnl->b->val[i] = theta[i];
     }
 
     gretl_matrix_multiply(mnl->X, mnl->b, mnl->Xb);
 
-    for (t=0; t<mnl->T && !errno; t++) {
-	x = 1.0;
-	for (i=0; i<mnl->n; i++) {
-	    /* sum row i of exp(Xb) */
-	    xti = exp(gretl_matrix_get(mnl->Xb, t, i));
-	    x += xti;
-	}
-	ll -= log(x);
-	yt = gretl_vector_get(mnl->y, t);
-	if (yt > 0) {
-	    ll += gretl_matrix_get(mnl->Xb, t, yt-1);
-	}
+    err = ll_block_sum(mnl_block, mnl, mnl->T, mnl->npar,
+		       &ll, mnl->g->val);
+    mnl->cached = !err;
+
+    return err ? NADBL : ll;
+}
+
+/* ensure that the cached score and probabilities pertain
+   to @theta, and that the evaluation which produced them
+   succeeded */
+
+static int mnl_sync (const double *theta, mnl_info *mnl)
+{
+    int i;
+
+    if (!mnl->cached) {
+	return na(mn_logit_loglik(theta, mnl)) ? E_NAN : 0;
     }
 
-    if (errno != 0) {
-	ll = NADBL;
+    for (i=0; i<mnl->npar; i++) {
+	if (theta[i] != mnl->b->val[i]) {
+	    return na(mn_logit_loglik(theta, mnl)) ? E_NAN : 0;
+	}
     }
 
-    return ll;
+    return 0;
 }
 
 static int mn_logit_score (double *theta, double *s, int npar, 
 			   BFGS_CRIT_FUNC ll, void *ptr)
 {
     mnl_info *mnl = (mnl_info *) ptr;
-    double x, xti, pti, p, g;
-    int i, j, k, t, yt;
-    int err = 0;
+    int i, err;
 
-    errno = 0;
-
-    for (i=0; i<npar; i++) {
-	s[i] = 0.0;
-    }
+    err = mnl_sync(theta, mnl);
 
-    for (t=0; t<mnl->T && !errno; t++) {
-	x = 1.0;
-	for (i=0; i<mnl->n; i++) {
-	    /* sum row i of exp(Xb) */
-	    xti = exp(gretl_matrix_get(mnl->Xb, t, i));
-	    x += xti;
-	    gretl_matrix_set(mnl->P, t, i, xti);
-	}
-
-	if (!errno) {
-	    yt = gretl_vector_get(mnl->y, t);
-	    k = 0;
-	    for (i=0; i<mnl->n; i++) {
-		pti = gretl_matrix_get(mnl->P, t, i) / x;
-		gretl_matrix_set(mnl->P, t, i, pti);
-		p = (i == (yt-1)) - pti;
-		for (j=0; j<mnl->k; j++) {
-		    g = p * gretl_matrix_get(mnl->X, t, j);
-		    s[k++] += g;
-		}
-	    }
+    if (!err) {
+	for (i=0; i<npar; i++) {
+	    s[i] = mnl->g->val[i];
 	}
     }
 
-    if (errno != 0) {
-	err = E_NAN;
-    }
-
     return err;
 }
 
 /* multinomial logit: form the negative of the analytical
-   Hessian */
+   Hessian, block by block, as X' diag(w) X for suitable
+   weights w */
 
 static int mnl_hessian (double *theta, gretl_matrix *H, void *data)
 {
     mnl_info *mnl = data;
     gretl_matrix_block *B;
-    gretl_matrix *x;
-    gretl_matrix *xx;
+    gretl_matrix *wX;
     gretl_matrix *hjk;
-    double xti, ptj, ptk;
+    const double *X = mnl->X->val;
+    const double *P = mnl->P->val;
+    int T = mnl->T;
     int r, c;
     int i, j, k, t;
+    int err;
 
-    B = gretl_matrix_block_new(&x, 1, mnl->k,
-			       &xx, mnl->k, mnl->k,
+    err = mnl_sync(theta, mnl);
+    if (err) {
+	return err;
+    }
+
+    B = gretl_matrix_block_new(&wX, T, mnl->k,
 			       &hjk, mnl->k, mnl->k,
 			       NULL);
     if (B == NULL) {
@@ -1632,23 +1669,18 @@ static int mnl_hessian (double *theta, gretl_matrix *H, void *data)
 
     for (j=0; j<mnl->n; j++) {
 	for (k=0; k<=j; k++) {
-	    gretl_matrix_zero(hjk);
-	    for (t=0; t<mnl->T; t++) {
-		for (i=0; i<mnl->k; i++) {
-		    xti = gretl_matrix_get(mnl->X, t, i);
-		    gretl_vector_set(x, i, xti);
+	    for (i=0; i<mnl->k; i++) {
+		for (t=0; t<T; t++) {
+		    wX->val[i*T+t] = P[j*T+t] * ((j == k) - P[k*T+t]) *
+			X[i*T+t];
 		}
-		gretl_matrix_multiply_mod(x, GRETL_MOD_TRANSPOSE,
-					  x, GRETL_MOD_NONE,
-					  xx, GRETL_MOD_NONE);
-		ptj = gretl_matrix_get(mnl->P, t, j);
-		ptk = gretl_matrix_get(mnl->P, t, k);
-		gretl_matrix_multiply_by_scalar(xx, ptj * ((j == k) - ptk));
-		gretl_matrix_add_to(hjk, xx);
 	    }
+	    gretl_matrix_multiply_mod(mnl->X, GRETL_MOD_TRANSPOSE,
+				      wX, GRETL_MOD_NONE,
+				      hjk, GRETL_MOD_NONE);
 	    gretl_matrix_inscribe_matrix(H, hjk, r, c, GRETL_MOD_NONE);
 	    if (j != k) {
-		gretl_matrix_inscribe_matrix(H, hjk, c, r, GRETL_MOD_NONE);
+		gretl_matrix_inscribe_matrix(H, hjk, c, r, GRETL_MOD_TRANSPOSE);
 	    }
 	    c += mnl->k;
 	}
@@ -2315,6 +2347,7 @@ struct bin_info_ {
     int k;            /* number of parameters */
     int T;            /* number of observations */
     int pp_err;       /* to record perfect-prediction error */
+    int cached;       /* score, Hessian pertain to @b? (1/0) */
     double *theta;    /* coeffs for Newton-Raphson */
     int *y;           /* dependent variable */
     gretl_matrix_block *B;
@@ -2322,6 +2355,7 @@ struct bin_info_ {
     gretl_matrix *pX; /* for use with Hessian */
     gretl_matrix *b;  /* coefficients in matrix form */
     gretl_matrix *Xb; /* index function values */
+    gretl_matrix *g;  /* score vector */
 };
 
 static void bin_info_destroy (bin_info *bin)
@@ -2343,6 +2377,7 @@ static bin_info *bin_info_new (int ci, int k, int T)
 	bin->k = k;
 	bin->T = T;
 	bin->pp_err = 0;
+	bin->cached = 0;
 	bin->theta = malloc(k * sizeof *bin->theta);
 	if (bin->theta == NULL) {
 	    free(bin);
@@ -2358,6 +2393,7 @@ static bin_info *bin_info_new (int ci, int k, int T)
 					&bin->pX, T, k,
 					&bin->b, k, 1,
 					&bin->Xb, T, 1,
+					&bin->g, k, 1,
 					NULL);
 	if (bin->B == NULL) {
 	    free(bin->theta);
@@ -2393,77 +2429,163 @@ static int perfect_prediction_check (bin_info *bin)
     return (min1 > max0);
 }
 
-/* compute loglikelihood for binary probit/logit */
+/* Compute the loglikelihood contribution of an observation with
+   outcome @yt and index function value @ndx, writing into @w the
+   weight on x_t in the score and into @h the weight on x_t x_t'
+   in the negative Hessian. For the probit case we get the normal
+   CDF and the inverse Mills ratio from a single evaluation of
+   erfc(), except in the tails: on the far left we defer to the
+   more careful library functions.
+*/
 
-static double binary_loglik (const double *theta, void *ptr)
+static inline double binary_ll_term (int ci, int yt, double ndx,
+				     double *w, double *h)
+{
+    double q = yt ? 1.0 : -1.0;
+    double z = q * ndx;
+    double P, lam, e;
+
+    if (ci == PROBIT) {
+	if (z > 37.0) {
+	    /* Mills ratio underflows */
+	    P = 1.0;
+	    lam = 0.0;
+	} else if (z > -5.0) {
+	    P = 0.5 * erfc(-z * M_SQRT1_2);
+	    lam = exp(-0.5 * z * z) / (SQRT_2_PI * P);
+	} else {
+	    P = normal_cdf(z);
+	    lam = invmills(-z);
+	}
+	*w = q * lam;
+	*h = lam * (z + lam);
+	return log(P);
+    } else {
+	e = 1.0 / (1.0 + exp(-ndx));
+	*w = yt - e;
+	*h = e * (1.0 - e);
+	/* log of logistic CDF at z, avoiding cancellation */
+	return (z >= 0)? -log1p(exp(-z)) : z - log1p(exp(z));
+    }
+}
+
+/* Fused kernel for binary probit/logit: in a single sweep over
+   observations @s0 to @s1 - 1, taken in cache-sized chunks, compute
+   the index function, the loglikelihood and score contributions,
+   and the rows of the matrix pX used in forming the Hessian as
+   X'pX.
+*/
+
+static int binary_block (void *data, int s0, int s1,
+			 double *ll, double *g)
 {
-    bin_info *bin = (bin_info *) ptr;
-    double e, ndx, p, ll = 0.0;
-    int yt, i, t;
+    bin_info *bin = data;
+    const double *b = bin->b->val;
+    const double *X = bin->X->val;
+    double *ndx = bin->Xb->val;
+    double *pX = bin->pX->val;
+    double w[LL_CHUNK];
+    double h[LL_CHUNK];
+    const double *xj;
+    double gj, *pj;
+    int T = bin->T;
+    int c0, c1, j, t;
 
     errno = 0;
 
+    for (c0=s0; c0<s1; c0+=LL_CHUNK) {
+	c1 = c0 + LL_CHUNK < s1 ? c0 + LL_CHUNK : s1;
+	for (t=c0; t<c1; t++) {
+	    ndx[t] = 0.0;
+	}
+	for (j=0; j<bin->k; j++) {
+	    xj = X + j * T;
+	    for (t=c0; t<c1; t++) {
+		ndx[t] += xj[t] * b[j];
+	    }
+	}
+	for (t=c0; t<c1; t++) {
+	    *ll += binary_ll_term(bin->ci, bin->y[t], ndx[t],
+				  &w[t-c0], &h[t-c0]);
+	}
+	for (j=0; j<bin->k; j++) {
+	    xj = X + j * T;
+	    pj = pX + j * T;
+	    gj = 0.0;
+	    for (t=c0; t<c1; t++) {
+		gj += w[t-c0] * xj[t];
+		pj[t] = h[t-c0] * xj[t];
+	    }
+	    g[j] += gj;
+	}
+    }
+
+    return errno ? E_NAN : 0;
+}
+
+/* compute loglikelihood for binary probit/logit; the score and
+   the ingredients of the Hessian are computed in the same pass
+*/
+
+static double binary_loglik (const double *theta, void *ptr)
+{
+    bin_info *bin = (bin_info *) ptr;
+    double ll = 0.0;
+    int i, err;
+
     for (i=0; i<bin->k; i++) {
 	bin->b->val[i] = theta[i];
     }
 
-    gretl_matrix_multiply(bin->X, bin->b, bin->Xb);
+    err = ll_block_sum(binary_block, bin, bin->T, bin->k,
+		       &ll, bin->g->val);
+    bin->cached = 0;
 
-    if (perfect_prediction_check(bin)) {
+    if (!err && perfect_prediction_check(bin)) {
 	bin->pp_err = 1;
 	return NADBL;
+    } else if (!err) {
+	bin->cached = 1;
     }
 
-    for (t=0; t<bin->T && !errno; t++) {
-	yt = bin->y[t];
-	ndx = gretl_vector_get(bin->Xb, t);
-	if (bin->ci == PROBIT) {
-	    p = yt ? normal_cdf(ndx) : normal_cdf(-ndx);
-	} else {
-	    e = logit(ndx);
-	    p = yt ? e : 1-e;
-	}
-	ll += log(p);
+    return err ? NADBL : ll;
+}
+
+/* ensure that the cached score and Hessian ingredients
+   pertain to @theta, and that the evaluation which produced
+   them succeeded */
+
+static int binary_sync (const double *theta, bin_info *bin)
+{
+    int i;
+
+    if (!bin->cached) {
+	return na(binary_loglik(theta, bin)) ? E_NAN : 0;
     }
 
-    if (errno != 0) {
-	ll = NADBL;
+    for (i=0; i<bin->k; i++) {
+	if (theta[i] != bin->b->val[i]) {
+	    return na(binary_loglik(theta, bin)) ? E_NAN : 0;
+	}
     }
 
-    return ll;
+    return 0;
 }
 
 static int binary_score (double *theta, double *s, int k, 
 			 BFGS_CRIT_FUNC ll, void *ptr)
 {
     bin_info *bin = (bin_info *) ptr;
-    double ndx, w;
-    int t, j, yt;
-    int err = 0;
-
-    errno = 0;
+    int j, err;
 
-    for (j=0; j<bin->k; j++) {
-	s[j] = 0.0;
-    }
+    err = binary_sync(theta, bin);
 
-    for (t=0; t<bin->T && !errno; t++) {
-	yt = bin->y[t];
-	ndx = gretl_vector_get(bin->Xb, t);
-	if (bin->ci == PROBIT) {
-	    w = yt ? invmills(-ndx) : -invmills(ndx);
-	} else {
-	    w = yt - logit(ndx);
-	}
+    if (!err) {
 	for (j=0; j<bin->k; j++) {
-	    s[j] += w * gretl_matrix_get(bin->X, t, j);
+	    s[j] = bin->g->val[j];
 	}
     }
 
-    if (errno != 0) {
-	err = E_NAN;
-    }
-
     return err;
 }
 
@@ -2474,29 +2596,17 @@ static int binary_hessian (double *theta, gretl_matrix *H,
 			   void *data)
 {
     bin_info *bin = data;
-    double w, p, ndx, xtj;
-    int t, j;
+    int err;
 
-    for (t=0; t<bin->T; t++) {
-	ndx = gretl_vector_get(bin->Xb, t);
-	if (bin->ci == PROBIT) {
-	    w = bin->y[t] ? invmills(-ndx) : -invmills(ndx);
-	    p = w * (ndx + w);
-	} else {
-	    p = logit(ndx);
-	    p = p * (1-p);
-	}
-	for (j=0; j<bin->k; j++) {
-	    xtj = gretl_matrix_get(bin->X, t, j);
-	    gretl_matrix_set(bin->pX, t, j, p * xtj);
-	}
-    }
+    err = binary_sync(theta, bin);
 
-    gretl_matrix_multiply_mod(bin->pX, GRETL_MOD_TRANSPOSE,
-			      bin->X, GRETL_MOD_NONE,
-			      H, GRETL_MOD_NONE);
+    if (!err) {
+	gretl_matrix_multiply_mod(bin->pX, GRETL_MOD_TRANSPOSE,
+				  bin->X, GRETL_MOD_NONE,
+				  H, GRETL_MOD_NONE);
+    }
 
-    return 0;
+    return err;
 }
 
 static gretl_matrix *binary_hessian_inverse (bin_info *bin, int *err)
@@ -4326,6 +4326,14 @@ int get_x12a_maxpd (void)
  * default is to use the Hessian by preference, but to fall back
  * to OPG if computation of the numerical Hessian fails. These
  * flags are ignored if estimation is not via native exact ML.
+ *
+ * If @opt includes OPT_A (incompatible with OPT_X, and with
+ * @pqlags) the AR and MA orders in @list are taken as maxima:
+ * all specifications up to these orders, with the given orders
+ * of differencing, are estimated via conditional ML and the one
+ * that minimizes an information criterion (AIC by default, or
+ * BIC or HQC as given by the parameter to the "auto" option) is
+ * then estimated by the method called for by @opt.
  * 
  * Returns: a #MODEL struct, containing the estimates.
  */
@@ -4346,6 +4354,9 @@ MODEL arma (const int *list, const int *pqlags,
     gretl_model_init(&armod, dset);
 
     err = incompatible_options(opt, OPT_G | OPT_H);
+    if (!err) {
+	err = incompatible_options(opt, OPT_A | OPT_X);
+    }
     if (err) {
 	armod.errcode = err;
 	return armod;
@@ -4388,6 +4399,47 @@ MODEL arma (const int *list, const int *pqlags,
     return armod;
 } 
 
+/**
+ * arma_auto_orders:
+ * @ylist: list of series.
+ * @orders: vector holding the maximal AR order, the order of
+ * differencing and the maximal MA order, optionally followed by
+ * the seasonal counterparts of these three.
+ * @crit: information criterion, "AIC" (the default, also if
+ * @crit is NULL), "BIC" or "HQC".
+ * @dset: dataset struct.
+ * @err: location to receive error code.
+ *
+ * For each series in @ylist, selects the ARIMA orders which
+ * minimize @crit, as with the OPT_A flag for arma(). The series
+ * are handled in parallel if OpenMP is available.
+ *
+ * Returns: a matrix with one row per series, holding the
+ * selected p, d, q, P, D, Q and the minimized criterion (with
+ * NAs for series on which the search failed), or NULL on error.
+ */
+
+gretl_matrix *arma_auto_orders (const int *ylist,
+				const gretl_matrix *orders,
+				const char *crit,
+				const DATASET *dset,
+				int *err)
+{
+    gretl_matrix *(*arma_auto_select) (const int *,
+				       const gretl_matrix *,
+				       const char *,
+				       const DATASET *,
+				       int *);
+
+    arma_auto_select = get_plugin_function("arma_auto_select");
+    if (arma_auto_select == NULL) {
+	*err = E_FOPEN;
+	return NULL;
+    }
+
+    return (*arma_auto_select) (ylist, orders, crit, dset, err);
+}
+
 /**
  * garch:
  * @list: dependent variable plus arch and garch orders.
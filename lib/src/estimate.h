@@ -41,6 +41,12 @@ MODEL quantreg (const gretl_matrix *tau, const int *list,
 MODEL arma (const int *list, const int *pqlags,
 	    const DATASET *dset, gretlopt opt, PRN *prn);
 
+gretl_matrix *arma_auto_orders (const int *ylist,
+				const gretl_matrix *orders,
+				const char *crit,
+				const DATASET *dset,
+				int *err);
+
 MODEL garch (const int *list, DATASET *dset, gretlopt opt,
 	     PRN *prn);
 
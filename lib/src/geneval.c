@@ -30,6 +30,7 @@
 #include "gretl_fft.h"
 #include "gretl_normal.h"
 #include "gretl_panel.h"
+#include "gretl_sparse.h"
 #include "kalman.h"
 #include "libset.h"
 #include "version.h"
@@ -296,6 +297,9 @@ static void free_node (NODE *t, parser *p)
 	} else if (t->t == ARRAY) {
 	    gretl_array_destroy(t->v.a);
 	}
+    } else if (t->t == MAT && (t->flags & VWN_NODE)) {
+	/* free the view header, not the data */
+	free(t->v.m);
     }
 
     if (t->t == UOBJ || t->t == WLIST) {
@@ -729,6 +733,8 @@ static void maybe_switch_node_type (NODE *n, int type,
 	/* switch aux node @n from matrix to scalar */
 	if (is_tmp_node(n)) {
 	    gretl_matrix_free(n->v.m);
+	} else if (n->flags & VWN_NODE) {
+	    free(n->v.m);
 	}
 	n->t = NUM;
 	n->v.xval = NADBL;
@@ -2645,6 +2651,9 @@ static int real_matrix_calc (const gretl_matrix *A,
     case F_MCSEL:
 	C = gretl_matrix_bool_sel(A, B, 0, &err);
 	break;
+    case F_CGSOLVE:
+	C = gretl_sparse_matrix_cg_solve(A, B, &err);
+	break;
     default:
 	err = E_TYPES;
 	break;
@@ -3357,6 +3366,266 @@ static NODE *matrix_matrix_calc (NODE *l, NODE *r, int op, parser *p)
     return ret;
 }
 
+/* Support for "rewritten" matrix products. At compile time
+   mark_fused_products() flags B_MUL nodes of the forms
+
+   A'*B     (transpose-multiply, no explicit transpose)
+   A*B'     (multiply-transpose, ditto)
+   inv(M)*B (linear solve, no explicit inverse)
+
+   where all the operands are "pure": named matrices, or
+   transpose-products of named matrices, whose evaluation has
+   no side effects. At run time eval_fused_product() checks
+   that the operands really are conformable, non-scalar
+   matrices; if not, the product is formed from the evaluated
+   operands with an explicit transpose or inverse, just as in
+   the standard evaluation, so the rewrite can never change
+   the meaning of an expression.
+*/
+
+enum {
+    FUSE_TRMUL = 1,
+    FUSE_MULTR,
+    FUSE_SOLVE
+};
+
+#define plain_matrix_node(n) (n != NULL && n->t == MAT)
+
+static int pure_matrix_node (NODE *n)
+{
+    if (plain_matrix_node(n)) {
+	return 1;
+    } else if (n != NULL && n->t == B_TRMUL) {
+	NODE *r = n->v.b2.r;
+
+	return plain_matrix_node(n->v.b2.l) &&
+	    (plain_matrix_node(r) || r->t == EMPTY);
+    } else {
+	return 0;
+    }
+}
+
+#define is_transpose_of_plain(n) (n->t == B_TRMUL && \
+				  n->v.b2.r->t == EMPTY && \
+				  plain_matrix_node(n->v.b2.l))
+
+static int fused_product_type (NODE *t)
+{
+    NODE *l = t->v.b2.l;
+    NODE *r = t->v.b2.r;
+
+    if (is_transpose_of_plain(l) && pure_matrix_node(r)) {
+	return FUSE_TRMUL;
+    } else if (is_transpose_of_plain(r) && pure_matrix_node(l)) {
+	return FUSE_MULTR;
+    } else if (l->t == F_INV && pure_matrix_node(l->v.b1.b) &&
+	       pure_matrix_node(r)) {
+	return FUSE_SOLVE;
+    } else {
+	return 0;
+    }
+}
+
+static void mark_fused_products (NODE *t, parser *p)
+{
+    if (t == NULL) {
+	return;
+    }
+
+    if (bnsym(t->t)) {
+	int i;
+
+	for (i=0; i<t->v.bn.n_nodes; i++) {
+	    mark_fused_products(t->v.bn.n[i], p);
+	}
+    } else if (b3sym(t->t)) {
+	mark_fused_products(t->v.b3.l, p);
+	mark_fused_products(t->v.b3.m, p);
+	mark_fused_products(t->v.b3.r, p);
+    } else if (b2sym(t->t)) {
+	mark_fused_products(t->v.b2.l, p);
+	mark_fused_products(t->v.b2.r, p);
+    } else if (b1sym(t->t)) {
+	mark_fused_products(t->v.b1.b, p);
+    }
+
+    if (t->t == B_MUL && fused_product_type(t) > 0) {
+	t->flags |= RWT_NODE;
+    }
+}
+
+static int usable_product_operand (const gretl_matrix *m)
+{
+    return !gretl_is_null_matrix(m) && !gretl_matrix_is_scalar(m);
+}
+
+/* Solve M*X = B in place of computing inv(M)*B, via Cholesky,
+   for symmetric M. Cholesky includes a conditioning check, so a
+   NULL return (M not symmetric, or not safely positive definite)
+   means the caller falls back on explicit inversion, which will
+   produce the appropriate error message if M is singular.
+*/
+
+static gretl_matrix *fused_solve (const gretl_matrix *M,
+				  const gretl_matrix *B)
+{
+    gretl_matrix *Mc, *X;
+    int err = 0;
+
+    if (gretl_matrix_get_structure(M) != GRETL_MATRIX_SYMMETRIC) {
+	return NULL;
+    }
+
+    Mc = gretl_matrix_copy(M);
+    X = gretl_matrix_copy(B);
+
+    if (Mc == NULL || X == NULL) {
+	err = E_ALLOC;
+    } else {
+	err = gretl_cholesky_decomp_solve(Mc, X);
+    }
+
+    gretl_matrix_free(Mc);
+
+    if (err) {
+	gretl_matrix_free(X);
+	X = NULL;
+    }
+
+    return X;
+}
+
+/* Compute the product represented by fused node @t in the
+   standard way, given its already evaluated operands @l and
+   @r, when the fused variant is not applicable: we form the
+   explicit transpose or inverse and multiply.
+*/
+
+static NODE *fused_product_fallback (NODE *l, NODE *r, int type,
+				     parser *p)
+{
+    gretl_matrix *A = l->v.m;
+    gretl_matrix *B = r->v.m;
+    gretl_matrix *tmp = NULL;
+    NODE *ret;
+
+    if (type == FUSE_TRMUL) {
+	tmp = A = gretl_matrix_copy_transpose(l->v.m);
+    } else if (type == FUSE_MULTR) {
+	tmp = B = gretl_matrix_copy_transpose(r->v.m);
+    } else {
+	tmp = A = user_matrix_matrix_func(l->v.m, 0, F_INV, &p->err);
+    }
+
+    if (!p->err && tmp == NULL) {
+	p->err = E_ALLOC;
+    }
+    if (p->err) {
+	return NULL;
+    }
+
+    p->flags |= P_MSAVE;
+    ret = get_aux_node(p, MAT, 0, TMP_NODE);
+    p->flags ^= P_MSAVE;
+
+    if (ret != NULL) {
+	p->err = real_matrix_calc(A, B, B_MUL, &ret->v.m);
+    }
+
+    gretl_matrix_free(tmp);
+
+    return ret;
+}
+
+static NODE *eval_fused_product (NODE *t, parser *p)
+{
+    int type = fused_product_type(t);
+    const gretl_matrix *A, *B;
+    NODE *l = t->v.b2.l;
+    NODE *r = t->v.b2.r;
+    gretl_matrix *X = NULL;
+    NODE *ret = NULL;
+
+    /* evaluate the (side-effect free) operands */
+    if (type == FUSE_TRMUL) {
+	l = eval(l->v.b2.l, p);
+	r = p->err ? NULL : eval(r, p);
+    } else if (type == FUSE_MULTR) {
+	l = eval(l, p);
+	r = p->err ? NULL : eval(r->v.b2.l, p);
+    } else if (type == FUSE_SOLVE) {
+	l = eval(l->v.b1.b, p);
+	r = p->err ? NULL : eval(r, p);
+    } else {
+	return NULL;
+    }
+
+    if (p->err || l == NULL || r == NULL ||
+	l->t != MAT || r->t != MAT) {
+	/* only if a "matrix" name has been redefined: let the
+	   standard evaluation handle it */
+	return NULL;
+    }
+
+    A = l->v.m;
+    B = r->v.m;
+    p->aux = t->aux;
+
+    if (!usable_product_operand(A) || !usable_product_operand(B) ||
+	(type == FUSE_TRMUL && A->rows != B->rows) ||
+	(type == FUSE_MULTR && A->cols != B->cols) ||
+	(type == FUSE_SOLVE && (A->rows != A->cols ||
+				A->cols != B->rows))) {
+	return fused_product_fallback(l, r, type, p);
+    }
+
+    if (type == FUSE_SOLVE) {
+	/* do the work before committing to an aux node */
+	X = fused_solve(A, B);
+	if (X == NULL) {
+	    return fused_product_fallback(l, r, type, p);
+	}
+    }
+
+    if (gretl_debugging_on() && t->aux == NULL) {
+	fprintf(stderr, "genr: evaluating %s without explicit %s\n",
+		type == FUSE_TRMUL ? "A'*B" : type == FUSE_MULTR ?
+		"A*B'" : "inv(M)*B", type == FUSE_SOLVE ?
+		"inverse" : "transpose");
+    }
+
+    if (type == FUSE_TRMUL) {
+	return matrix_matrix_calc(l, r, B_TRMUL, p);
+    }
+
+    p->flags |= P_MSAVE;
+    ret = get_aux_node(p, MAT, 0, TMP_NODE);
+    p->flags ^= P_MSAVE;
+
+    if (ret == NULL) {
+	gretl_matrix_free(X);
+    } else if (type == FUSE_SOLVE) {
+	gretl_matrix_free(ret->v.m);
+	ret->v.m = X;
+    } else {
+	gretl_matrix *C = calc_get_matrix(&ret->v.m, A->rows, B->rows);
+
+	if (C == NULL) {
+	    p->err = E_ALLOC;
+	} else {
+	    p->err = gretl_matrix_multiply_mod(A, GRETL_MOD_NONE,
+					       B, GRETL_MOD_TRANSPOSE,
+					       C, GRETL_MOD_NONE);
+	    if (C != ret->v.m) {
+		gretl_matrix_free(ret->v.m);
+		ret->v.m = C;
+	    }
+	}
+    }
+
+    return ret;
+}
+
 static NODE *matrix_and_or (NODE *l, NODE *r, int op, parser *p)
 {
     NODE *ret = aux_matrix_node(p);
@@ -3846,11 +4115,8 @@ matrix_to_matrix2_func (NODE *n, NODE *r, int f, parser *p)
 	case F_QR:
 	    ret->v.m = user_matrix_QR_decomp(m, rname, &p->err);
 	    break;
-	case F_EIGSYM:
-	    ret->v.m = user_matrix_eigen_analysis(m, rname, 1, &p->err);
-	    break;
 	case F_EIGGEN:
-	    ret->v.m = user_matrix_eigen_analysis(m, rname, 0, &p->err);
+	    ret->v.m = user_matrix_eigen_analysis(m, rname, 0, 0, &p->err);
 	    break;
 	}
 
@@ -4055,6 +4321,52 @@ static NODE *mspec_node (NODE *l, NODE *r, parser *p)
     return ret;
 }
 
+/* Get an aux node to hold either a newly allocated submatrix
+   (@view = 0) or a view onto a contiguous block of an existing
+   matrix (@view = 1). A view node is "fragile" in the sense
+   described above -- its data belong to the source matrix, so
+   it gets deep-copied on assignment -- but it owns the matrix
+   header, which is freed along with the node. Since the node
+   may be reused across evaluations of a compiled parser we
+   handle switching between the two variants.
+*/
+
+static NODE *submatrix_aux_node (parser *p, int view)
+{
+    NODE *ret = p->aux;
+
+    if (ret != NULL && ret->t == MAT && !view &&
+	(ret->flags & VWN_NODE)) {
+	/* revert from view to regular tmp matrix */
+	free(ret->v.m);
+	ret->v.m = NULL;
+	ret->flags &= ~VWN_NODE;
+	ret->flags |= TMP_NODE;
+    }
+
+    if (!view) {
+	return aux_matrix_node(p);
+    }
+
+    ret = get_aux_node(p, MAT, 0, 0);
+
+    if (ret != NULL && !(ret->flags & VWN_NODE)) {
+	if (is_tmp_node(ret)) {
+	    gretl_matrix_free(ret->v.m);
+	    ret->flags &= ~TMP_NODE;
+	}
+	ret->v.m = malloc(sizeof *ret->v.m);
+	if (ret->v.m == NULL) {
+	    p->err = E_ALLOC;
+	} else {
+	    gretl_matrix_init(ret->v.m);
+	    ret->flags |= VWN_NODE;
+	}
+    }
+
+    return ret;
+}
+
 static NODE *submatrix_node (NODE *l, NODE *r, parser *p)
 {
     NODE *ret = NULL;
@@ -4062,6 +4374,7 @@ static NODE *submatrix_node (NODE *l, NODE *r, parser *p)
     if (starting(p)) {
 	gretl_matrix *a = NULL;
 	matrix_subspec *spec = NULL;
+	gretl_matrix V;
 
 	if (r->t != MSPEC) {
 	    fprintf(stderr, "submatrix_node: couldn't find mspec\n");
@@ -4071,6 +4384,15 @@ static NODE *submatrix_node (NODE *l, NODE *r, parser *p)
 
 	spec = r->v.mspec;
 
+	if (l->t == MAT && matrix_get_submatrix_view(l->v.m, spec, &V)) {
+	    /* contiguous block: no need to copy the data */
+	    ret = submatrix_aux_node(p, 1);
+	    if (ret != NULL && !p->err) {
+		*ret->v.m = V;
+	    }
+	    return ret;
+	}
+
 	if (l->t == MAT) {
 	    a = matrix_get_submatrix(l->v.m, spec, 0, &p->err);
 	} else if (l->t == STR) {
@@ -4080,7 +4402,7 @@ static NODE *submatrix_node (NODE *l, NODE *r, parser *p)
 	}
 
 	if (a != NULL) {
-	    ret = aux_matrix_node(p);
+	    ret = submatrix_aux_node(p, 0);
 	    if (ret == NULL) {
 		gretl_matrix_free(a);
 	    } else {
@@ -7140,6 +7462,28 @@ static NODE *suitable_ufunc_ret_node (parser *p,
     }
 }
 
+/* A submatrix view must not be handed to a user function:
+   the parameter could outlive, or be invalidated by changes
+   to, the source matrix (e.g. via a pointer argument). So we
+   convert the aux node in place into a regular tmp node
+   holding a copy of the viewed data; submatrix_aux_node()
+   takes care of switching it back on re-evaluation.
+*/
+
+static void materialize_view_node (NODE *n, parser *p)
+{
+    gretl_matrix *m = gretl_matrix_copy(n->v.m);
+
+    if (m == NULL) {
+	p->err = E_ALLOC;
+    } else {
+	free(n->v.m);
+	n->v.m = m;
+	n->flags &= ~VWN_NODE;
+	n->flags |= TMP_NODE;
+    }
+}
+
 #define ok_ufunc_sym(s) (s == NUM || s == SERIES || s == MAT || \
                          s == LIST || s == U_ADDR || s == DUM || \
                          s == STR || s == EMPTY || s == BUNDLE || \
@@ -7243,6 +7587,10 @@ static NODE *eval_ufunc (NODE *t, parser *p)
 	    p->err = E_TYPES;
 	}
 
+	if (!p->err && arg->t == MAT && (arg->flags & VWN_NODE)) {
+	    materialize_view_node(arg, p);
+	}
+
 	if (!p->err) {
 	    /* assemble info and push argument */
 	    data = arg_get_data(arg, reftype, &argt);
@@ -8218,19 +8566,21 @@ static NODE *eval_3args_func (NODE *l, NODE *m, NODE *r, int f, parser *p)
 		A = gretl_matrix_trim_rows(l->v.m, k1, k2, &p->err);
 	    }
 	}
-    } else if (f == F_SVD) {
+    } else if (f == F_EIGSYM) {
 	if (l->t != MAT) {
 	    node_type_error(f, 1, MAT, l, p);
 	} else if (m->t != U_ADDR && m->t != EMPTY) {
 	    node_type_error(f, 2, U_ADDR, m, p);
-	} else if (r->t != U_ADDR && r->t != EMPTY) {
-	    node_type_error(f, 3, U_ADDR, r, p);
+	} else if (!empty_or_num(r)) {
+	    node_type_error(f, 3, NUM, r, p);
 	} else {
-	    const char *uname, *vname;
+	    const char *vname = ptr_node_get_matrix_name(m, p);
+	    int k = (r->t == EMPTY)? 0 : node_get_int(r, p);
 
-	    uname = ptr_node_get_matrix_name(m, p);
-	    vname = ptr_node_get_matrix_name(r, p);
-	    A = user_matrix_SVD(l->v.m, uname, vname, &p->err);
+	    if (!p->err) {
+		A = user_matrix_eigen_analysis(l->v.m, vname, 1, k,
+					       &p->err);
+	    }
 	}
     } else if (f == F_TOEPSOLV || f == F_VARSIMUL) {
 	if (l->t != MAT) {
@@ -8406,6 +8756,19 @@ static NODE *eval_3args_func (NODE *l, NODE *m, NODE *r, int f, parser *p)
 
 	    A = matrix_chowlin(l->v.m, X, m->v.xval, &p->err);
 	}
+    } else if (f == F_AUTOARIMA) {
+	if (l->t != LIST) {
+	    node_type_error(f, 1, LIST, l, p);
+	} else if (m->t != MAT) {
+	    node_type_error(f, 2, MAT, m, p);
+	} else if (r->t != STR && r->t != EMPTY) {
+	    node_type_error(f, 3, STR, r, p);
+	} else {
+	    const char *crit = (r->t == STR)? r->v.str : NULL;
+
+	    A = arma_auto_orders(l->v.ivec, m->v.m, crit,
+				 p->dset, &p->err);
+	}
     } else if (f == F_IRF) {
 	if (l->t != NUM) {
 	    node_type_error(f, 1, NUM, l, p);
@@ -8702,6 +9065,51 @@ static int x_to_period (double x, char c, int *err)
     }
 }
 
+/* garchbatch(Y, p, q): estimate GARCH(p, q) for each member
+   of list Y, via plugin */
+
+static NODE *garch_batch_node (NODE *l, NODE *m, NODE *r, parser *p)
+{
+    NODE *ret = NULL;
+    int gp = 0, gq = 0;
+
+    if (l->t != LIST) {
+	node_type_error(F_GARCHB, 1, LIST, l, p);
+    } else if (!scalar_node(m)) {
+	node_type_error(F_GARCHB, 2, NUM, m, p);
+    } else if (!scalar_node(r)) {
+	node_type_error(F_GARCHB, 3, NUM, r, p);
+    } else {
+	gp = node_get_int(m, p);
+	if (!p->err) {
+	    gq = node_get_int(r, p);
+	}
+    }
+
+    if (!p->err) {
+	gretl_bundle *(*gbfunc) (const int *, int, int,
+				 const DATASET *, int *);
+	gretl_bundle *b = NULL;
+
+	gbfunc = get_plugin_function("garch_batch_estimate");
+	if (gbfunc == NULL) {
+	    p->err = E_FOPEN;
+	} else {
+	    b = (*gbfunc)(l->v.ivec, gp, gq, p->dset, &p->err);
+	}
+	if (!p->err) {
+	    ret = aux_bundle_node(p);
+	    if (ret != NULL) {
+		ret->v.b = b;
+	    } else {
+		gretl_bundle_destroy(b);
+	    }
+	}
+    }
+
+    return ret;
+}
+
 static NODE *eval_epochday (NODE *ny, NODE *nm, NODE *nd, parser *p)
 {
     NODE *ret = NULL;
@@ -9511,6 +9919,59 @@ static NODE *eval_nargs_func (NODE *t, parser *p)
 
 	if (freeY) gretl_matrix_free(Y);
 	if (freeX) gretl_matrix_free(X);
+    } else if (t->t == F_SVD) {
+	gretl_matrix *X = NULL;
+	const char *SU = NULL;
+	const char *SV = NULL;
+	int rank = 0;
+
+	if (k < 1 || k > 4) {
+	    n_args_error(k, 4, t->t, p);
+	} 
+
+	for (i=0; i<k && !p->err; i++) {
+	    e = eval(n->v.bn.n[i], p);
+	    if (p->err) {
+		break;
+	    }
+	    if (i == 0) {
+		if (e->t != MAT) {
+		    node_type_error(t->t, i+1, MAT, e, p);
+		} else {
+		    X = e->v.m;
+		}
+	    } else if (i == 3) {
+		if (e->t == EMPTY) {
+		    ; /* OK */
+		} else if (!scalar_node(e)) {
+		    node_type_error(t->t, i+1, NUM, e, p);
+		} else {
+		    rank = node_get_int(e, p);
+		}
+	    } else {
+		if (e->t == EMPTY) {
+		    ; /* OK */
+		} else if (e->t != U_ADDR) {
+		    node_type_error(t->t, i+1, U_ADDR, e, p);
+		} else if (i == 1) {
+		    SU = ptr_node_get_matrix_name(e, p);
+		} else {
+		    SV = ptr_node_get_matrix_name(e, p);
+		}
+	    }
+	}
+
+	if (!p->err) {
+	    reset_p_aux(p, save_aux);
+	    ret = aux_matrix_node(p);
+	}
+
+	if (!p->err) {
+	    if (ret->v.m != NULL) {
+		gretl_matrix_free(ret->v.m);
+	    }
+	    ret->v.m = user_matrix_SVD(X, SU, SV, rank, &p->err);
+	}
     } else if (t->t == F_MRLS) {
 	gretl_matrix *Y = NULL;
 	gretl_matrix *X = NULL;
@@ -10131,13 +10592,21 @@ static NODE *eval_kalman_bundle_func (NODE *t, parser *p)
 	gretl_bundle *b = get_kalman_bundle_arg(n, p);
 	int param = 1;
 	int dkstyle = 0;
+	int ckpt = 0;
 
 	if (!p->err) {
-	    if (k == 2) {
+	    if (k < 1 || k > 3) {
+		n_args_error(k, 3, t->t, p);
+	    }
+	    if (!p->err && k >= 2) {
 		e = eval(n->v.bn.n[1], p);
-		dkstyle = node_get_int(e, p);
-	    } else if (k < 1 || k > 2) {
-		n_args_error(k, 2, t->t, p);
+		if (e->t != EMPTY) {
+		    dkstyle = node_get_int(e, p);
+		}
+	    }
+	    if (!p->err && k == 3) {
+		e = eval(n->v.bn.n[2], p);
+		ckpt = node_get_int(e, p);
 	    }
 	}
 	if (!p->err) {
@@ -10145,20 +10614,25 @@ static NODE *eval_kalman_bundle_func (NODE *t, parser *p)
 	    reset_p_aux(p, save_aux);
 	    ret = aux_scalar_node(p);
 	    if (!p->err) {
-		ret->v.xval = kalman_bundle_smooth(b, param, p->prn);
+		ret->v.xval = kalman_bundle_smooth(b, param, ckpt, p->prn);
 	    }
 	}	
     } else if (t->t == F_KSMOOTH) {
 	gretl_bundle *b = get_kalman_bundle_arg(n, p);
+	int ckpt = 0;
 	
-	if (!p->err && k != 1) {
-	    n_args_error(k, 1, t->t, p);
+	if (!p->err && k != 1 && k != 2) {
+	    n_args_error(k, 2, t->t, p);
+	}
+	if (!p->err && k == 2) {
+	    e = eval(n->v.bn.n[1], p);
+	    ckpt = node_get_int(e, p);
 	}
 	if (!p->err) {	
 	    reset_p_aux(p, save_aux);
 	    ret = aux_scalar_node(p);
 	    if (!p->err) {
-		ret->v.xval = kalman_bundle_smooth(b, 0, p->prn);
+		ret->v.xval = kalman_bundle_smooth(b, 0, ckpt, p->prn);
 	    }
 	}
     } else if (t->t == F_KSIMUL) {
@@ -11743,6 +12217,13 @@ static NODE *eval (NODE *t, parser *p)
 	return NULL;
     }
 
+    if ((t->flags & RWT_NODE) && starting(p)) {
+	ret = eval_fused_product(t, p);
+	if (ret != NULL || p->err) {
+	    goto finish;
+	}
+    }
+
 #if EDEBUG
     if (t->vname != NULL) {
 	fprintf(stderr, "eval: incoming node %p ('%s', vname=%s)\n", 
@@ -11984,6 +12465,7 @@ static NODE *eval (NODE *t, parser *p)
     case F_CDIV:
     case F_MRSEL:
     case F_MCSEL:
+    case F_CGSOLVE:
     case F_DSUM:
     case B_LDIV:
     case B_KRON:
@@ -12557,7 +13039,6 @@ static NODE *eval (NODE *t, parser *p)
 	}
 	break;
     case F_QR:
-    case F_EIGSYM:
     case F_EIGGEN:
 	/* matrix -> matrix functions, with indirect return */
 	if (l->t != MAT) {
@@ -12648,7 +13129,7 @@ static NODE *eval (NODE *t, parser *p)
 	} 
 	break;	
     case F_MSHAPE:
-    case F_SVD:
+    case F_EIGSYM:
     case F_TRIMR:
     case F_TOEPSOLV:
     case F_CORRGM:
@@ -12662,6 +13143,8 @@ static NODE *eval (NODE *t, parser *p)
     case F_SETNOTE:
     case F_BWFILT:
     case F_CHOWLIN:
+    case F_AUTOARIMA:
+    case F_GARCHB:
     case F_VARSIMUL:
     case F_IRF:
     case F_STRSUB:
@@ -12683,6 +13166,8 @@ static NODE *eval (NODE *t, parser *p)
 	    ret = string_replace(l, m, r, t->t, p);
 	} else if (t->t == F_EPOCHDAY) {
 	    ret = eval_epochday(l, m, r, p);
+	} else if (t->t == F_GARCHB) {
+	    ret = garch_batch_node(l, m, r, p);
 	} else {
 	    ret = eval_3args_func(l, m, r, t->t, p);
 	}
@@ -12719,6 +13204,7 @@ static NODE *eval (NODE *t, parser *p)
     case F_MOLS:
     case F_MPOLS:
     case F_MRLS:
+    case F_SVD:
     case F_FILTER:	
     case F_MCOVG:
     case F_NRMAX:
@@ -15305,7 +15791,9 @@ static int save_generated_var (parser *p, PRN *prn)
 	    }
 	    if (p->err == 0) {
 		/* made a change to an element of a series */
+		series_set_mtime(p->dset, v);
 		set_dataset_is_changed();
+		gretl_transforms_invalidate();
 	    }
 	}
     } else if (p->targ == NUM) {
@@ -15418,7 +15906,11 @@ static int save_generated_var (parser *p, PRN *prn)
 		v, p->lh.name);
 #endif
 	if (!p->err) {
-	    /* (probably) changed or added a series */
+	    /* (probably) changed or added a series: record the
+	       modification time, which may be used to judge
+	       whether transformations of the series are stale
+	    */
+	    series_set_mtime(p->dset, v);
 	    set_dataset_is_changed();
 	}
     } else if (p->targ == MAT) {
@@ -15950,6 +16442,8 @@ int realgen (const char *s, parser *p, DATASET *dset, PRN *prn,
     if (!p->err) {
 	/* set P_UFRET here if relevant */
 	maybe_set_return_flags(p);
+	/* avoid explicit transposes and inverses where possible */
+	mark_fused_products(p->tree, p);
     }
 
  starteval:
@@ -408,6 +408,8 @@ struct str_table funcs[] = {
     { F_INVMILLS, "invmills" },
     { F_POLYFIT,  "polyfit" },
     { F_CHOWLIN,  "chowlin" },
+    { F_AUTOARIMA, "autoarima" },
+    { F_GARCHB,    "garchbatch" },
     { F_VARSIMUL, "varsimul" },
     { F_STRSPLIT, "strsplit" },
     { F_INLIST,   "inlist" },
@@ -463,6 +465,7 @@ struct str_table funcs[] = {
     { F_MLINCOMB,  "mlincomb" },
     { F_HFDIFF,    "hfdiff" },
     { F_HFLDIFF,   "hfldiff" },
+    { F_CGSOLVE,   "cgsolve" },
     { F_HFLIST,    "hflist" },
     { 0,           NULL }
 };
@@ -163,10 +163,6 @@ static void gen_write_label (parser *p, int oldv)
 
     maybe_record_lag_info(p);
 
-    if (p->lh.vnum < oldv && p->targ == SERIES) {
-	series_set_mtime(p->dset, p->lh.vnum);
-    }
-
     if (*p->lh.label != '\0' && (p->flags & P_UFRET)) {
 	src = p->lh.label;
     } else if (*p->lh.label != '\0' && dollar_node(p->tree)) {
@@ -302,7 +302,6 @@ enum {
     F_MNORM,
     F_QFORM,
     F_QR,
-    F_EIGSYM,	 
     F_EIGGEN,
     F_FDJAC,
     F_LRVAR,
@@ -368,13 +367,13 @@ enum {
     F_KSIMDATA,
     F_HFDIFF,
     F_HFLDIFF,
+    F_CGSOLVE,
     F2_MAX,	  /* SEPARATOR: end of two-arg functions */
     F_LLAG,
     F_HFLAG,
     F_PRINCOMP,
     F_BFGSMAX,
     F_MSHAPE,
-    F_SVD,
     F_TRIMR,
     F_TOEPSOLV,
     F_CORRGM,
@@ -395,6 +394,7 @@ enum {
     F_REGSUB,
     F_MLAG,
     F_EIGSOLVE,
+    F_EIGSYM,
     F_NADARWAT,
     F_SIMANN,
     F_HALTON,
@@ -410,11 +410,14 @@ enum {
     F_MGRADIENT,
     F_MLINCOMB,
     F_HFLIST,
+    F_AUTOARIMA,
+    F_GARCHB,
     F3_MAX,       /* SEPARATOR: end of three-arg functions */
     F_BKFILT,
     F_MOLS,
     F_MPOLS,
     F_MRLS,
+    F_SVD,
     F_FILTER,
     F_MCOVG,
     F_KFILTER,
@@ -526,12 +529,12 @@ enum {
 
 /* functions where the right-hand argument is actually a return
    location */
-#define r_return(s) (s == F_QR || s == F_EIGSYM || s == F_EIGGEN || \
-                     s == F_MOLS || s == F_MPOLS || s == F_SVD)
+#define r_return(s) (s == F_QR || s == F_EIGGEN || \
+                     s == F_MOLS || s == F_MPOLS)
 
 /* functions where the middle argument is actually a return
    location */
-#define m_return(s) (s == F_SVD)
+#define m_return(s) (s == F_EIGSYM)
 
 #define dollar_node(n) (n->t == DVAR || n->t == MVAR || \
                         (n->t == MSL && n->v.b2.l->v.str[0] == '$'))
@@ -580,12 +583,14 @@ enum {
     PTR_NODE = 1 << 2, /* node is compatible with P_LHPTR */
     SVL_NODE = 1 << 3, /* holds string-valued series */
     PAR_NODE = 1 << 4, /* exponentiation node is parenthesized */
-    PRX_NODE = 1 << 5  /* aux node is proxy (don't reuse!) */
+    PRX_NODE = 1 << 5, /* aux node is proxy (don't reuse!) */
+    RWT_NODE = 1 << 6, /* product node eligible for fused evaluation */
+    VWN_NODE = 1 << 7  /* matrix node is a view: owns header only */
 };
 
 struct node {
     short t;       /* type identifier */
-    char flags;    /* AUX_NODE etc., see above */
+    unsigned char flags; /* AUX_NODE etc., see above */
     int vnum;      /* associated series ID number */
     char *vname;   /* associated variable name */
     user_var *uv;  /* associated named variable */
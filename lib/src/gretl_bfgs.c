@@ -2322,6 +2322,151 @@ static int NR_invert_hessian (gretl_matrix *H, const gretl_matrix *Hcpy)
 
 }
 
+static void ll_do_block (LL_BLOCK_FUNC func, void *data,
+			 int b, int bsize, int n, int ng,
+			 double *part, int *berr)
+{
+    double *pb = part + b * (ng + 1);
+    int s0 = b * bsize;
+    int s1 = s0 + bsize < n ? s0 + bsize : n;
+
+    berr[b] = func(data, s0, s1, pb, pb + 1);
+}
+
+#define LL_MIN_BLOCK 2048
+#define LL_MAX_BLOCKS 64
+
+static int ll_block_sum_real (LL_BLOCK_FUNC func, void *data,
+			      int n, int cost, int ng,
+			      double *ll, double *g)
+{
+    double *part, *pb;
+    int *berr;
+    int minb, nb, bsize, done = 0;
+    int b, i, err = 0;
+
+    minb = cost > 1 ? LL_MIN_BLOCK / cost : LL_MIN_BLOCK;
+    if (minb < 1) {
+	minb = 1;
+    }
+
+    nb = (n + minb - 1) / minb;
+    if (nb > LL_MAX_BLOCKS) {
+	nb = LL_MAX_BLOCKS;
+    } else if (nb < 1) {
+	nb = 1;
+    }
+    bsize = (n + nb - 1) / nb;
+
+    part = calloc(nb * (ng + 1), sizeof *part);
+    berr = calloc(nb, sizeof *berr);
+    if (part == NULL || berr == NULL) {
+	free(part);
+	free(berr);
+	return E_ALLOC;
+    }
+
+#if defined(_OPENMP)
+    if (nb > 1 && libset_use_openmp((guint64) n * cost * (ng + 1))) {
+#pragma omp parallel for private(b)
+	for (b=0; b<nb; b++) {
+	    ll_do_block(func, data, b, bsize, n, ng, part, berr);
+	}
+	done = 1;
+    }
+#endif
+
+    if (!done) {
+	for (b=0; b<nb; b++) {
+	    ll_do_block(func, data, b, bsize, n, ng, part, berr);
+	}
+    }
+
+    *ll = 0.0;
+    for (i=0; i<ng; i++) {
+	g[i] = 0.0;
+    }
+
+    for (b=0; b<nb; b++) {
+	if (berr[b] && !err) {
+	    err = berr[b];
+	}
+	pb = part + b * (ng + 1);
+	*ll += pb[0];
+	for (i=0; i<ng; i++) {
+	    g[i] += pb[i+1];
+	}
+    }
+
+    free(part);
+    free(berr);
+
+    return err;
+}
+
+/**
+ * ll_block_sum:
+ * @func: function to evaluate a block of observations.
+ * @data: pointer to be passed as the first argument to @func.
+ * @n: number of observations.
+ * @ng: length of gradient vector (may be 0).
+ * @ll: location to receive the loglikelihood.
+ * @g: array of length @ng to receive the gradient, or %NULL
+ * if @ng is 0.
+ *
+ * Evaluates a loglikelihood, and optionally its gradient, by
+ * summing over observations 0 to @n - 1, in parallel if OpenMP
+ * is available and the problem is big enough. The observations
+ * are divided into at most 64 blocks, the number depending only
+ * on @n, and @func is called as func(data, s0, s1, ll, g) for
+ * each block: it should add to @ll and @g (which are initialized
+ * to zero) the contributions of observations s0 to s1 - 1,
+ * returning non-zero on error. Since @func may be called
+ * concurrently for different blocks it must not write to shared
+ * storage, other than at observation-specific locations.
+ *
+ * The block results are summed in block order, so the outcome
+ * does not depend on the number of threads employed.
+ *
+ * Returns: 0 on success, or the first non-zero code returned
+ * by @func, or E_ALLOC.
+ */
+
+int ll_block_sum (LL_BLOCK_FUNC func, void *data,
+		  int n, int ng, double *ll, double *g)
+{
+    return ll_block_sum_real(func, data, n, 1, ng, ll, g);
+}
+
+/**
+ * ll_block_sum_units:
+ * @func: function to evaluate a block of units.
+ * @data: pointer to be passed as the first argument to @func.
+ * @n: number of units.
+ * @cost: approximate cost of evaluating one unit, relative
+ * to a single observation in a simple index model.
+ * @ng: length of gradient vector (may be 0).
+ * @ll: location to receive the loglikelihood.
+ * @g: array of length @ng to receive the gradient, or %NULL
+ * if @ng is 0.
+ *
+ * Works as ll_block_sum(), but for likelihoods that are sums
+ * over units (e.g. panel units, possibly integrated over
+ * quadrature points) each of which is relatively expensive to
+ * evaluate; @cost is used to set the block size, so that such
+ * problems are split up even when the number of units is small.
+ *
+ * Returns: 0 on success, or the first non-zero code returned
+ * by @func, or E_ALLOC.
+ */
+
+int ll_block_sum_units (LL_BLOCK_FUNC func, void *data,
+			int n, int cost, int ng,
+			double *ll, double *g)
+{
+    return ll_block_sum_real(func, data, n, cost, ng, ll, g);
+}
+
 /**
  * newton_raphson_max:
  * @b: array of adjustable coefficients.
@@ -33,6 +33,7 @@ typedef int (*BFGS_GRAD_FUNC) (double *, double *, int,
 typedef double (*BFGS_COMBO_FUNC) (double *, double *, int, void *);
 typedef const double *(*BFGS_LLT_FUNC) (const double *, int, void *);
 typedef int (*HESS_FUNC) (double *, gretl_matrix *, void *);
+typedef int (*LL_BLOCK_FUNC) (void *, int, int, double *, double *);
 
 int BFGS_max (double *b, int n, int maxit, double reltol,
 	      int *fncount, int *grcount, BFGS_CRIT_FUNC cfunc, 
@@ -53,6 +54,13 @@ int newton_raphson_max (double *b, int n, int maxit,
 			HESS_FUNC hessfunc,
 			void *data, gretlopt opt, PRN *prn);
 
+int ll_block_sum (LL_BLOCK_FUNC func, void *data,
+		  int n, int ng, double *ll, double *g);
+
+int ll_block_sum_units (LL_BLOCK_FUNC func, void *data,
+			int n, int cost, int ng,
+			double *ll, double *g);
+
 int BFGS_numeric_gradient (double *b, double *g, int n,
 			   BFGS_CRIT_FUNC func, void *data);
 
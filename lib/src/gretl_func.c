@@ -187,7 +187,9 @@ struct fnpkg_ {
 
 enum {
     ARG_OPTIONAL = 1 << 0,
-    ARG_CONST    = 1 << 1
+    ARG_CONST    = 1 << 1,
+    ARG_SHARED   = 1 << 2, /* by-value param is never modified */
+    ARG_SCANNED  = 1 << 3  /* ARG_SHARED status has been checked */
 };
 
 /* structure representing an argument to a user-defined function */
@@ -6230,16 +6232,40 @@ static int localize_bundle_as_shell (fn_arg *arg,
     return err;
 }
 
-static int localize_const_matrix (fn_arg *arg, fn_param *fp)
+static void *arg_get_object (fn_arg *arg, GretlType *type)
 {
-    user_var *u = get_user_var_by_data(arg->val.m);
+    if (arg->type == GRETL_TYPE_MATRIX) {
+	*type = GRETL_TYPE_MATRIX;
+	return arg->val.m;
+    } else if (arg->type == GRETL_TYPE_BUNDLE) {
+	*type = GRETL_TYPE_BUNDLE;
+	return arg->val.b;
+    } else if (gretl_array_type(arg->type)) {
+	*type = gretl_array_get_type(arg->val.a);
+	return arg->val.a;
+    } else {
+	*type = GRETL_TYPE_NONE;
+	return NULL;
+    }
+}
+
+/* Make a const (or "shared", see below) matrix, bundle or
+   array argument available under the name of the parameter
+   without copying its content.
+*/
+
+static int localize_const_object (fn_arg *arg, fn_param *fp)
+{
+    GretlType type;
+    void *data = arg_get_object(arg, &type);
+    user_var *u = get_user_var_by_data(data);
     int err = 0;
 
     if (u == NULL) {
-	/* the const argument is an anonymous matrix */
-	err = arg_add_as_shell(fp->name, GRETL_TYPE_MATRIX, arg->val.m);
+	/* the const argument is an anonymous object */
+	err = arg_add_as_shell(fp->name, type, data);
     } else {
-	/* a named matrix: in view of its "const-ness" we
+	/* a named object: in view of its "const-ness" we
 	   don't need to copy the data
 	*/
 	user_var_adjust_level(u, 1);
@@ -6357,6 +6383,208 @@ static void fncall_finalize_listvars (fncall *call)
     }
 }
 
+/* Support for passing matrices, bundles and arrays "by value"
+   without copying them. If the body of a function never modifies
+   a given by-value parameter the caller's object can be made
+   available to the function in the same way as a const argument,
+   so that a copy becomes necessary only if the function returns
+   it. The check below is conservative: a parameter is judged to
+   be possibly modified if it's the target of any statement (or
+   of a "delete"), if it's given in pointer form or to setnote(),
+   if it's named on a "params" or "deriv" line of an mle, nls or
+   gmm block (the estimator writes its results into the parameter
+   objects directly), or if any statement has an indirect target
+   via "@" or "$".
+   Sharing is confined to named arguments, and is refused if any
+   argument in the call is given in pointer form, since the callee
+   could then free or replace the shared object (or its container)
+   while the parameter still refers to it.
+*/
+
+static const char *target_prefix_words[] = {
+    "catch", "genr", "scalar", "series", "matrix", "bundle",
+    "array", "string", "list", "strings", "matrices", "bundles",
+    "lists", "delete", NULL
+};
+
+static int is_target_prefix (const char *s, int n)
+{
+    int i;
+
+    for (i=0; target_prefix_words[i] != NULL; i++) {
+	if (strlen(target_prefix_words[i]) == n &&
+	    !strncmp(s, target_prefix_words[i], n)) {
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+/* check whether @name is the target of the statement @s;
+   set @indirect to 1 if the target is given indirectly */
+
+static int statement_target_is (const char *s, const char *name,
+				int *indirect)
+{
+    int n;
+
+    while (1) {
+	s += strspn(s, " \t");
+	n = gretl_namechar_spn(s);
+	if (n == 0) {
+	    *indirect = (*s == '@' || *s == '$');
+	    return 0;
+	} else if (is_target_prefix(s, n) && isspace(s[n])) {
+	    s += n;
+	} else {
+	    break;
+	}
+    }
+
+    return n == strlen(name) && !strncmp(s, name, n);
+}
+
+/* check whether @name occurs in @s as a word; if @amp is
+   non-zero, only occurrences in pointer form count */
+
+static int name_occurs_in (const char *s, const char *name, int amp)
+{
+    const char *p = s;
+    int n = strlen(name);
+
+    while ((p = strstr(p, name)) != NULL) {
+	int ok = (p == s || gretl_namechar_spn(p - 1) == 0) &&
+	    gretl_namechar_spn(p + n) == 0;
+
+	if (ok && amp) {
+	    const char *q = p;
+
+	    while (q > s && isspace(*(q - 1))) {
+		q--;
+	    }
+	    ok = q > s && *(q - 1) == '&';
+	}
+	if (ok) {
+	    return 1;
+	}
+	p += n;
+    }
+
+    return 0;
+}
+
+/* check for a "params" or "deriv" line within an estimation
+   block: the objects named there are written to in place */
+
+static int is_estimator_param_line (const char *s)
+{
+    int n;
+
+    s += strspn(s, " \t");
+    n = gretl_namechar_spn(s);
+
+    if (n == 6 && !strncmp(s, "params", 6)) {
+	return isspace(s[n]);
+    } else if (n == 5 && !strncmp(s, "deriv", 5)) {
+	return isspace(s[n]);
+    } else {
+	return 0;
+    }
+}
+
+static int param_may_be_modified (ufunc *u, const char *name)
+{
+    int i, indirect = 0;
+
+    for (i=0; i<u->n_lines; i++) {
+	const char *s = u->lines[i].s;
+
+	if (s == NULL || u->lines[i].ignore) {
+	    continue;
+	}
+	if (statement_target_is(s, name, &indirect) || indirect) {
+	    return 1;
+	}
+	if (name_occurs_in(s, name, 1)) {
+	    return 1;
+	}
+	if (strstr(s, "setnote") != NULL && name_occurs_in(s, name, 0)) {
+	    return 1;
+	}
+	if (is_estimator_param_line(s) && name_occurs_in(s, name, 0)) {
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+static void maybe_set_shared_params (ufunc *u)
+{
+    fn_param *fp;
+    int i;
+
+    for (i=0; i<u->n_params; i++) {
+	fp = &u->params[i];
+	if (fp->flags & ARG_SCANNED) {
+	    continue;
+	}
+	fp->flags |= ARG_SCANNED;
+	if ((fp->type == GRETL_TYPE_MATRIX ||
+	     fp->type == GRETL_TYPE_BUNDLE ||
+	     gretl_array_type(fp->type)) &&
+	    !(fp->flags & ARG_CONST) &&
+	    !param_may_be_modified(u, fp->name)) {
+	    fp->flags |= ARG_SHARED;
+	}
+    }
+}
+
+/* A shared parameter can take its argument without copying
+   provided the argument is a named object, the object is not
+   also supplied for any other parameter in the same call, and
+   no argument is passed in pointer form. An anonymous argument
+   may point into another object (e.g. a bundle member or a
+   submatrix view), which a pointer argument would allow the
+   function to invalidate.
+*/
+
+static int arg_is_shareable (fncall *call, int i)
+{
+    fn_arg *ai = &call->args[i];
+    GretlType ti, tj;
+    void *di, *dj;
+    int j;
+
+    if (!(call->fun->params[i].flags & ARG_SHARED) ||
+	ai->upname[0] == '\0') {
+	return 0;
+    }
+
+    di = arg_get_object(ai, &ti);
+    if (di == NULL) {
+	return 0;
+    }
+
+    for (j=0; j<call->argc; j++) {
+	fn_arg *aj = &call->args[j];
+
+	if (j == i) {
+	    continue;
+	} else if (gretl_ref_type(aj->type) ||
+		   !strcmp(ai->upname, aj->upname)) {
+	    return 0;
+	}
+	dj = arg_get_object(aj, &tj);
+	if (dj == di) {
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
 static int duplicated_pointer_arg_check (fn_arg *args, int argc)
 {
     fn_arg *ai, *aj;
@@ -6394,6 +6622,10 @@ static int allocate_function_args (fncall *call, DATASET *dset)
 
     err = duplicated_pointer_arg_check(call->args, call->argc);
 
+    if (!err) {
+	maybe_set_shared_params(fun);
+    }
+
     for (i=0; i<call->argc && !err; i++) {
 	arg = &call->args[i];
 	fp = &fun->params[i];
@@ -6421,15 +6653,25 @@ static int allocate_function_args (fncall *call, DATASET *dset)
 	} else if (fp->type == GRETL_TYPE_MATRIX) {
 	    if (arg->type != GRETL_TYPE_NONE) {
 		if (fp->flags & ARG_CONST) {
-		    err = localize_const_matrix(arg, fp);
+		    err = localize_const_object(arg, fp);
+		} else if (arg_is_shareable(call, i)) {
+		    err = localize_const_object(arg, fp);
 		} else {
 		    err = copy_as_arg(fp->name, fp->type, arg->val.m);
 		}
 	    }
 	} else if (fp->type == GRETL_TYPE_BUNDLE) {
-	    err = copy_as_arg(fp->name, fp->type, arg->val.b);
+	    if (arg_is_shareable(call, i)) {
+		err = localize_const_object(arg, fp);
+	    } else {
+		err = copy_as_arg(fp->name, fp->type, arg->val.b);
+	    }
 	} else if (gretl_array_type(fp->type)) {
-	    err = copy_as_arg(fp->name, fp->type, arg->val.a);
+	    if (arg_is_shareable(call, i)) {
+		err = localize_const_object(arg, fp);
+	    } else {
+		err = copy_as_arg(fp->name, fp->type, arg->val.a);
+	    }
 	} else if (fp->type == GRETL_TYPE_LIST) {
 	    err = localize_list(call, arg, fp, dset);
 	} else if (fp->type == GRETL_TYPE_STRING) {
@@ -6881,6 +7123,26 @@ static int is_pointer_arg (fncall *call, int rtype)
     return 0;
 }
 
+/* check whether the return value is a const (or shared)
+   argument, which must be copied rather than "stolen" */
+
+static int is_const_arg (fncall *call)
+{
+    if (call->retname != NULL) {
+	int i;
+
+	for (i=0; i<call->argc; i++) {
+	    if ((call->args[i].flags & ARG_CONST) &&
+		call->args[i].name != NULL &&
+		!strcmp(call->args[i].name, call->retname)) {
+		return 1;
+	    }
+	}
+    }
+
+    return 0;
+}
+
 #define null_return(t) (t == GRETL_TYPE_VOID || t == GRETL_TYPE_NONE)
 
 #define needs_dataset(t) (t == GRETL_TYPE_SERIES || \
@@ -6917,7 +7179,7 @@ function_assign_returns (fncall *call, int rtype,
 	/* first we work on the value directly returned by the
 	   function (but only if there's no error) 
 	*/
-	int copy = is_pointer_arg(call, rtype);
+	int copy = is_pointer_arg(call, rtype) || is_const_arg(call);
 
 	if (rtype == GRETL_TYPE_DOUBLE) {
 	    err = handle_scalar_return(call->retname, ret);
@@ -6973,11 +7235,14 @@ function_assign_returns (fncall *call, int rtype,
 	    } else if (gretl_ref_type(arg->type)) {
 		user_var_unlocalize(fp->name, arg->upname, fp->type);
 	    } 
-	} else if (fp->type == GRETL_TYPE_MATRIX && 
-		   (fp->flags & ARG_CONST) && 
+	} else if ((fp->type == GRETL_TYPE_MATRIX ||
+		    fp->type == GRETL_TYPE_BUNDLE ||
+		    gretl_array_type(fp->type)) &&
+		   (arg->flags & ARG_CONST) && 
 		   arg->upname[0] != '\0') {
-	    /* non-pointerized const matrix argument */
-	    user_var *u = get_user_var_by_data(arg->val.m);
+	    /* non-pointerized const (or shared) argument */
+	    GretlType type;
+	    user_var *u = get_user_var_by_data(arg_get_object(arg, &type));
 
 	    if (u != NULL) {
 		user_var_adjust_level(u, -1);
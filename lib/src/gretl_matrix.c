@@ -38,6 +38,18 @@
 
 #if defined(USE_AVX)
 # define USE_SIMD 1
+#endif
+
+/* run-time selection of SIMD kernels, see matrix_simd.c */
+#if defined(__GNUC__) && defined(HAVE_IMMINTRIN_H) && \
+    (defined(__x86_64__) || defined(__i386__))
+# define SIMD_DISPATCH 1
+# if __GNUC__ >= 6 || defined(__clang__)
+#  define SIMD_HAVE_AVX512 1
+# endif
+#endif
+
+#if defined(USE_SIMD) || defined(SIMD_DISPATCH)
 # if defined(HAVE_IMMINTRIN_H)
 #  include <immintrin.h>
 # else
@@ -80,21 +92,229 @@ struct gretl_matrix_block_ {
 #define INFO_INVALID 0xdeadbeef
 #define is_block_matrix(m) (m->info == (matrix_info *) INFO_INVALID)
 
-static inline void *mval_malloc (size_t sz)
+/* Allocation of the data arrays of matrices. Where posix_memalign()
+   is available these arrays are aligned on a 64-byte boundary, which
+   permits aligned SIMD loads. Arrays of up to MVAL_POOL_MAX bytes are
+   allocated in power-of-two size classes, and when freed they are
+   parked in a small cache from which later requests in the same
+   class are served: this removes most of the malloc/free traffic
+   generated by temporary matrices in iterative code. Pooled blocks
+   come from the system allocator, so they remain valid arguments to
+   free() -- ownership of a data array can still be passed out of a
+   matrix, as in gretl_matrix_steal_data().
+
+   Not every data array passed to mval_free() was produced by
+   mval_malloc(), so before parking a block we ask the system
+   allocator for its actual capacity: a block is filed under a given
+   class only if it can really hold that many bytes. Since this
+   requires malloc_usable_size(), the cache is compiled only where
+   that function is available. The cache is used only by the thread
+   that called libgretl_init() (see gretl_matrix_pool_init); other
+   threads, such as OpenMP workers, allocate and free directly, so
+   nothing is left behind when they exit.
+*/
+
+#define MVAL_ALIGN 64
+#define MVAL_MIN_CLASS 6      /* smallest class: 64 bytes */
+#define MVAL_N_CLASSES 10     /* largest class: 32 KB */
+#define MVAL_CACHE_DEPTH 8    /* max number of blocks cached per class */
+
+#define MVAL_CLASS_SIZE(k) ((size_t) 1 << (MVAL_MIN_CLASS + (k)))
+#define MVAL_POOL_MAX MVAL_CLASS_SIZE(MVAL_N_CLASSES - 1)
+
+#define mval_size(m) ((size_t) (m)->rows * (m)->cols * sizeof(double))
+
+#if defined(__GNUC__) && defined(HAVE_MALLOC_USABLE_SIZE)
+# define MVAL_POOL 1
+# include <malloc.h>
+#endif
+
+#ifdef MVAL_POOL
+
+typedef struct mval_pool_ mval_pool;
+
+struct mval_pool_ {
+    void *blocks[MVAL_N_CLASSES][MVAL_CACHE_DEPTH];
+    int n[MVAL_N_CLASSES];
+    unsigned long hits;     /* requests served from the cache */
+    unsigned long misses;   /* poolable requests passed to the system */
+    unsigned long parked;   /* blocks returned to the cache */
+    unsigned long dropped;  /* poolable blocks freed, cache full */
+};
+
+static mval_pool mpool;
+
+/* non-zero only for the thread that owns @mpool */
+static __thread int mpool_owner;
+
+static int mval_class (size_t sz)
+{
+    int k = 0;
+
+    while (MVAL_CLASS_SIZE(k) < sz) {
+	k++;
+    }
+
+    return k;
+}
+
+/* can the block at @ptr be filed under size class @k? */
+
+static int mval_fits_class (void *ptr, int k)
+{
+#ifdef HAVE_POSIX_MEMALIGN
+    if ((size_t) ptr % MVAL_ALIGN) {
+	/* not aligned as ours are */
+	return 0;
+    }
+#endif
+    return malloc_usable_size(ptr) >= MVAL_CLASS_SIZE(k);
+}
+
+#endif /* MVAL_POOL */
+
+/**
+ * gretl_matrix_pool_init:
+ *
+ * Called by libgretl_init(): enables the cache used for recycling
+ * the storage of small matrices, for the calling thread only.
+ */
+
+void gretl_matrix_pool_init (void)
 {
+#ifdef MVAL_POOL
+    mpool_owner = 1;
+#endif
+}
+
+static void *mval_sys_malloc (size_t sz)
+{
+#ifdef HAVE_POSIX_MEMALIGN
+    void *ptr = NULL;
+
+    /* round up to a whole number of alignment units, which
+       also forestalls "invalid reads" by OpenBLAS */
+    sz = (sz + MVAL_ALIGN - 1) & ~((size_t) MVAL_ALIGN - 1);
+    if (posix_memalign(&ptr, MVAL_ALIGN, sz) != 0) {
+	ptr = NULL;
+    }
+    return ptr;
+#else
     /* forestall "invalid reads" by OpenBLAS */
     return malloc(sz % 16 ? sz + 8 : sz);
+#endif
+}
+
+static void *mval_malloc (size_t sz)
+{
+#ifdef MVAL_POOL
+    if (mpool_owner && sz <= MVAL_POOL_MAX) {
+	int k = mval_class(sz);
+
+	if (mpool.n[k] > 0) {
+	    mpool.hits += 1;
+	    return mpool.blocks[k][--mpool.n[k]];
+	}
+	mpool.misses += 1;
+	return mval_sys_malloc(MVAL_CLASS_SIZE(k));
+    }
+#endif
+
+    return mval_sys_malloc(sz);
+}
+
+static void mval_free (void *ptr, size_t sz)
+{
+    if (ptr == NULL) {
+	return;
+    }
+
+#ifdef MVAL_POOL
+    if (mpool_owner && sz > 0 && sz <= MVAL_POOL_MAX) {
+	int k = mval_class(sz);
+
+	if (!mval_fits_class(ptr, k)) {
+	    /* not one of ours */
+	    free(ptr);
+	    return;
+	}
+	if (mpool.n[k] < MVAL_CACHE_DEPTH) {
+	    mpool.blocks[k][mpool.n[k]++] = ptr;
+	    mpool.parked += 1;
+	    return;
+	}
+	mpool.dropped += 1;
+    }
+#endif
+
+    free(ptr);
 }
 
-static inline void *mval_realloc (void *ptr, size_t sz)
+static void *mval_realloc (void *ptr, size_t oldsz, size_t sz)
 {
-    /* comment as for mval_malloc() */
+#ifdef MVAL_POOL
+    if (mpool_owner && (sz <= MVAL_POOL_MAX ||
+			(oldsz > 0 && oldsz <= MVAL_POOL_MAX))) {
+	/* the old or the new block belongs to the pool's
+	   size range */
+	void *newptr;
+
+	if (ptr != NULL && oldsz > 0 && oldsz <= MVAL_POOL_MAX) {
+	    int k = mval_class(oldsz);
+
+	    if (sz <= MVAL_CLASS_SIZE(k) && mval_fits_class(ptr, k)) {
+		/* the new size fits in the current class */
+		return ptr;
+	    }
+	}
+	newptr = mval_malloc(sz);
+	if (newptr != NULL && ptr != NULL) {
+	    memcpy(newptr, ptr, oldsz < sz ? oldsz : sz);
+	    mval_free(ptr, oldsz);
+	}
+	return newptr;
+    }
+#endif
+
+    /* comment as for mval_sys_malloc() */
     return realloc(ptr, sz % 16 ? sz + 8 : sz);
 }
 
-#define mval_free(m) free(m)
+/**
+ * gretl_matrix_pool_cleanup:
+ *
+ * Cleanup function, called by libgretl_cleanup(). Frees any
+ * matrix storage held in the allocation cache. If the environment
+ * variable GRETL_MATRIX_DEBUG is set, statistics on use of the
+ * cache are printed to stderr.
+ */
+
+void gretl_matrix_pool_cleanup (void)
+{
+#ifdef MVAL_POOL
+    int i, k;
+
+    if (!mpool_owner) {
+	return;
+    }
+
+    if (getenv("GRETL_MATRIX_DEBUG")) {
+	fprintf(stderr, "matrix pool: hits %lu, misses %lu, "
+		"parked %lu, dropped %lu\n", mpool.hits,
+		mpool.misses, mpool.parked, mpool.dropped);
+    }
+
+    for (k=0; k<MVAL_N_CLASSES; k++) {
+	for (i=0; i<mpool.n[k]; i++) {
+	    free(mpool.blocks[k][i]);
+	}
+	mpool.n[k] = 0;
+    }
+#endif
+}
 
-#ifdef USE_SIMD
+#if defined(USE_SIMD) || defined(SIMD_DISPATCH)
+static double x_op_y (double x, double y, int op);
 # include "matrix_simd.c"
 #endif
 
@@ -587,7 +807,7 @@ int gretl_matrix_realloc (gretl_matrix *m, int rows, int cols)
 	return E_DATA;
     }
 
-    x = mval_realloc(m->val, n * sizeof *m->val);
+    x = mval_realloc(m->val, mval_size(m), n * sizeof *m->val);
     if (x == NULL) {
 	return E_ALLOC;
     }
@@ -1128,7 +1348,7 @@ void gretl_matrix_free (gretl_matrix *m)
     }
 
     if (m->val != NULL) {
-	mval_free(m->val);
+	mval_free(m->val, mval_size(m));
     }
 
     if (m->info != NULL) {
@@ -2154,6 +2374,22 @@ int get_simd_mn_min (void)
 
 #define simd_add_sub(mn) (simd_mn_min > 0 && mn >= simd_mn_min)
 
+#if defined(SIMD_DISPATCH)
+
+/* get the run-time selected SIMD kernels if they're available and
+   the matrix size @mn warrants their use, otherwise NULL */
+
+static const simd_kernels *simd_kernels_for (int mn)
+{
+    if (simd_mn_min > 0 && mn >= simd_mn_min) {
+	return simd_get_kernels();
+    } else {
+	return NULL;
+    }
+}
+
+#endif
+
 /**
  * gretl_matrix_add_to:
  * @targ: target matrix.
@@ -2553,7 +2789,7 @@ int gretl_matrix_transpose_in_place (gretl_matrix *m)
 	    }
 	}
 	
-	mval_free(val);
+	mval_free(val, sz);
     }
 
     return 0;
@@ -3546,10 +3782,10 @@ double gretl_matrix_log_abs_determinant (gretl_matrix *a, int *err)
 
 static void matrix_grab_content (gretl_matrix *targ, gretl_matrix *src)
 {
+    mval_free(targ->val, mval_size(targ));
+
     targ->rows = src->rows;
     targ->cols = src->cols;
-    
-    mval_free(targ->val);
     targ->val = src->val;
     src->val = NULL;
 
@@ -4045,10 +4281,13 @@ int gretl_cholesky_decomp_solve (gretl_matrix *a, gretl_matrix *b)
     m = b->cols;
 
     dpotrf_(&uplo, &n, a->val, &n, &info);   
-    if (info != 0) {
-	fprintf(stderr, "gretl_cholesky_decomp_solve: "
-		"dpotrf failed with info = %d (n = %d)\n", (int) info, (int) n);
-	err = (info > 0)? E_NOTPD : E_DATA;
+    if (info > 0) {
+	/* the standard message for E_NOTPD will do */
+	err = E_NOTPD;
+    } else if (info < 0) {
+	gretl_errmsg_sprintf("dpotrf: illegal value in argument %d",
+			     (int) -info);
+	err = E_DATA;
     } 
 
     if (!err) {
@@ -5508,6 +5747,144 @@ gretl_matrix_kronecker_product_new (const gretl_matrix *A,
     return K;
 }
 
+/**
+ * gretl_matrix_kronecker_multiply:
+ * @A: left-hand Kronecker factor, p x q.
+ * @B: right-hand Kronecker factor, r x s.
+ * @X: matrix, (q * s) x m.
+ * @C: target matrix, (p * r) x m.
+ *
+ * Writes into @C the product (@A \otimes @B) @X without forming
+ * the Kronecker product, using the identity
+ * (A \otimes B) vec(V) = vec(B V A') applied to each column of
+ * @X, viewed as an s x q matrix V. This takes O(m(rsq + rqp))
+ * operations as opposed to O(m pqrs).
+ *
+ * Returns: 0 on success, non-zero error code on failure.
+ */
+
+int gretl_matrix_kronecker_multiply (const gretl_matrix *A,
+				     const gretl_matrix *B,
+				     const gretl_matrix *X,
+				     gretl_matrix *C)
+{
+    gretl_matrix *BV;
+    gretl_matrix V, W;
+    int p, q, r, s;
+    int j, err = 0;
+
+    if (gretl_is_null_matrix(A) || gretl_is_null_matrix(B) ||
+	gretl_is_null_matrix(X) || gretl_is_null_matrix(C)) {
+	return E_DATA;
+    }
+
+    p = A->rows;
+    q = A->cols;
+    r = B->rows;
+    s = B->cols;
+
+    if (X->rows != q * s || C->rows != p * r || C->cols != X->cols) {
+	return E_NONCONF;
+    }
+
+    BV = gretl_matrix_alloc(r, q);
+    if (BV == NULL) {
+	return E_ALLOC;
+    }
+
+    for (j=0; j<X->cols && !err; j++) {
+	gretl_matrix_init_full(&V, s, q, X->val + j * X->rows);
+	gretl_matrix_init_full(&W, r, p, C->val + j * C->rows);
+	err = gretl_matrix_multiply(B, &V, BV);
+	if (!err) {
+	    err = gretl_matrix_multiply_mod(BV, GRETL_MOD_NONE,
+					    A, GRETL_MOD_TRANSPOSE,
+					    &W, GRETL_MOD_NONE);
+	}
+    }
+
+    gretl_matrix_free(BV);
+
+    return err;
+}
+
+/**
+ * gretl_matrix_kronecker_qform:
+ * @X: matrix, m x (p * r), or (p * r) x m if transposed.
+ * @xmod: %GRETL_MOD_NONE or %GRETL_MOD_TRANSPOSE.
+ * @A: left-hand Kronecker factor, p x p.
+ * @B: right-hand Kronecker factor, r x r.
+ * @C: target matrix, m x m.
+ *
+ * Computes X (@A \otimes @B) X' (or X' (@A \otimes @B) X if
+ * @xmod is %GRETL_MOD_TRANSPOSE) and writes the result into
+ * @C, without forming the Kronecker product; see also
+ * gretl_matrix_kronecker_multiply().
+ *
+ * Returns: 0 on success, non-zero error code on failure.
+ */
+
+int gretl_matrix_kronecker_qform (const gretl_matrix *X,
+				  GretlMatrixMod xmod,
+				  const gretl_matrix *A,
+				  const gretl_matrix *B,
+				  gretl_matrix *C)
+{
+    gretl_matrix *XT = NULL;
+    gretl_matrix *KX = NULL;
+    const gretl_matrix *Z;
+    int n, m, err = 0;
+
+    if (gretl_is_null_matrix(X) || gretl_is_null_matrix(A) ||
+	gretl_is_null_matrix(B) || gretl_is_null_matrix(C)) {
+	return E_DATA;
+    }
+
+    n = A->rows * B->rows;
+
+    if (xmod == GRETL_MOD_TRANSPOSE) {
+	m = X->cols;
+	if (X->rows != n) {
+	    return E_NONCONF;
+	}
+	Z = X;
+    } else {
+	m = X->rows;
+	if (X->cols != n) {
+	    return E_NONCONF;
+	}
+	Z = XT = gretl_matrix_copy_transpose(X);
+	if (XT == NULL) {
+	    return E_ALLOC;
+	}
+    }
+
+    if (A->cols != A->rows || B->cols != B->rows ||
+	C->rows != m || C->cols != m) {
+	err = E_NONCONF;
+    } else {
+	KX = gretl_matrix_alloc(n, m);
+	if (KX == NULL) {
+	    err = E_ALLOC;
+	}
+    }
+
+    if (!err) {
+	err = gretl_matrix_kronecker_multiply(A, B, Z, KX);
+    }
+
+    if (!err) {
+	err = gretl_matrix_multiply_mod(Z, GRETL_MOD_TRANSPOSE,
+					KX, GRETL_MOD_NONE,
+					C, GRETL_MOD_NONE);
+    }
+
+    gretl_matrix_free(XT);
+    gretl_matrix_free(KX);
+
+    return err;
+}
+
 /**
  * gretl_matrix_hdproduct:
  * @A: left-hand matrix, p x q.
@@ -5976,6 +6353,73 @@ static int math_err_check (const char *msg)
 #endif    
 }
 
+#if defined(SIMD_DISPATCH)
+
+/* SIMD implementation of gretl_matrix_dot_op(): returns 1 if the
+   operation was handled, 0 if it should be done by the generic
+   code. The result matrix @c is already allocated.
+*/
+
+static int simd_dot_op (const gretl_matrix *a, const gretl_matrix *b,
+			gretl_matrix *c, int op, int conftype)
+{
+    const simd_kernels *K;
+    int nr = c->rows;
+    int nc = c->cols;
+    int j;
+
+    if (!simd_op_supported(op)) {
+	return 0;
+    }
+
+    K = simd_kernels_for(nr * nc);
+    if (K == NULL) {
+	return 0;
+    }
+
+    switch (conftype) {
+    case CONF_ELEMENTS:
+	K->binop(a->val, b->val, c->val, nr * nc, op, SIMD_BC_NONE);
+	break;
+    case CONF_A_SCALAR:
+	K->binop(a->val, b->val, c->val, nr * nc, op, SIMD_BC_A);
+	break;
+    case CONF_B_SCALAR:
+	K->binop(a->val, b->val, c->val, nr * nc, op, SIMD_BC_B);
+	break;
+    case CONF_A_COLVEC:
+	for (j=0; j<nc; j++) {
+	    K->binop(a->val, b->val + j*nr, c->val + j*nr,
+		     nr, op, SIMD_BC_NONE);
+	}
+	break;
+    case CONF_B_COLVEC:
+	for (j=0; j<nc; j++) {
+	    K->binop(a->val + j*nr, b->val, c->val + j*nr,
+		     nr, op, SIMD_BC_NONE);
+	}
+	break;
+    case CONF_A_ROWVEC:
+	for (j=0; j<nc; j++) {
+	    K->binop(a->val + j, b->val + j*nr, c->val + j*nr,
+		     nr, op, SIMD_BC_A);
+	}
+	break;
+    case CONF_B_ROWVEC:
+	for (j=0; j<nc; j++) {
+	    K->binop(a->val + j*nr, b->val + j, c->val + j*nr,
+		     nr, op, SIMD_BC_B);
+	}
+	break;
+    default:
+	return 0;
+    }
+
+    return 1;
+}
+
+#endif /* SIMD_DISPATCH */
+
 /**
  * gretl_matrix_dot_op:
  * @a: left-hand matrix.
@@ -6147,6 +6591,12 @@ gretl_matrix *gretl_matrix_dot_op (const gretl_matrix *a,
 
 #endif /* _OPENMP */
 
+#if defined(SIMD_DISPATCH)
+    if (simd_dot_op(a, b, c, op, conftype)) {
+	goto finish;
+    }
+#endif
+
     switch (conftype) {
     case CONF_ELEMENTS:
 	nv = m * n;
@@ -6236,7 +6686,7 @@ gretl_matrix *gretl_matrix_dot_op (const gretl_matrix *a,
 	break;
     }
 
-#if defined(_OPENMP)
+#if defined(_OPENMP) || defined(SIMD_DISPATCH)
  finish:
 #endif
 
@@ -6452,6 +6902,9 @@ static gretl_matrix *gretl_matrix_sum (const gretl_matrix *m, int bycol,
 {
 
     gretl_matrix *s = NULL;
+#if defined(SIMD_DISPATCH)
+    const simd_kernels *K;
+#endif
     int dim, i;
 
     if (gretl_is_null_matrix(m)) {
@@ -6469,10 +6922,29 @@ static gretl_matrix *gretl_matrix_sum (const gretl_matrix *m, int bycol,
     
     if (s == NULL) {
 	*err = E_ALLOC;
-    } else {
-	for (i=0; i<dim; i++) {
-	    s->val[i] = (bycol)? col_sum(m, i) : row_sum(m, i);
+	return NULL;
+    }
+
+#if defined(SIMD_DISPATCH)
+    K = simd_kernels_for(m->rows * m->cols);
+    if (K != NULL) {
+	if (bycol) {
+	    for (i=0; i<dim; i++) {
+		s->val[i] = K->sum(m->val + i * m->rows, m->rows);
+	    }
+	} else {
+	    /* accumulate the columns, in order */
+	    memcpy(s->val, m->val, dim * sizeof(double));
+	    for (i=1; i<m->cols; i++) {
+		K->vadd(s->val, m->val + i * m->rows, dim);
+	    }
 	}
+	return s;
+    }
+#endif
+
+    for (i=0; i<dim; i++) {
+	s->val[i] = (bycol)? col_sum(m, i) : row_sum(m, i);
     }
 
     return s;
@@ -6665,6 +7137,9 @@ gretl_matrix *gretl_matrix_column_sd2 (const gretl_matrix *m,
 				       int df, int *err)
 {
     gretl_matrix *s;
+#if defined(SIMD_DISPATCH)
+    const simd_kernels *K;
+#endif
     int i, j;
 
     if (gretl_is_null_matrix(m)) {
@@ -6683,6 +7158,21 @@ gretl_matrix *gretl_matrix_column_sd2 (const gretl_matrix *m,
 	df = m->rows;
     }
 
+#if defined(SIMD_DISPATCH)
+    K = simd_kernels_for(m->rows * m->cols);
+    if (K != NULL) {
+	const double *x = m->val;
+	double xbar;
+
+	for (j=0; j<m->cols; j++) {
+	    xbar = K->sum(x, m->rows) / m->rows;
+	    s->val[j] = sqrt(K->ssd(x, m->rows, xbar) / df);
+	    x += m->rows;
+	}
+	return s;
+    }
+#endif
+
     for (j=0; j<m->cols; j++) {
 	double dev, v = 0.0, xbar = 0.0;
 
@@ -7427,7 +7917,7 @@ int gretl_matrix_psd_root (gretl_matrix *a)
     }
 
     if (!err) {
-	mval_free(a->val);
+	mval_free(a->val, mval_size(a));
 	a->val = L->val;
 	L->val = NULL;
     }
@@ -8687,7 +9177,8 @@ gretl_general_matrix_eigenvals (gretl_matrix *m, int eigenvecs, int *err)
  * @rank: desired number of columns in output.
  * 
  * Sorts the eigenvalues in @evals from largest to smallest, and 
- * rearranges the columns in @evecs correspondingly.  If @rank is 
+ * rearranges the columns in @evecs correspondingly (@evecs should
+ * have one column per element of @evals).  If @rank is 
  * greater than zero and less than the number of columns in @evecs, 
  * then on output @evecs is shrunk so that it contains only the 
  * columns associated with the largest @rank eigenvalues.
@@ -8707,10 +9198,10 @@ int gretl_symmetric_eigen_sort (gretl_matrix *evals, gretl_matrix *evecs,
     }
 
     if (evecs != NULL) {
-	if (evecs->rows != n || evecs->cols != n) {
+	if (evecs->cols != n) {
 	    err = E_DATA;
 	} else {
-	    tmp = malloc(n * sizeof *tmp);
+	    tmp = malloc(evecs->rows * sizeof *tmp);
 	    if (tmp == NULL) {
 		err = E_ALLOC;
 	    }
@@ -8732,18 +9223,20 @@ int gretl_symmetric_eigen_sort (gretl_matrix *evals, gretl_matrix *evecs,
 
 	if (evecs != NULL) {
 	    /* using tmp, reverse the columns of @evecs */
+	    int r = evecs->rows;
+
 	    k = n - 1;
 	    for (j=0; j<m; j++) {
-		for (i=0; i<n; i++) {
+		for (i=0; i<r; i++) {
 		    /* col j -> tmp */
 		    tmp[i] = gretl_matrix_get(evecs, i, j);
 		}
-		for (i=0; i<n; i++) {
+		for (i=0; i<r; i++) {
 		    /* col k -> col j */
 		    x = gretl_matrix_get(evecs, i, k);
 		    gretl_matrix_set(evecs, i, j, x);
 		}
-		for (i=0; i<n; i++) {
+		for (i=0; i<r; i++) {
 		    /* tmp -> col k */
 		    gretl_matrix_set(evecs, i, k, tmp[i]);
 		}
@@ -8888,6 +9381,145 @@ gretl_symm_matrix_eigenvals_descending (gretl_matrix *m,
     return v;
 } 
 
+/**
+ * gretl_symmetric_matrix_eigenvals_partial:
+ * @m: n x n symmetric matrix.
+ * @k: number of eigenvalues wanted, 1 <= @k <= n.
+ * @evecs: location to receive the n x @k matrix of
+ * eigenvectors, or NULL if they are not wanted.
+ * @err: location to receive error code.
+ *
+ * Computes the @k largest eigenvalues of the real symmetric
+ * matrix @m and, optionally, the associated orthonormal
+ * eigenvectors. Unlike gretl_symmetric_matrix_eigenvals() this
+ * uses the lapack function dsyevr() with an index range, so
+ * the cost of the back-transformation is proportional to @k
+ * rather than n, and @m is not modified.
+ *
+ * Returns: @k x 1 matrix containing the eigenvalues in ascending
+ * order, or NULL on failure.
+ */
+
+gretl_matrix *
+gretl_symmetric_matrix_eigenvals_partial (const gretl_matrix *m,
+					  int k,
+					  gretl_matrix **evecs,
+					  int *err)
+{
+    integer n, il, iu, nfound = 0, info = 0;
+    integer ldz = 1, lwork = -1, liwork = -1;
+    integer iwq, *iwork = NULL, *isuppz = NULL;
+    double vl = 0.0, vu = 0.0, abstol = 0.0;
+    char jobz = (evecs != NULL)? 'V' : 'N';
+    char range = 'I';
+    char uplo = 'U';
+    gretl_matrix *a = NULL;
+    gretl_matrix *evals = NULL;
+    gretl_matrix *V = NULL;
+    double zdum, *zval = &zdum;
+    double *work = NULL;
+
+    *err = 0;
+
+    if (gretl_is_null_matrix(m)) {
+	*err = E_DATA;
+	return NULL;
+    }
+
+    if (!real_gretl_matrix_is_symmetric(m, 1)) {
+	fputs("gretl_symmetric_matrix_eigenvals_partial: matrix is "
+	      "not symmetric\n", stderr);
+	*err = E_NONCONF;
+	return NULL;
+    }
+
+    n = m->rows;
+
+    if (k < 1 || k > n) {
+	*err = E_INVARG;
+	return NULL;
+    }
+
+    il = n - k + 1;
+    iu = n;
+
+    a = gretl_matrix_copy_tmp(m);
+    evals = gretl_column_vector_alloc(n);
+    isuppz = malloc(2 * k * sizeof *isuppz);
+
+    if (a == NULL || evals == NULL || isuppz == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    if (evecs != NULL) {
+	V = gretl_matrix_alloc(n, k);
+	if (V == NULL) {
+	    *err = E_ALLOC;
+	    goto bailout;
+	}
+	ldz = n;
+	zval = V->val;
+    }
+
+    work = lapack_malloc(sizeof *work);
+    if (work == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    /* find optimal workspace sizes */
+    dsyevr_(&jobz, &range, &uplo, &n, a->val, &n, &vl, &vu,
+	    &il, &iu, &abstol, &nfound, evals->val, zval, &ldz,
+	    isuppz, work, &lwork, &iwq, &liwork, &info);
+
+    if (info != 0 || work[0] <= 0.0) {
+	*err = wspace_fail(info, work[0]);
+	goto bailout;
+    }
+
+    lwork = (integer) work[0];
+    liwork = iwq;
+
+    work = lapack_realloc(work, lwork * sizeof *work);
+    iwork = malloc(liwork * sizeof *iwork);
+    if (work == NULL || iwork == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    dsyevr_(&jobz, &range, &uplo, &n, a->val, &n, &vl, &vu,
+	    &il, &iu, &abstol, &nfound, evals->val, zval, &ldz,
+	    isuppz, work, &lwork, iwork, &liwork, &info);
+
+    if (info != 0) {
+	fprintf(stderr, "gretl_symmetric_matrix_eigenvals_partial: "
+		"dsyevr gave info = %d\n", (int) info);
+	*err = E_NOCONV;
+    } else if (nfound != k) {
+	*err = E_DATA;
+    } else {
+	gretl_matrix_reuse(evals, k, 1);
+    }
+
+ bailout:
+
+    lapack_free(work);
+    free(iwork);
+    free(isuppz);
+    gretl_matrix_free(a);
+
+    if (*err) {
+	gretl_matrix_free(evals);
+	gretl_matrix_free(V);
+	evals = NULL;
+    } else if (evecs != NULL) {
+	*evecs = V;
+    }
+
+    return evals;
+}
+
 static double get_extreme_eigenvalue (gretl_matrix *m, int getmax,
 				      int *err)
 {
@@ -9247,6 +9879,171 @@ int gretl_matrix_SVD (const gretl_matrix *a, gretl_matrix **pu,
     return real_gretl_matrix_SVD(a, pu, ps, pvt, SVD_FULL);
 }
 
+#define RSVD_OVERSAMPLE 10
+#define RSVD_POWER_ITERS 2
+
+/**
+ * gretl_matrix_rsvd:
+ * @a: m x n matrix to decompose.
+ * @k: number of singular values wanted, 1 <= @k <= min(m, n).
+ * @pu: location for m x @k matrix U, or NULL if not wanted.
+ * @pvt: location for @k x n matrix V (transposed), or NULL if
+ * not wanted.
+ * @err: location to receive error code.
+ *
+ * Computes a truncated singular value decomposition of @a,
+ * A ~ U * diag(s) * Vt, retaining the @k largest singular values,
+ * by the randomized range-finder method of Halko, Martinsson and
+ * Tropp (SIAM Review, 2011): @a is multiplied into a random
+ * Gaussian matrix with a few more than @k columns, an orthonormal
+ * basis Q for the result is refined by two power iterations, and
+ * the (small) SVD of Q'A is computed via dgesvd. The cost is of
+ * order m * n * k, as opposed to m * n * min(m, n) for the full
+ * decomposition. Note that the result depends on the state of
+ * the random number generator.
+ *
+ * Returns: 1 x @k vector of singular values in descending order,
+ * or NULL on failure.
+ */
+
+gretl_matrix *gretl_matrix_rsvd (const gretl_matrix *a, int k,
+				 gretl_matrix **pu,
+				 gretl_matrix **pvt,
+				 int *err)
+{
+    gretl_matrix *Y = NULL;
+    gretl_matrix *Z = NULL;
+    gretl_matrix *W = NULL;
+    gretl_matrix *s = NULL;
+    gretl_matrix *u = NULL;
+    gretl_matrix *vt = NULL;
+    gretl_matrix *U = NULL;
+    gretl_matrix *Vt = NULL;
+    int m, n, l, minmn;
+    int i, j;
+
+    *err = 0;
+
+    if (gretl_is_null_matrix(a)) {
+	*err = E_DATA;
+	return NULL;
+    }
+
+    m = a->rows;
+    n = a->cols;
+    minmn = (m < n)? m : n;
+
+    if (k < 1 || k > minmn) {
+	*err = E_INVARG;
+	return NULL;
+    }
+
+    l = k + RSVD_OVERSAMPLE;
+    if (l > minmn) {
+	l = minmn;
+    }
+
+    /* Y = A * Omega, then orthonormalize */
+    W = gretl_random_matrix_new(n, l, D_NORMAL);
+    Y = gretl_matrix_alloc(m, l);
+    Z = gretl_matrix_alloc(n, l);
+
+    if (W == NULL || Y == NULL || Z == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    *err = gretl_matrix_multiply(a, W, Y);
+    if (!*err) {
+	*err = gretl_matrix_QR_decomp(Y, NULL);
+    }
+
+    /* power iterations, re-orthonormalizing at each step */
+    for (i=0; i<RSVD_POWER_ITERS && !*err; i++) {
+	*err = gretl_matrix_multiply_mod(a, GRETL_MOD_TRANSPOSE,
+					 Y, GRETL_MOD_NONE,
+					 Z, GRETL_MOD_NONE);
+	if (!*err) {
+	    *err = gretl_matrix_QR_decomp(Z, NULL);
+	}
+	if (!*err) {
+	    *err = gretl_matrix_multiply(a, Z, Y);
+	}
+	if (!*err) {
+	    *err = gretl_matrix_QR_decomp(Y, NULL);
+	}
+    }
+
+    /* Z = A'Q = B', which is tall, so we can take its thin SVD:
+       B' = u * s * vt implies A ~ Q * B = (Q * vt') * s * u'
+    */
+    if (!*err) {
+	*err = gretl_matrix_multiply_mod(a, GRETL_MOD_TRANSPOSE,
+					 Y, GRETL_MOD_NONE,
+					 Z, GRETL_MOD_NONE);
+    }
+    if (!*err) {
+	*err = real_gretl_matrix_SVD(Z, (pvt != NULL)? &u : NULL, &s,
+				     (pu != NULL)? &vt : NULL, SVD_THIN);
+    }
+
+    if (!*err && pu != NULL) {
+	U = gretl_matrix_alloc(m, l);
+	if (U == NULL) {
+	    *err = E_ALLOC;
+	} else {
+	    *err = gretl_matrix_multiply_mod(Y, GRETL_MOD_NONE,
+					     vt, GRETL_MOD_TRANSPOSE,
+					     U, GRETL_MOD_NONE);
+	}
+	if (!*err) {
+	    /* drop the trailing columns */
+	    gretl_matrix_reuse(U, -1, k);
+	}
+    }
+
+    if (!*err && pvt != NULL) {
+	Vt = gretl_matrix_alloc(k, n);
+	if (Vt == NULL) {
+	    *err = E_ALLOC;
+	} else {
+	    for (j=0; j<n; j++) {
+		for (i=0; i<k; i++) {
+		    gretl_matrix_set(Vt, i, j, gretl_matrix_get(u, j, i));
+		}
+	    }
+	}
+    }
+
+    if (!*err) {
+	gretl_matrix_reuse(s, 1, k);
+    }
+
+ bailout:
+
+    gretl_matrix_free(W);
+    gretl_matrix_free(Y);
+    gretl_matrix_free(Z);
+    gretl_matrix_free(u);
+    gretl_matrix_free(vt);
+
+    if (*err) {
+	gretl_matrix_free(s);
+	gretl_matrix_free(U);
+	gretl_matrix_free(Vt);
+	s = NULL;
+    } else {
+	if (pu != NULL) {
+	    *pu = U;
+	}
+	if (pvt != NULL) {
+	    *pvt = Vt;
+	}
+    }
+
+    return s;
+}
+
 /**
  * gretl_matrix_SVD_johansen_solve:
  * @R0: T x p matrix of residuals.
@@ -12518,6 +13315,9 @@ gretl_matrix *gretl_matrix_minmax (const gretl_matrix *A,
 				   int *err)
 {
     gretl_matrix *B;
+#if defined(SIMD_DISPATCH)
+    const simd_kernels *K;
+#endif
     double d, x;
     int i, j, k;
     
@@ -12537,6 +13337,37 @@ gretl_matrix *gretl_matrix_minmax (const gretl_matrix *A,
 	return NULL;
     }
 
+#if defined(SIMD_DISPATCH)
+    K = simd_kernels_for(A->rows * A->cols);
+    if (K != NULL && rc == 0 && !idx) {
+	/* row extrema: accumulate across the columns */
+	memcpy(B->val, A->val, A->rows * sizeof(double));
+	for (j=1; j<A->cols; j++) {
+	    K->vminmax(B->val, A->val + j * A->rows, A->rows, mm);
+	}
+	return B;
+    } else if (K != NULL && rc == 1) {
+	const double *x = A->val;
+
+	for (j=0; j<A->cols; j++) {
+	    d = K->minmax(x, A->rows, mm);
+	    if (idx > 0) {
+		/* find the first occurrence of the extremum */
+		for (k=0; k<A->rows && !isnan(d); k++) {
+		    if (x[k] == d) {
+			break;
+		    }
+		}
+		B->val[j] = isnan(d) ? 1 : k + 1;
+	    } else {
+		B->val[j] = d;
+	    }
+	    x += A->rows;
+	}
+	return B;
+    }
+#endif
+
     if (rc == 0) {
 	for (i=0; i<A->rows; i++) {
 	    d = gretl_matrix_get(A, i, 0);
@@ -12630,7 +13461,18 @@ gretl_matrix *gretl_matrix_pca (const gretl_matrix *X, int p,
 	return NULL;
     }
 
-    evals = gretl_symmetric_matrix_eigenvals(C, 1, err);
+    if (p < m) {
+	/* only the leading @p eigenvectors are needed */
+	gretl_matrix *V = NULL;
+
+	evals = gretl_symmetric_matrix_eigenvals_partial(C, p, &V, err);
+	if (!*err) {
+	    gretl_matrix_free(C);
+	    C = V;
+	}
+    } else {
+	evals = gretl_symmetric_matrix_eigenvals(C, 1, err);
+    }
     if (*err) {
 	goto bailout;
     }
@@ -422,6 +422,17 @@ gretl_matrix_kronecker_product_new (const gretl_matrix *A,
 				    const gretl_matrix *B,
 				    int *err);
 
+int gretl_matrix_kronecker_multiply (const gretl_matrix *A,
+				     const gretl_matrix *B,
+				     const gretl_matrix *X,
+				     gretl_matrix *C);
+
+int gretl_matrix_kronecker_qform (const gretl_matrix *X,
+				  GretlMatrixMod xmod,
+				  const gretl_matrix *A,
+				  const gretl_matrix *B,
+				  gretl_matrix *C);
+
 int gretl_matrix_hdproduct (const gretl_matrix *A, 
 			    const gretl_matrix *B,
 			    gretl_matrix *C);
@@ -546,6 +557,11 @@ int gretl_maybe_invpd (gretl_matrix *a);
 int gretl_matrix_SVD (const gretl_matrix *a, gretl_matrix **pu, 
 		      gretl_vector **ps, gretl_matrix **pvt);
 
+gretl_matrix *gretl_matrix_rsvd (const gretl_matrix *a, int k,
+				 gretl_matrix **pu,
+				 gretl_matrix **pvt,
+				 int *err);
+
 double gretl_symmetric_matrix_rcond (const gretl_matrix *m, int *err);
 
 double gretl_matrix_rcond (const gretl_matrix *m, int *err);
@@ -568,6 +584,12 @@ gretl_symm_matrix_eigenvals_descending (gretl_matrix *m,
 					int eigenvecs, 
 					int *err);
 
+gretl_matrix *
+gretl_symmetric_matrix_eigenvals_partial (const gretl_matrix *m,
+					  int k,
+					  gretl_matrix **evecs,
+					  int *err);
+
 gretl_matrix *
 gretl_gensymm_eigenvals (const gretl_matrix *A, 
 			 const gretl_matrix *B, 
@@ -811,6 +833,10 @@ void gretl_matrix_destroy_info (gretl_matrix *m);
 
 void lapack_mem_free (void);
 
+void gretl_matrix_pool_init (void);
+
+void gretl_matrix_pool_cleanup (void);
+
 void set_blas_mnk_min (int mnk);
 
 int get_blas_mnk_min (void);
@@ -25,6 +25,10 @@
    nealmon hyper-parameters) and OLS: all coefficients other than
    the hyper-parameters are estimated via OLS conditional on the
    "theta" vector of hyper-parameters as optimized by L-BFGS-B.
+   Unless the --levenberg option is given this also covers
+   specifications with Almon polynomial terms, so that native
+   NLS (which needs the HF lags as actual series) is used only
+   on request.
 
    In case this proves to be a bad idea, we can go back to commit
    8aa2c9, the step before we started working towards conditional
@@ -69,6 +73,8 @@ struct midas_term_ {
     int nparm;             /* number of parameters */
     int nlags;             /* number of lag terms */
     int *laglist;          /* list of lag series */
+    int *lagv;             /* L-BFGS-B: series IDs of HF lags */
+    int *lagsh;            /* L-BFGS-B: low-frequency shifts of HF lags */
 };
 
 typedef struct midas_term_ midas_term;
@@ -424,6 +430,9 @@ static void midas_term_init (midas_term *mt)
     mt->type = 0;
     mt->nparm = 0;
     mt->nlags = 0;
+    mt->laglist = NULL;
+    mt->lagv = NULL;
+    mt->lagsh = NULL;
 }
 
 /* Parse a particular entry in the incoming array of MIDAS
@@ -661,11 +670,11 @@ parse_midas_specs (midas_info *mi, const char *spec,
     } else {
 	mi->nmidas = n_spec;
 	mi->nalmonp = n_almonp;
-	if (n_boxed > 0) {
-	    if (!(opt & OPT_L)) {
-		/* ! levenberg */
-		mi->method = MDS_BFGS;
-	    }
+	if (n_umidas < n_spec && !(opt & OPT_L)) {
+	    /* ! levenberg: any mix of terms other than pure
+	       U-MIDAS can be handled by conditional OLS, which
+	       reads the HF lags via a view */
+	    mi->method = MDS_BFGS;
 	} else if (n_umidas > 0) {
 	    err = umidas_check(mi, n_umidas);
 	}
@@ -711,14 +720,12 @@ static int make_midas_xlist (midas_info *mi)
    includes the required lags, just take a pointer to it.
 */
 
-static int *make_midas_laglist (midas_term *mt,
-				DATASET *dset,
-				int *err)
+static int *get_midas_term_list (midas_term *mt, int *err)
 {
     int *list = get_list_by_name(mt->lname);
 
     if (list == NULL) {
-	fprintf(stderr, "make_midas_laglist, '%s': no list!\n",
+	fprintf(stderr, "get_midas_term_list, '%s': no list!\n",
 		mt->lname);
 	*err = E_DATA;
 	return NULL;
@@ -732,7 +739,18 @@ static int *make_midas_laglist (midas_term *mt,
 	mt->flags |= M_PRELAG;
     }
 
-    if (prelag(mt)) {
+    return list;
+}
+
+static int *make_midas_laglist (midas_term *mt,
+				DATASET *dset,
+				int *err)
+{
+    int *list = get_midas_term_list(mt, err);
+
+    if (list == NULL) {
+	return NULL;
+    } else if (prelag(mt)) {
 	/* don't copy the list (and don't free it either!) */
 	return list;
     } else {
@@ -775,22 +793,119 @@ static int fcast_make_midas_laglists (midas_term *mterms,
     return err;
 }
 
+/* For estimation via L-BFGS-B we don't need the HF lags
+   of a MIDAS term as actual series: instead we set up a
+   "view" on the incoming list, under which HF lag j at
+   low-frequency observation t is found in series
+   mt->lagv[j] at observation t - mt->lagsh[j]. The
+   mapping replicates that of list_laggenr().
+*/
+
+static int make_midas_lagview (midas_term *mt,
+			       const DATASET *dset)
+{
+    int *list;
+    int j, err = 0;
+
+    list = get_midas_term_list(mt, &err);
+    if (err) {
+	return err;
+    }
+
+    if (prelag(mt)) {
+	mt->nlags = list[0];
+    } else if (mt->maxlag < mt->minlag) {
+	return E_INVARG;
+    } else if (dset->pd != 1 && dset->pd != 4 && dset->pd != 12) {
+	return E_PDWRONG;
+    } else {
+	if (!gretl_is_midas_list(list, dset)) {
+	    gretl_warnmsg_set("The argument does not seem to be a MIDAS list");
+	}
+	mt->nlags = mt->maxlag - mt->minlag + 1;
+    }
+
+    mt->lagv = malloc(mt->nlags * sizeof *mt->lagv);
+    mt->lagsh = malloc(mt->nlags * sizeof *mt->lagsh);
+    if (mt->lagv == NULL || mt->lagsh == NULL) {
+	return E_ALLOC;
+    }
+
+    if (prelag(mt)) {
+	for (j=0; j<mt->nlags; j++) {
+	    mt->lagv[j] = list[j+1];
+	    mt->lagsh[j] = 0;
+	}
+    } else {
+	int m = list[0];
+	int lmin = (int) ceil(mt->minlag / (double) m);
+	int skip = (mt->minlag - 1) % m;
+	int p;
+
+	if (skip < 0) {
+	    /* handle leads */
+	    skip += m;
+	}
+	for (j=0; j<mt->nlags; j++) {
+	    p = skip + j;
+	    mt->lagv[j] = list[p % m + 1];
+	    mt->lagsh[j] = lmin + p / m;
+	}
+    }
+
+    return 0;
+}
+
+/* Value of HF lag @j of MIDAS term @mt at observation @t,
+   read via the lag view: NA if out of range. */
+
+static double mview_get (const midas_term *mt,
+			 const DATASET *dset,
+			 int j, int t)
+{
+    int s = t - mt->lagsh[j];
+
+    if (s < 0 || s >= dset->n) {
+	return NADBL;
+    } else {
+	return dset->Z[mt->lagv[j]][s];
+    }
+}
+
+/* Pointer to the values of HF lag @j of MIDAS term @mt
+   over the current sample range, which must already have
+   been set by midas_set_sample().
+*/
+
+static const double *mview_column (const midas_term *mt,
+				   const DATASET *dset,
+				   int j)
+{
+    return dset->Z[mt->lagv[j]] + dset->t1 - mt->lagsh[j];
+}
+
 static int make_midas_laglists (midas_info *mi,
 				DATASET *dset)
 {
     midas_term *mt;
     int *mlist;
     int i, err = 0;
+
+    if (mi->method == MDS_BFGS) {
+	/* the lags don't have to be generated as series */
+	for (i=0; i<mi->nmidas && !err; i++) {
+	    err = make_midas_lagview(&mi->mterms[i], dset);
+	}
+	return err;
+    }
 	
     for (i=0; i<mi->nmidas && !err; i++) {
 	mt = &mi->mterms[i];
 	mlist = make_midas_laglist(mt, dset, &err);
 	if (!err) {
-	    if (!prelag(mt) && mi->method != MDS_BFGS) {
+	    if (!prelag(mt)) {
 		/* In the "prelag" case the laglist is already
-		   in userspace, and if method is BFGS the list
-		   doesn't need to be pushed into userspace.
-		*/
+		   in userspace */
 		sprintf(mt->lname, "ML___%d", i+1);
 		/* note: remember_list copies its first arg */
 		err = remember_list(mlist, mt->lname, NULL);
@@ -855,12 +970,76 @@ static int *make_midas_biglist (const int *list,
    big the X data matrix ought to be.
 */
 
+static int bfgs_obs_missing (midas_info *mi,
+			     const DATASET *dset,
+			     int t)
+{
+    const int *list = mi->list;
+    midas_term *mt;
+    int i, j, vi;
+
+    for (i=1; i<=list[0]; i++) {
+	vi = list[i];
+	if (vi > 0 && vi != LISTSEP && na(dset->Z[vi][t])) {
+	    return 1;
+	}
+    }
+
+    for (i=0; i<mi->nmidas; i++) {
+	mt = &mi->mterms[i];
+	for (j=0; j<mt->nlags; j++) {
+	    if (na(mview_get(mt, dset, j, t))) {
+		return 1;
+	    }
+	}
+    }
+
+    return 0;
+}
+
+/* counterpart to list_adjust_sample() for use when the
+   HF lags are accessed via views */
+
+static int bfgs_adjust_sample (midas_info *mi,
+			       const DATASET *dset,
+			       int *t1, int *t2)
+{
+    int t;
+
+    while (*t1 < *t2 && bfgs_obs_missing(mi, dset, *t1)) {
+	*t1 += 1;
+    }
+    while (*t2 > *t1 && bfgs_obs_missing(mi, dset, *t2)) {
+	*t2 -= 1;
+    }
+    for (t=*t1; t<=*t2; t++) {
+	if (bfgs_obs_missing(mi, dset, t)) {
+	    return E_MISSDATA;
+	}
+    }
+
+    return 0;
+}
+
 static int midas_set_sample (midas_info *mi,
 			     DATASET *dset)
 {
     int *biglist;
     int err = 0;
 
+    if (mi->method == MDS_BFGS) {
+	int t1 = dset->t1, t2 = dset->t2;
+
+	err = bfgs_adjust_sample(mi, dset, &t1, &t2);
+	if (!err) {
+	    dset->t1 = t1;
+	    dset->t2 = t2;
+	    mi->nobs = t2 - t1 + 1;
+	    mi->colsize = mi->nobs * sizeof(double);
+	}
+	return err;
+    }
+
     biglist = make_midas_biglist(mi->list, mi->mterms, mi->nmidas);
     if (biglist == NULL) {
 	err = E_ALLOC;
@@ -1198,9 +1377,7 @@ static int midas_bfgs_setup (midas_info *mi, DATASET *dset)
 	if (mt->type == MIDAS_U) {
 	    /* transcribe HF lags data */
 	    for (ii=0; ii<mt->nlags; ii++) {
-		vi = mt->laglist[ii+1];
-		src = dset->Z[vi] + dset->t1;
-		memcpy(targ, src, mi->colsize);
+		memcpy(targ, mview_column(mt, dset, ii), mi->colsize);
 		targ += mi->nobs;
 	    }
 	} else {
@@ -1270,8 +1447,9 @@ static double bfgs_ols_callback (double *theta, double *g,
     DATASET *dset = mi->dset;
     gretl_matrix *w;
     gretl_matrix *mg;
-    int i, j, k, t, s;
-    int vj, xcol;
+    const double *xj;
+    int i, j, k, t;
+    int xcol;
     int err = 0;
 
     if (mi->nalmonp > 0) {
@@ -1304,20 +1482,18 @@ static double bfgs_ols_callback (double *theta, double *g,
 	if (!err && mt->type == MIDAS_ALMONP) {
 	    /* net the estimated effect out of @y */
 	    for (j=0; j<mt->nlags; j++) {
-		vj = mt->laglist[j+1];
-		s = 0;
-		for (t=dset->t1; t<=dset->t2; t++) {
-		    mi->y->val[s++] -= dset->Z[vj][t] * w->val[j];
+		xj = mview_column(mt, dset, j);
+		for (t=0; t<mi->nobs; t++) {
+		    mi->y->val[t] -= xj[t] * w->val[j];
 		}
 	    }
 	} else if (!err) {
 	    /* fill the next X column and advance */
 	    gretl_matrix_zero(mi->xi);
 	    for (j=0; j<mt->nlags; j++) {
-		vj = mt->laglist[j+1];
-		s = 0;
-		for (t=dset->t1; t<=dset->t2; t++) {
-		    mi->xi->val[s++] += dset->Z[vj][t] * w->val[j];
+		xj = mview_column(mt, dset, j);
+		for (t=0; t<mi->nobs; t++) {
+		    mi->xi->val[t] += xj[t] * w->val[j];
 		}
 	    }
 	    for (t=0; t<mi->nobs; t++) {
@@ -1346,8 +1522,8 @@ static double bfgs_ols_callback (double *theta, double *g,
     
     for (i=0; i<mi->nmidas && !err; i++) {
 	midas_term *mt = &mi->mterms[i];
-	double xit;
-	int p, vp;
+	double gpj;
+	int p;
 
 	if (mt->type == MIDAS_U) {
 	    xcol += mt->nlags;
@@ -1360,16 +1536,13 @@ static double bfgs_ols_callback (double *theta, double *g,
 	for (j=0; j<mg->cols; j++) {
 	    /* loop across hyper-parameters for this term */
 	    gretl_matrix_zero(mi->xi);
-	    for (t=0; t<mi->nobs; t++) {
-		/* loop across observations */
-		s = t + dset->t1;
-		xit = 0.0;
-		for (p=0; p<mt->nlags; p++) {
-		    /* loop across HF lags at this observation */
-		    vp = mt->laglist[p+1];
-		    xit += dset->Z[vp][s] * gretl_matrix_get(mg, p, j);
+	    for (p=0; p<mt->nlags; p++) {
+		/* loop across HF lags */
+		xj = mview_column(mt, dset, p);
+		gpj = gretl_matrix_get(mg, p, j);
+		for (t=0; t<mi->nobs; t++) {
+		    mi->xi->val[t] += xj[t] * gpj;
 		}
-		mi->xi->val[t] = xit;
 	    }
 	    if (takes_coeff(mt->type)) {
 		gretl_matrix_multiply_by_scalar(mi->xi, mi->b->val[xcol]);
@@ -1488,7 +1661,7 @@ static int cond_ols_GNR (MODEL *pmod,
     int *glist = NULL;
     gretl_matrix *w, *G;
     int nc, zcol, vi;
-    int i, j, k, t, s, v;
+    int i, j, k, t, v;
     int err = 0;
 
     /* total number of coefficients in the GNR */
@@ -1545,14 +1718,14 @@ static int cond_ols_GNR (MODEL *pmod,
     /* MIDAS terms */
     for (i=0; i<mi->nmidas && !err; i++) {
 	midas_term *mt = &mi->mterms[i];
-	double zt, gij, hfb = 1.0;
+	const double *xj;
+	double *zi, gij, hfb = 1.0;
 	int ii, pos;
 
 	if (mt->type == MIDAS_U) {
 	    /* gradient wrt U-MIDAS coeffs */
 	    for (j=0; j<mt->nlags; j++) {
-		vi = mt->laglist[j+1];
-		memcpy(gdset->Z[zcol], dset->Z[vi] + dset->t1,
+		memcpy(gdset->Z[zcol], mview_column(mt, dset, j),
 		       mi->colsize);
 		glist[0] += 1;
 		glist[glist[0]] = zcol;
@@ -1563,25 +1736,24 @@ static int cond_ols_GNR (MODEL *pmod,
 	    continue;
 	}
 
-	/* gradient wrt weighted linear combination */
-	w = midas_weights(mt->nlags, mt->theta, mt->type, &err);
-	if (!err) {
-	    s = 0;
-	    for (t=dset->t1; t<=dset->t2; t++) {
-		zt = 0.0;
+	if (takes_coeff(mt->type)) {
+	    /* gradient wrt weighted linear combination */
+	    w = midas_weights(mt->nlags, mt->theta, mt->type, &err);
+	    if (!err) {
+		memset(gdset->Z[zcol], 0, mi->colsize);
 		for (j=0; j<mt->nlags; j++) {
-		    vi = mt->laglist[j+1];
-		    zt += dset->Z[vi][t] * w->val[j];
+		    xj = mview_column(mt, dset, j);
+		    for (t=0; t<mi->nobs; t++) {
+			gdset->Z[zcol][t] += xj[t] * w->val[j];
+		    }
 		}
-		gdset->Z[zcol][s] = zt;
-		s++;
+		gretl_matrix_free(w);
 	    }
-	    gretl_matrix_free(w);
+	    glist[0] += 1;
+	    glist[glist[0]] = zcol;
+	    sprintf(gdset->varname[zcol], "mdx%d", i+1);
+	    zcol++;
 	}
-	glist[0] += 1;
-	glist[glist[0]] = zcol;
-	sprintf(gdset->varname[zcol], "mdx%d", i+1);
-	zcol++;
 
 	/* gradient wrt hyper-parameters */
 	pos = zcol;
@@ -1590,18 +1762,16 @@ static int cond_ols_GNR (MODEL *pmod,
 	}
 	G = midas_gradient(mt->nlags, mt->theta, mt->type, &err);
 	if (!err) {
-	    s = 0;
-	    for (t=dset->t1; t<=dset->t2; t++) {
-		for (ii=0; ii<mt->nparm; ii++) {
-		    zt = 0.0;
-		    for (j=0; j<mt->nlags; j++) {
-			vi = mt->laglist[j+1];
-			gij = gretl_matrix_get(G, j, ii);
-			zt += dset->Z[vi][t] * gij;
+	    for (ii=0; ii<mt->nparm; ii++) {
+		zi = gdset->Z[pos+ii];
+		memset(zi, 0, mi->colsize);
+		for (j=0; j<mt->nlags; j++) {
+		    xj = mview_column(mt, dset, j);
+		    gij = gretl_matrix_get(G, j, ii) * hfb;
+		    for (t=0; t<mi->nobs; t++) {
+			zi[t] += xj[t] * gij;
 		    }
-		    gdset->Z[pos+ii][s] = zt * hfb;
 		}
-		s++;
 	    }
 	    gretl_matrix_free(G);
 	}
@@ -2434,6 +2604,8 @@ MODEL midas_model (const int *list,
 		user_var_delete_by_name(mt->lname, NULL);
 	    }
 	}
+	free(mt->lagv);
+	free(mt->lagsh);
 	if (mi->method == MDS_NLS && mt->type != MIDAS_U) {
 	    char tmp[24];
 	    
@@ -23,6 +23,7 @@
 #include "gretl_xml.h"
 #include "matrix_extra.h"
 #include "libset.h"
+#include "qr_estimate.h"
 
 /**
  * SECTION:gretl_model
@@ -614,6 +615,56 @@ int gretl_model_get_cluster_var (const MODEL *pmod)
     }
 }
 
+/**
+ * gretl_model_set_cluster_info:
+ * @pmod: pointer to model.
+ * @clist: list of clustering series.
+ * @nc: array holding the number of clusters for each
+ * member of @clist.
+ *
+ * Records on @pmod the fact that its variance-covariance matrix
+ * is clustered by the series in @clist. In the multi-way case
+ * the value recorded as "n_clusters" is the smallest of the
+ * per-dimension counts, and the full lists of clustering series
+ * and counts are attached as "cluster_vars" and "cluster_sizes".
+ *
+ * Returns: 0 on success, non-zero code on failure.
+ */
+
+int gretl_model_set_cluster_info (MODEL *pmod, const int *clist,
+				  const int *nc)
+{
+    int n_c = nc[0];
+    int i, err;
+
+    err = gretl_model_set_vcv_info(pmod, VCV_CLUSTER, clist[1]);
+
+    if (!err && clist[0] > 1) {
+	int *vlist = gretl_list_copy(clist);
+	int *nlist = gretl_list_new(clist[0]);
+
+	if (vlist == NULL || nlist == NULL) {
+	    free(vlist);
+	    free(nlist);
+	    return E_ALLOC;
+	}
+	for (i=1; i<=clist[0]; i++) {
+	    nlist[i] = nc[i-1];
+	    if (nc[i-1] < n_c) {
+		n_c = nc[i-1];
+	    }
+	}
+	gretl_model_set_list_as_data(pmod, "cluster_vars", vlist);
+	gretl_model_set_list_as_data(pmod, "cluster_sizes", nlist);
+    }
+
+    if (!err) {
+	err = gretl_model_set_int(pmod, "n_clusters", n_c);
+    }
+
+    return err;
+}
+
 /**
  * gretl_model_get_data_full:
  * @pmod: pointer to model.
@@ -2121,120 +2172,23 @@ int gretl_model_write_vcv (MODEL *pmod, const gretl_matrix *V)
     return err;
 }
 
-static gretl_matrix *make_cluster_vals (MODEL *pmod, int cvar, 
-					const DATASET *dset,
-					int *err)
-{
-    gretl_matrix *cvals = NULL;
-    double ct, *cdata;
-    int s, t;
-
-    cdata = malloc(pmod->nobs * sizeof *cdata);
-
-    if (cdata == NULL) {
-	*err = E_ALLOC;
-    } else {
-	s = 0;
-	for (t=pmod->t1; t<=pmod->t2 && !*err; t++) {
-	    if (!model_missing(pmod, t)) {
-		ct = dset->Z[cvar][t];
-		if (na(ct)) {
-		    *err = E_MISSDATA;
-		} else {
-		    cdata[s++] = ct;
-		}
-	    }
-	}
-    }
-
-    if (!*err) {
-	cvals = gretl_matrix_values(cdata, pmod->nobs, OPT_S, err);
-	if (!*err && gretl_vector_get_length(cvals) < 2) {
-	    gretl_matrix_free(cvals);
-	    cvals = NULL;
-	    *err = E_DATA;
-	}
-    }
-
-    free(cdata);
-
-    return cvals;
-}
-
 static int model_make_clustered_GG (MODEL *pmod, int ci,
 				    const gretl_matrix *G,
-				    gretl_matrix *GG,
+				    gretl_matrix **pGG,
 				    const DATASET *dset,
-				    int *pcvar,
-				    int *pnc)
-{
-    gretl_matrix *cvals = NULL;
-    gretl_matrix *Gi = NULL;
-    const double *cZ = NULL;
-    const char *cname;
-    int cvar, n_c = 0;
-    int k = G->cols;
-    int i, j, t;
+				    int **pclist,
+				    int *nc)
+{
     int err = 0;
 
-    cname = get_optval_string(ci, OPT_C); 
-    if (cname == NULL) {
-	return E_PARSE;
-    }
-
-    cvar = current_series_index(dset, cname);
-
-    if (cvar < 1 || cvar >= dset->v) {
-	err = E_UNKVAR;
-    } else {
-	cvals = make_cluster_vals(pmod, cvar, dset, &err);
-    }
-
-    if (!err) {
-	Gi = gretl_matrix_alloc(1, k);
-	if (Gi == NULL) {
-	    gretl_matrix_free(cvals);
-	    err = E_ALLOC;
-	}
-    }
-
-    if (err) {
-	return err;
-    }
-
-    n_c = gretl_vector_get_length(cvals);
-    cZ = dset->Z[cvar];
-
-    for (i=0; i<n_c; i++) {
-	double cvi = cvals->val[i];
-	int s = 0;
-
-	gretl_matrix_zero(Gi);
-
-	for (t=pmod->t1; t<=pmod->t2; t++) {
-	    if (!model_missing(pmod, t)) {
-		if (cZ[t] == cvi) {
-		    for (j=0; j<k; j++) {
-			Gi->val[j] += gretl_matrix_get(G, s, j);
-		    }
-		}
-		s++;
-	    }
-	}
-
-	gretl_matrix_multiply_mod(Gi, GRETL_MOD_TRANSPOSE,
-				  Gi, GRETL_MOD_NONE,
-				  GG, GRETL_MOD_CUMULATE);
-    }
+    *pclist = cluster_list_from_option(ci, dset, &err);
 
     if (!err) {
-	*pcvar = cvar;
-	*pnc = n_c;
+	/* note: the Stata-style df adjustment, M/(M-1) for
+	   M clusters, is handled by cluster_meat() */
+	*pGG = cluster_meat(G, pmod, *pclist, dset, 1, nc, &err);
     }
 
-    gretl_matrix_free(cvals);
-    gretl_matrix_free(Gi);
-
     return err;
 }
 
@@ -2265,7 +2219,8 @@ int gretl_model_add_QML_vcv (MODEL *pmod, int ci,
 {
     gretl_matrix *GG = NULL;
     gretl_matrix *V = NULL;
-    int cvar = 0, n_c = 0;
+    int *clist = NULL;
+    int nc[CLUSTER_MAXDIM];
     int k = H->rows;
     int err = 0;
 
@@ -2278,13 +2233,8 @@ int gretl_model_add_QML_vcv (MODEL *pmod, int ci,
     if (!err) {
 	if (opt & OPT_C) {
 	    /* clustered */
-	    GG = gretl_zero_matrix_new(k, k);
-	    if (GG == NULL) {
-		err = E_ALLOC;
-	    } else {
-		err = model_make_clustered_GG(pmod, ci, G, GG,
-					      dset, &cvar, &n_c);
-	    }
+	    err = model_make_clustered_GG(pmod, ci, G, &GG,
+					  dset, &clist, nc);
 	} else {
 	    /* regular QML using OPG */
 	    GG = gretl_matrix_XTX_new(G);
@@ -2297,12 +2247,6 @@ int gretl_model_add_QML_vcv (MODEL *pmod, int ci,
     if (!err) {
 	err = gretl_matrix_qform(H, GRETL_MOD_NONE, GG,
 				 V, GRETL_MOD_NONE);
-	if (!err && (opt & OPT_C)) {
-	    /* clustering: use stata-style df adjustment */
-	    double dfc = n_c / (n_c - 1.0);
-
-	    gretl_matrix_multiply_by_scalar(V, dfc);
-	}
     }
 
     if (!err) {
@@ -2311,8 +2255,7 @@ int gretl_model_add_QML_vcv (MODEL *pmod, int ci,
 
     if (!err) {
 	if (opt & OPT_C) {
-	    gretl_model_set_int(pmod, "n_clusters", n_c);
-	    gretl_model_set_vcv_info(pmod, VCV_CLUSTER, cvar);
+	    err = gretl_model_set_cluster_info(pmod, clist, nc);
 	    pmod->opt |= OPT_C;
 	} else {
 	    gretl_model_set_vcv_info(pmod, VCV_ML, ML_QML);
@@ -2322,6 +2265,7 @@ int gretl_model_add_QML_vcv (MODEL *pmod, int ci,
 
     gretl_matrix_free(GG);
     gretl_matrix_free(V);
+    free(clist);
 
     return err;
 }
@@ -293,6 +293,9 @@ int gretl_model_get_vcv_type (const MODEL *pmod);
 
 int gretl_model_get_hc_version (const MODEL *pmod);
 
+int gretl_model_set_cluster_info (MODEL *pmod, const int *clist,
+				  const int *nc);
+
 int gretl_model_get_cluster_var (const MODEL *pmod);
 
 void *gretl_model_get_data (const MODEL *pmod, const char *key);
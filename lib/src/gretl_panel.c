@@ -65,6 +65,8 @@ struct panelmod_t_ {
     int NT;               /* total observations used (based on pooled model) */
     int ntdum;            /* number of time dummies added */
     int *unit_obs;        /* array of number of observations per x-sect unit */
+    int *unit_off;        /* offsets into @obslist, per unit (nunits + 1) */
+    int *obslist;         /* indices of included observations, by unit */
     char *varying;        /* array to record properties of pooled-model regressors */
     int *vlist;           /* list of time-varying variables from pooled model */
     int balanced;         /* 1 if the model dataset is balanced, else 0 */
@@ -158,6 +160,8 @@ static void panelmod_init (panelmod_t *pan)
     pan->NT = 0;
     pan->ntdum = 0;
     pan->unit_obs = NULL;
+    pan->unit_off = NULL;
+    pan->obslist = NULL;
     pan->varying = NULL;
     pan->vlist = NULL;
     pan->opt = OPT_NONE;
@@ -218,6 +222,7 @@ static int panelmod_add_tsinfo (panelmod_t *pan)
 static void panelmod_free (panelmod_t *pan)
 {
     free(pan->unit_obs);
+    free(pan->unit_off);
     free(pan->varying);
     free(pan->vlist);
 
@@ -1077,7 +1082,7 @@ static DATASET *within_groups_dataset (const DATASET *dset,
     DATASET *wset = NULL;
     int *vlist = NULL;
     int i, j, vj, nv;
-    int s, t, bigt;
+    int s, bigt;
     int err = 0;
 
     pan->balanced = 1;
@@ -1128,7 +1133,7 @@ static DATASET *within_groups_dataset (const DATASET *dset,
 
 	for (i=0; i<pan->nunits; i++) {
 	    int Ti = pan->unit_obs[i];
-	    int got = 0;
+	    int k;
 
 	    if (Ti == 0) {
 		continue;
@@ -1136,29 +1141,22 @@ static DATASET *within_groups_dataset (const DATASET *dset,
 
 	    /* first pass: find the group mean */
 	    xbar = 0.0;
-	    for (t=0; t<pan->T; t++) {
-		bigt = panel_index(i, t);
-		if (!panel_missing(pan, bigt)) {
-		    xbar += dset->Z[vj][bigt];
-		}
+	    for (k=pan->unit_off[i]; k<pan->unit_off[i+1]; k++) {
+		xbar += dset->Z[vj][pan->obslist[k]];
 	    }
 
 	    gxbar += xbar;
 	    xbar /= Ti;
 	    
 	    /* second pass: calculate de-meaned values */
-	    got = 0;
-	    for (t=0; t<pan->T && got<Ti; t++) { 
-		bigt = panel_index(i, t);
-		if (!panel_missing(pan, bigt)) {
-		    wset->Z[j][s] = dset->Z[vj][bigt] - xbar;
-		    got++;
-		    if (pan->small2big != NULL) {
-			pan->small2big[s] = bigt;
-			pan->big2small[bigt] = s;
-		    }
-		    s++;
+	    for (k=pan->unit_off[i]; k<pan->unit_off[i+1]; k++) {
+		bigt = pan->obslist[k];
+		wset->Z[j][s] = dset->Z[vj][bigt] - xbar;
+		if (pan->small2big != NULL) {
+		    pan->small2big[s] = bigt;
+		    pan->big2small[bigt] = s;
 		}
+		s++;
 	    }
 	}
 
@@ -1194,7 +1192,7 @@ random_effects_dataset (const DATASET *dset,
     int hreg = (hlist != NULL);
     int v1 = relist[0];
     int v2 = 0;
-    int i, j, k, k2, t;
+    int i, j, k, k2, m;
     int vj, s, bigt, u;
     int err = 0;
 
@@ -1265,7 +1263,6 @@ random_effects_dataset (const DATASET *dset,
 
     for (i=0; i<pan->nunits; i++) {
 	int Ti = pan->unit_obs[i];
-	int got = 0;
 
 	if (Ti == 0) {
 	    continue;
@@ -1279,32 +1276,29 @@ random_effects_dataset (const DATASET *dset,
 
 	pan->theta_bar += theta_i;
 
-	for (t=0; t<pan->T && got<Ti; t++) {
-	    bigt = panel_index(i, t);
+	for (m=pan->unit_off[i]; m<pan->unit_off[i+1]; m++) {
+	    bigt = pan->obslist[m];
 	    k = 0;
 	    k2 = v1 - 1;
-	    if (!panel_missing(pan, bigt)) {
-		for (j=0; j<v1; j++) {
-		    vj = pan->pooled->list[j+1];
-		    if (vj == 0) {
-			rset->Z[0][s] -= theta_i;
-		    } else {
-			k++;
-			xbar = (k < gset->v)? gset->Z[k][u] : 1.0 / pan->Tmax;
-			rset->Z[k][s] = dset->Z[vj][bigt] - theta_i * xbar;
-			if (hreg && k2 < rset->v - 1 && var_is_varying(pan, vj)) {
-			    /* hausman-related term */
-			    rset->Z[++k2][s] = dset->Z[vj][bigt] - xbar;
-			}
+	    for (j=0; j<v1; j++) {
+		vj = pan->pooled->list[j+1];
+		if (vj == 0) {
+		    rset->Z[0][s] -= theta_i;
+		} else {
+		    k++;
+		    xbar = (k < gset->v)? gset->Z[k][u] : 1.0 / pan->Tmax;
+		    rset->Z[k][s] = dset->Z[vj][bigt] - theta_i * xbar;
+		    if (hreg && k2 < rset->v - 1 && var_is_varying(pan, vj)) {
+			/* hausman-related term */
+			rset->Z[++k2][s] = dset->Z[vj][bigt] - xbar;
 		    }
 		}
-		got++;
-		if (pan->small2big != NULL) {
-		    pan->small2big[s] = bigt;
-		    pan->big2small[bigt] = s;
-		}
-		s++;
 	    }
+	    if (pan->small2big != NULL) {
+		pan->small2big[s] = bigt;
+		pan->big2small[bigt] = s;
+	    }
+	    s++;
 	}
 	u++;
     }
@@ -1326,7 +1320,7 @@ static DATASET *group_means_dataset (panelmod_t *pan,
     int gn = pan->effn;
     int gv = pan->pooled->list[0];
     int i, j, k;
-    int s, t, bigt;
+    int s, t;
 
     if (pan->balanced && pan->ntdum > 0) {
 	gv -= pan->ntdum;
@@ -1368,11 +1362,8 @@ static DATASET *group_means_dataset (panelmod_t *pan,
 	    }
 
 	    x = 0.0;
-	    for (t=0; t<pan->T; t++) {
-		bigt = panel_index(i, t);
-		if (!panel_missing(pan, bigt)) {
-		    x += dset->Z[vj][bigt];
-		}
+	    for (t=pan->unit_off[i]; t<pan->unit_off[i+1]; t++) {
+		x += dset->Z[vj][pan->obslist[t]];
 	    }
 	    gset->Z[k][s++] = x / Ti;
 	}
@@ -2959,17 +2950,31 @@ static int finalize_hausman_test (panelmod_t *pan, PRN *prn)
    (a) how many cross-sectional units were actually included (after
    omitting any missing values); (b) how many time-series observations
    were included for each unit; and (c) what was the maximum number
-   of time-series observations used.  Return 0 if all goes OK,
-   non-zero otherwise.
+   of time-series observations used.
+
+   In the same pass we build a compact ("ragged") index of the
+   included observations: the indices into the full dataset of the
+   observations for unit i are found in obslist[k] for k running
+   from unit_off[i] to unit_off[i+1] - 1. The data transformations
+   for the fixed and random effects estimators then visit just these
+   observations rather than scanning all T rows of each unit: with a
+   highly unbalanced panel most rows are padding. Note that @obslist
+   shares a single allocation with @unit_off, sized for the balanced
+   case and trimmed once the count of included observations is known.
+
+   Return 0 if all goes OK, non-zero otherwise.
 */
 
 static int panel_obs_accounts (panelmod_t *pan)
 {
-    int *uobs;
-    int i, t, bigt;
+    int *uobs, *off;
+    int i, t, k, bigt;
 
     uobs = malloc(pan->nunits * sizeof *uobs);
-    if (uobs == NULL) {
+    off = malloc((pan->nunits + 1 + pan->nunits * pan->T) * sizeof *off);
+    if (uobs == NULL || off == NULL) {
+	free(uobs);
+	free(off);
 	return E_ALLOC;
     }
 
@@ -2978,8 +2983,10 @@ static int panel_obs_accounts (panelmod_t *pan)
     pan->Tmax = 0;
     pan->Tmin = pan->T;
 
+    k = pan->nunits + 1;
+
     for (i=0; i<pan->nunits; i++) {
-	uobs[i] = 0;
+	off[i] = k - pan->nunits - 1;
 	for (t=0; t<pan->T; t++) {
 	    bigt = panel_index(i, t);
 #if PDEBUG > 1
@@ -2987,9 +2994,10 @@ static int panel_obs_accounts (panelmod_t *pan)
 		    bigt, (panel_missing(pan, bigt))? "NA" : "OK");
 #endif
 	    if (!panel_missing(pan, bigt)) {
-		uobs[i] += 1;
+		off[k++] = bigt;
 	    }
 	}
+	uobs[i] = k - pan->nunits - 1 - off[i];
 	if (uobs[i] > 0) {
 	    pan->effn += 1;
 	    if (uobs[i] > pan->Tmax) {
@@ -3002,6 +3010,16 @@ static int panel_obs_accounts (panelmod_t *pan)
 	}
     }
 
+    off[pan->nunits] = pan->NT;
+
+    if (pan->NT < pan->nunits * pan->T) {
+	int *tmp = realloc(off, (pan->nunits + 1 + pan->NT) * sizeof *off);
+
+	if (tmp != NULL) {
+	    off = tmp;
+	}
+    }
+
     for (i=0; i<pan->nunits; i++) {
 	if (uobs[i] > 0 && uobs[i] != pan->Tmax) {
 	    pan->balanced = 0;
@@ -3010,6 +3028,8 @@ static int panel_obs_accounts (panelmod_t *pan)
     }
 
     pan->unit_obs = uobs;
+    pan->unit_off = off;
+    pan->obslist = off + pan->nunits + 1;
 
     return 0;
 }
@@ -3085,6 +3105,8 @@ panelmod_setup (panelmod_t *pan, MODEL *pmod, const DATASET *dset,
     if (err && pan->unit_obs != NULL) {
 	free(pan->unit_obs);
 	pan->unit_obs = NULL;
+	free(pan->unit_off);
+	pan->unit_off = NULL;
     }
 
     return err;
@@ -3881,6 +3903,7 @@ MODEL panel_wls_by_unit (const int *list, DATASET *dset,
     uvar = malloc(pan.nunits * sizeof *uvar);
     if (uvar == NULL) {
 	free(pan.unit_obs);
+	free(pan.unit_off);
 	mdl.errcode = E_ALLOC;
 	return mdl;
     }  
@@ -4005,6 +4028,7 @@ MODEL panel_wls_by_unit (const int *list, DATASET *dset,
  bailout:
 
     free(pan.unit_obs);
+    free(pan.unit_off);
     free(uvar);
     free(wlist);
     free(bvec);
@@ -4070,6 +4094,7 @@ int groupwise_hetero_test (MODEL *pmod, DATASET *dset,
     uvar = malloc(pan.nunits * sizeof *uvar);
     if (uvar == NULL) {
 	free(pan.unit_obs);
+	free(pan.unit_off);
 	return E_ALLOC;
     }  
 
@@ -4106,6 +4131,7 @@ int groupwise_hetero_test (MODEL *pmod, DATASET *dset,
     }
 
     free(pan.unit_obs);
+    free(pan.unit_off);
     free(uvar);
 
     return err;
@@ -0,0 +1,890 @@
+/*
+ *  gretl -- Gnu Regression, Econometrics and Time-series Library
+ *  Copyright (C) 2016 Allin Cottrell and Riccardo "Jack" Lucchetti
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libgretl.h"
+#include "matrix_extra.h"
+#include "gretl_sparse.h"
+
+/**
+ * SECTION:gretl_sparse
+ * @short_description: sparse matrices
+ * @title: Sparse matrices
+ * @include: gretl/libgretl.h, gretl/gretl_sparse.h
+ *
+ * Storage in compressed sparse column format, for matrices
+ * that are mostly zeros -- such as sets of dummy variables
+ * or block-diagonal instrument matrices -- along with the
+ * operations needed to use them in estimation: cross-products,
+ * products with dense matrices, and an iterative solver for
+ * symmetric positive definite systems.
+ */
+
+#define SPDEBUG 0
+
+/**
+ * gretl_sparse_new:
+ * @rows: number of rows.
+ * @cols: number of columns.
+ * @nnz: number of elements for which to allocate space.
+ *
+ * Returns: a newly allocated sparse matrix, with all column
+ * offsets set to zero, or NULL on failure.
+ */
+
+gretl_sparse *gretl_sparse_new (int rows, int cols, int nnz)
+{
+    gretl_sparse *S;
+    int n = nnz > 0 ? nnz : 1;
+
+    if (rows < 0 || cols < 0 || nnz < 0) {
+	return NULL;
+    }
+
+    S = malloc(sizeof *S);
+    if (S == NULL) {
+	return NULL;
+    }
+
+    S->rows = rows;
+    S->cols = cols;
+    S->nnz = nnz;
+    S->colptr = calloc(cols + 1, sizeof *S->colptr);
+    S->rowidx = malloc(n * sizeof *S->rowidx);
+    S->val = malloc(n * sizeof *S->val);
+
+    if (S->colptr == NULL || S->rowidx == NULL || S->val == NULL) {
+	gretl_sparse_free(S);
+	S = NULL;
+    }
+
+    return S;
+}
+
+/**
+ * gretl_sparse_free:
+ * @S: sparse matrix to be freed.
+ *
+ * Frees the allocated storage in @S, then @S itself.
+ */
+
+void gretl_sparse_free (gretl_sparse *S)
+{
+    if (S != NULL) {
+	free(S->colptr);
+	free(S->rowidx);
+	free(S->val);
+	free(S);
+    }
+}
+
+/**
+ * gretl_sparse_from_matrix:
+ * @m: dense matrix.
+ * @err: location to receive error code.
+ *
+ * Returns: a sparse representation of @m, holding its
+ * non-zero elements, or NULL on failure.
+ */
+
+gretl_sparse *gretl_sparse_from_matrix (const gretl_matrix *m,
+					int *err)
+{
+    gretl_sparse *S;
+    int i, j, k, nnz = 0;
+    double x;
+
+    if (gretl_is_null_matrix(m)) {
+	*err = E_DATA;
+	return NULL;
+    }
+
+    k = m->rows * m->cols;
+    for (i=0; i<k; i++) {
+	if (m->val[i] != 0.0) {
+	    nnz++;
+	}
+    }
+
+    S = gretl_sparse_new(m->rows, m->cols, nnz);
+    if (S == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    k = 0;
+    for (j=0; j<m->cols; j++) {
+	S->colptr[j] = k;
+	for (i=0; i<m->rows; i++) {
+	    x = gretl_matrix_get(m, i, j);
+	    if (x != 0.0) {
+		S->rowidx[k] = i;
+		S->val[k++] = x;
+	    }
+	}
+    }
+    S->colptr[m->cols] = k;
+
+    return S;
+}
+
+/**
+ * gretl_sparse_from_list:
+ * @list: list of series.
+ * @dset: dataset struct.
+ * @err: location to receive error code.
+ *
+ * Returns: a sparse matrix holding the non-zero values of the
+ * series in @list over the current sample range of @dset, or
+ * NULL on failure. Missing values are not accepted.
+ */
+
+gretl_sparse *gretl_sparse_from_list (const int *list,
+				      const DATASET *dset,
+				      int *err)
+{
+    gretl_sparse *S;
+    const double *x;
+    int T, nnz = 0;
+    int i, k, t;
+
+    if (list == NULL || list[0] == 0 || dset == NULL) {
+	*err = E_DATA;
+	return NULL;
+    }
+
+    T = dset->t2 - dset->t1 + 1;
+
+    for (i=1; i<=list[0]; i++) {
+	x = dset->Z[list[i]];
+	for (t=dset->t1; t<=dset->t2; t++) {
+	    if (na(x[t])) {
+		*err = E_MISSDATA;
+		return NULL;
+	    } else if (x[t] != 0.0) {
+		nnz++;
+	    }
+	}
+    }
+
+    S = gretl_sparse_new(T, list[0], nnz);
+    if (S == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    k = 0;
+    for (i=1; i<=list[0]; i++) {
+	x = dset->Z[list[i]];
+	S->colptr[i-1] = k;
+	for (t=dset->t1; t<=dset->t2; t++) {
+	    if (x[t] != 0.0) {
+		S->rowidx[k] = t - dset->t1;
+		S->val[k++] = x[t];
+	    }
+	}
+    }
+    S->colptr[list[0]] = k;
+
+    return S;
+}
+
+/**
+ * gretl_sparse_dummies:
+ * @x: discrete-valued series.
+ * @t1: starting observation.
+ * @t2: ending observation.
+ * @vals: location to receive the distinct values of @x, or NULL.
+ * @err: location to receive error code.
+ *
+ * Builds the set of dummy variables for the distinct values
+ * of @x over the range @t1 to @t2, as for fixed effects. Column
+ * j of the result indicates the observations at which @x takes
+ * its j-th smallest value; there is exactly one non-zero element
+ * per row. If @vals is not NULL it receives a column vector
+ * holding the distinct values. Missing values are not accepted.
+ *
+ * Returns: the sparse dummy matrix, or NULL on failure.
+ */
+
+gretl_sparse *gretl_sparse_dummies (const double *x, int t1, int t2,
+				    gretl_matrix **vals, int *err)
+{
+    gretl_sparse *S = NULL;
+    int *pos = NULL, *next = NULL;
+    double *sx, *px;
+    int T = t2 - t1 + 1;
+    int i, j, t, nv;
+
+    if (x == NULL || T <= 0) {
+	*err = E_DATA;
+	return NULL;
+    }
+
+    for (t=t1; t<=t2; t++) {
+	if (na(x[t])) {
+	    *err = E_MISSDATA;
+	    return NULL;
+	}
+    }
+
+    sx = copyvec(x + t1, T);
+    if (sx == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    /* get the sorted distinct values */
+    qsort(sx, T, sizeof *sx, gretl_compare_doubles);
+    nv = 1;
+    for (t=1; t<T; t++) {
+	if (sx[t] != sx[nv-1]) {
+	    sx[nv++] = sx[t];
+	}
+    }
+
+    S = gretl_sparse_new(T, nv, T);
+    pos = malloc(T * sizeof *pos);
+    next = malloc(nv * sizeof *next);
+    if (S == NULL || pos == NULL || next == NULL) {
+	*err = E_ALLOC;
+	gretl_sparse_free(S);
+	S = NULL;
+	goto bailout;
+    }
+
+    /* record the column for each observation, and count
+       the observations per column */
+    for (t=0; t<T; t++) {
+	px = bsearch(&x[t+t1], sx, nv, sizeof *sx, gretl_compare_doubles);
+	pos[t] = px - sx;
+	S->colptr[pos[t] + 1] += 1;
+    }
+    for (j=0; j<nv; j++) {
+	S->colptr[j+1] += S->colptr[j];
+	next[j] = S->colptr[j];
+    }
+
+    /* fill in, in row order */
+    for (t=0; t<T; t++) {
+	i = next[pos[t]]++;
+	S->rowidx[i] = t;
+	S->val[i] = 1.0;
+    }
+
+    if (vals != NULL) {
+	*vals = gretl_vector_from_array(sx, nv, GRETL_MOD_NONE);
+	if (*vals == NULL) {
+	    *err = E_ALLOC;
+	    gretl_sparse_free(S);
+	    S = NULL;
+	}
+    }
+
+ bailout:
+
+    free(sx);
+    free(pos);
+    free(next);
+
+    return S;
+}
+
+/**
+ * gretl_sparse_to_matrix:
+ * @S: sparse matrix.
+ * @err: location to receive error code.
+ *
+ * Returns: a dense matrix with the same content as @S, or
+ * NULL on failure.
+ */
+
+gretl_matrix *gretl_sparse_to_matrix (const gretl_sparse *S,
+				      int *err)
+{
+    gretl_matrix *m;
+    int j, p;
+
+    m = gretl_zero_matrix_new(S->rows, S->cols);
+    if (m == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    for (j=0; j<S->cols; j++) {
+	for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+	    gretl_matrix_set(m, S->rowidx[p], j, S->val[p]);
+	}
+    }
+
+    return m;
+}
+
+/**
+ * gretl_sparse_transpose:
+ * @S: sparse matrix.
+ * @err: location to receive error code.
+ *
+ * Returns: the transpose of @S, in compressed sparse column
+ * format (equivalently, @S in compressed sparse row format),
+ * or NULL on failure.
+ */
+
+gretl_sparse *gretl_sparse_transpose (const gretl_sparse *S,
+				      int *err)
+{
+    gretl_sparse *T;
+    int *next;
+    int i, j, p, q;
+
+    T = gretl_sparse_new(S->cols, S->rows, S->nnz);
+    next = malloc((S->rows + 1) * sizeof *next);
+
+    if (T == NULL || next == NULL) {
+	*err = E_ALLOC;
+	gretl_sparse_free(T);
+	free(next);
+	return NULL;
+    }
+
+    /* count the elements in each row of @S */
+    for (p=0; p<S->nnz; p++) {
+	T->colptr[S->rowidx[p] + 1] += 1;
+    }
+    for (i=0; i<S->rows; i++) {
+	T->colptr[i+1] += T->colptr[i];
+	next[i] = T->colptr[i];
+    }
+
+    /* traversing @S by column yields increasing row indices
+       in each column of @T */
+    for (j=0; j<S->cols; j++) {
+	for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+	    q = next[S->rowidx[p]]++;
+	    T->rowidx[q] = j;
+	    T->val[q] = S->val[p];
+	}
+    }
+
+    free(next);
+
+    return T;
+}
+
+static int compare_ints (const void *a, const void *b)
+{
+    const int *ia = a;
+    const int *ib = b;
+
+    return *ia - *ib;
+}
+
+static int sparse_grow (gretl_sparse *S, int n)
+{
+    int *ri = realloc(S->rowidx, n * sizeof *ri);
+    double *v;
+
+    if (ri == NULL) {
+	return E_ALLOC;
+    }
+    S->rowidx = ri;
+
+    v = realloc(S->val, n * sizeof *v);
+    if (v == NULL) {
+	return E_ALLOC;
+    }
+    S->val = v;
+
+    return 0;
+}
+
+/**
+ * gretl_sparse_XTX:
+ * @S: sparse matrix, n x k.
+ * @err: location to receive error code.
+ *
+ * Computes the k x k cross-product S'S, working only on the
+ * non-zero elements of @S (Gustavson's algorithm applied to
+ * the product of the transpose of @S and @S). Both triangles
+ * of the symmetric result are stored.
+ *
+ * Returns: the sparse cross-product matrix, or NULL on failure.
+ */
+
+gretl_sparse *gretl_sparse_XTX (const gretl_sparse *S, int *err)
+{
+    gretl_sparse *St = NULL;
+    gretl_sparse *C = NULL;
+    double *acc = NULL;
+    int *mark = NULL;
+    int k = S->cols;
+    int i, j, p, q, r;
+    int cap, nz = 0;
+
+    St = gretl_sparse_transpose(S, err);
+    if (St == NULL) {
+	return NULL;
+    }
+
+    /* initial guess at the number of non-zeros */
+    cap = S->nnz > k ? S->nnz : k;
+    C = gretl_sparse_new(k, k, cap);
+    acc = calloc(k, sizeof *acc);
+    mark = malloc(k * sizeof *mark);
+
+    if (C == NULL || acc == NULL || mark == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    for (i=0; i<k; i++) {
+	mark[i] = -1;
+    }
+
+    for (j=0; j<k && !*err; j++) {
+	int start = nz;
+
+	C->colptr[j] = nz;
+	/* column j of C is the sum over the non-zeros s_rj of
+	   column j of S of s_rj times column r of St */
+	for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+	    r = S->rowidx[p];
+	    for (q=St->colptr[r]; q<St->colptr[r+1]; q++) {
+		i = St->rowidx[q];
+		if (mark[i] != j) {
+		    mark[i] = j;
+		    if (nz == cap) {
+			cap *= 2;
+			*err = sparse_grow(C, cap);
+			if (*err) {
+			    goto bailout;
+			}
+		    }
+		    C->rowidx[nz++] = i;
+		    acc[i] = 0.0;
+		}
+		acc[i] += St->val[q] * S->val[p];
+	    }
+	}
+	qsort(C->rowidx + start, nz - start, sizeof(int), compare_ints);
+	for (p=start; p<nz; p++) {
+	    C->val[p] = acc[C->rowidx[p]];
+	}
+    }
+
+    C->colptr[k] = C->nnz = nz;
+
+ bailout:
+
+    if (*err) {
+	gretl_sparse_free(C);
+	C = NULL;
+    }
+
+    gretl_sparse_free(St);
+    free(acc);
+    free(mark);
+
+    return C;
+}
+
+/**
+ * gretl_sparse_multiply_dense:
+ * @S: sparse matrix.
+ * @smod: %GRETL_MOD_TRANSPOSE if @S should be transposed,
+ * otherwise %GRETL_MOD_NONE.
+ * @B: dense matrix.
+ * @C: dense matrix to hold the product.
+ *
+ * Computes either S*B or S'*B, as determined by @smod, and
+ * writes the result into @C, which must be correctly sized.
+ * The cost is proportional to the number of non-zero elements
+ * of @S times the number of columns of @B.
+ *
+ * Returns: 0 on success, non-zero code on error.
+ */
+
+int gretl_sparse_multiply_dense (const gretl_sparse *S,
+				 GretlMatrixMod smod,
+				 const gretl_matrix *B,
+				 gretl_matrix *C)
+{
+    int sr, sc;
+    int i, j, p;
+    double x;
+
+    if (S == NULL || gretl_is_null_matrix(B) || C == NULL) {
+	return E_DATA;
+    }
+
+    sr = (smod == GRETL_MOD_TRANSPOSE)? S->cols : S->rows;
+    sc = (smod == GRETL_MOD_TRANSPOSE)? S->rows : S->cols;
+
+    if (sc != B->rows || C->rows != sr || C->cols != B->cols) {
+	return E_NONCONF;
+    }
+
+    if (smod == GRETL_MOD_TRANSPOSE) {
+	/* C[j,c] = sum_i S[i,j] * B[i,c] */
+	for (i=0; i<B->cols; i++) {
+	    const double *b = B->val + i * B->rows;
+	    double *c = C->val + i * C->rows;
+
+	    for (j=0; j<S->cols; j++) {
+		x = 0.0;
+		for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+		    x += S->val[p] * b[S->rowidx[p]];
+		}
+		c[j] = x;
+	    }
+	}
+    } else {
+	/* C[,c] = sum_j S[,j] * B[j,c] */
+	gretl_matrix_zero(C);
+	for (i=0; i<B->cols; i++) {
+	    const double *b = B->val + i * B->rows;
+	    double *c = C->val + i * C->rows;
+
+	    for (j=0; j<S->cols; j++) {
+		x = b[j];
+		if (x != 0.0) {
+		    for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+			c[S->rowidx[p]] += S->val[p] * x;
+		    }
+		}
+	    }
+	}
+    }
+
+    return 0;
+}
+
+/**
+ * gretl_sparse_diagonal:
+ * @S: square sparse matrix.
+ * @err: location to receive error code.
+ *
+ * Returns: a column vector holding the diagonal of @S, or
+ * NULL on failure.
+ */
+
+gretl_matrix *gretl_sparse_diagonal (const gretl_sparse *S,
+				     int *err)
+{
+    gretl_matrix *d;
+    int j, p;
+
+    if (S->rows != S->cols) {
+	*err = E_NONCONF;
+	return NULL;
+    }
+
+    d = gretl_zero_matrix_new(S->rows, 1);
+    if (d == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    for (j=0; j<S->cols; j++) {
+	for (p=S->colptr[j]; p<S->colptr[j+1]; p++) {
+	    if (S->rowidx[p] == j) {
+		d->val[j] = S->val[p];
+		break;
+	    }
+	}
+    }
+
+    return d;
+}
+
+/**
+ * gretl_sparse_cut_rows:
+ * @S: sparse matrix.
+ * @mask: character array of length equal to the rows of @S,
+ * with non-zero elements marking rows to be dropped.
+ *
+ * Removes from @S the rows flagged in @mask, in place,
+ * renumbering the remaining rows.
+ *
+ * Returns: 0 on success, non-zero code on error.
+ */
+
+int gretl_sparse_cut_rows (gretl_sparse *S, const char *mask)
+{
+    int *newrow;
+    int i, j, p, nr, k = 0;
+
+    if (S == NULL || mask == NULL) {
+	return E_DATA;
+    }
+
+    newrow = malloc(S->rows * sizeof *newrow);
+    if (newrow == NULL) {
+	return E_ALLOC;
+    }
+
+    for (i=0; i<S->rows; i++) {
+	newrow[i] = mask[i] ? -1 : k++;
+    }
+
+    nr = k;
+    k = 0;
+    for (j=0; j<S->cols; j++) {
+	p = S->colptr[j];
+	S->colptr[j] = k;
+	for ( ; p<S->colptr[j+1]; p++) {
+	    i = newrow[S->rowidx[p]];
+	    if (i >= 0) {
+		S->rowidx[k] = i;
+		S->val[k++] = S->val[p];
+	    }
+	}
+    }
+
+    S->colptr[S->cols] = S->nnz = k;
+    S->rows = nr;
+
+    free(newrow);
+
+    return 0;
+}
+
+/* y = A x, for square sparse A */
+
+static void sparse_mv (const gretl_sparse *A, const double *x,
+		       double *y)
+{
+    int i, j, p;
+
+    for (i=0; i<A->rows; i++) {
+	y[i] = 0.0;
+    }
+
+    for (j=0; j<A->cols; j++) {
+	if (x[j] != 0.0) {
+	    for (p=A->colptr[j]; p<A->colptr[j+1]; p++) {
+		y[A->rowidx[p]] += A->val[p] * x[j];
+	    }
+	}
+    }
+}
+
+static double sp_dot (const double *a, const double *b, int n)
+{
+    double x = 0.0;
+    int i;
+
+    for (i=0; i<n; i++) {
+	x += a[i] * b[i];
+    }
+
+    return x;
+}
+
+#define CG_DEFAULT_TOL 1.0e-10
+
+/**
+ * gretl_sparse_cg_solve:
+ * @A: symmetric positive definite sparse matrix, n x n, with
+ * both triangles stored (as produced by gretl_sparse_XTX()).
+ * @B: right-hand side, n x m.
+ * @X: n x m matrix to hold the solution.
+ * @tol: convergence tolerance on the relative residual norm,
+ * or 0 for the default of 1.0e-10.
+ * @maxit: maximum number of iterations per column of @B, or
+ * 0 for the default, 10 * n.
+ * @iters: location to receive the largest number of iterations
+ * taken, or NULL.
+ *
+ * Solves A X = B by the conjugate gradient method with Jacobi
+ * (diagonal) preconditioning. Each iteration requires one
+ * product of @A with a vector, so the cost is proportional to
+ * the number of non-zero elements of @A per iteration, and no
+ * fill-in is generated.
+ *
+ * Returns: 0 on success; %E_NOTPD if @A is found not to be
+ * positive definite; %E_NOCONV if the iterations fail to
+ * converge.
+ */
+
+int gretl_sparse_cg_solve (const gretl_sparse *A,
+			   const gretl_matrix *B,
+			   gretl_matrix *X,
+			   double tol, int maxit,
+			   int *iters)
+{
+    gretl_matrix *d = NULL;
+    double *r, *z, *pv, *q;
+    double *work = NULL;
+    int n = A->rows;
+    int i, k, c, itmax = 0;
+    int err = 0;
+
+    if (A->cols != n || gretl_is_null_matrix(B) || B->rows != n ||
+	X == NULL || X->rows != n || X->cols != B->cols) {
+	return E_NONCONF;
+    }
+
+    if (tol <= 0) {
+	tol = CG_DEFAULT_TOL;
+    }
+    if (maxit <= 0) {
+	maxit = 10 * n;
+    }
+
+    d = gretl_sparse_diagonal(A, &err);
+    if (err) {
+	return err;
+    }
+
+    for (i=0; i<n; i++) {
+	if (d->val[i] <= 0.0) {
+	    gretl_matrix_free(d);
+	    return E_NOTPD;
+	}
+    }
+
+    work = malloc(4 * n * sizeof *work);
+    if (work == NULL) {
+	gretl_matrix_free(d);
+	return E_ALLOC;
+    }
+
+    r = work;
+    z = r + n;
+    pv = z + n;
+    q = pv + n;
+
+    for (c=0; c<B->cols && !err; c++) {
+	const double *b = B->val + c * n;
+	double *x = X->val + c * n;
+	double bnorm, rz, rz1, alpha, beta, pq;
+
+	bnorm = sqrt(sp_dot(b, b, n));
+	for (i=0; i<n; i++) {
+	    x[i] = 0.0;
+	    r[i] = b[i];
+	    z[i] = pv[i] = r[i] / d->val[i];
+	}
+	if (bnorm == 0.0) {
+	    continue;
+	}
+	rz = sp_dot(r, z, n);
+
+	for (k=1; k<=maxit; k++) {
+	    sparse_mv(A, pv, q);
+	    pq = sp_dot(pv, q, n);
+	    if (pq <= 0.0) {
+		err = E_NOTPD;
+		break;
+	    }
+	    alpha = rz / pq;
+	    for (i=0; i<n; i++) {
+		x[i] += alpha * pv[i];
+		r[i] -= alpha * q[i];
+	    }
+	    if (sqrt(sp_dot(r, r, n)) <= tol * bnorm) {
+		break;
+	    }
+	    for (i=0; i<n; i++) {
+		z[i] = r[i] / d->val[i];
+	    }
+	    rz1 = sp_dot(r, z, n);
+	    beta = rz1 / rz;
+	    rz = rz1;
+	    for (i=0; i<n; i++) {
+		pv[i] = z[i] + beta * pv[i];
+	    }
+	}
+
+#if SPDEBUG
+	fprintf(stderr, "sparse_cg_solve: column %d, %d iterations\n",
+		c, k);
+#endif
+
+	if (!err && k > maxit) {
+	    err = E_NOCONV;
+	}
+	if (k > itmax) {
+	    itmax = k;
+	}
+    }
+
+    if (iters != NULL) {
+	*iters = itmax;
+    }
+
+    gretl_matrix_free(d);
+    free(work);
+
+    return err;
+}
+
+/**
+ * gretl_sparse_matrix_cg_solve:
+ * @A: symmetric positive definite matrix, n x n.
+ * @B: right-hand side, n x m.
+ * @err: location to receive error code.
+ *
+ * Solves A X = B via gretl_sparse_cg_solve(), after converting
+ * @A to compressed sparse column form. This is the backend
+ * for the hansl function cgsolve(); it pays off when @A is
+ * large and mostly zero.
+ *
+ * Returns: the n x m solution matrix, or NULL on failure.
+ */
+
+gretl_matrix *gretl_sparse_matrix_cg_solve (const gretl_matrix *A,
+					    const gretl_matrix *B,
+					    int *err)
+{
+    gretl_sparse *S = NULL;
+    gretl_matrix *X = NULL;
+
+    if (gretl_is_null_matrix(A) || gretl_is_null_matrix(B)) {
+	*err = E_DATA;
+	return NULL;
+    } else if (A->rows != A->cols || B->rows != A->rows) {
+	*err = E_NONCONF;
+	return NULL;
+    } else if (!gretl_matrix_is_symmetric(A)) {
+	gretl_errmsg_set(_("Matrix is not symmetric"));
+	*err = E_NONCONF;
+	return NULL;
+    }
+
+    S = gretl_sparse_from_matrix(A, err);
+
+    if (!*err) {
+	X = gretl_matrix_alloc(B->rows, B->cols);
+	if (X == NULL) {
+	    *err = E_ALLOC;
+	} else {
+	    *err = gretl_sparse_cg_solve(S, B, X, 0, 0, NULL);
+	}
+    }
+
+    gretl_sparse_free(S);
+
+    if (*err) {
+	gretl_matrix_free(X);
+	X = NULL;
+    }
+
+    return X;
+}
@@ -0,0 +1,88 @@
+/*
+ *  gretl -- Gnu Regression, Econometrics and Time-series Library
+ *  Copyright (C) 2016 Allin Cottrell and Riccardo "Jack" Lucchetti
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRETL_SPARSE_H
+#define GRETL_SPARSE_H
+
+/**
+ * gretl_sparse:
+ * @rows: number of rows in matrix.
+ * @cols: number of columns.
+ * @nnz: number of stored elements.
+ * @colptr: array of @cols + 1 offsets: the elements of column j
+ * occupy positions colptr[j] to colptr[j+1] - 1 of @rowidx and @val.
+ * @rowidx: 0-based row indices of the stored elements.
+ * @val: values of the stored elements.
+ *
+ * A sparse matrix in compressed sparse column format. Within
+ * each column the row indices are strictly increasing.
+ */
+
+typedef struct gretl_sparse_ {
+    int rows;
+    int cols;
+    int nnz;
+    int *colptr;
+    int *rowidx;
+    double *val;
+} gretl_sparse;
+
+gretl_sparse *gretl_sparse_new (int rows, int cols, int nnz);
+
+void gretl_sparse_free (gretl_sparse *S);
+
+gretl_sparse *gretl_sparse_from_matrix (const gretl_matrix *m,
+					int *err);
+
+gretl_sparse *gretl_sparse_from_list (const int *list,
+				      const DATASET *dset,
+				      int *err);
+
+gretl_sparse *gretl_sparse_dummies (const double *x, int t1, int t2,
+				    gretl_matrix **vals, int *err);
+
+gretl_matrix *gretl_sparse_to_matrix (const gretl_sparse *S,
+				      int *err);
+
+gretl_sparse *gretl_sparse_transpose (const gretl_sparse *S,
+				      int *err);
+
+gretl_sparse *gretl_sparse_XTX (const gretl_sparse *S, int *err);
+
+int gretl_sparse_multiply_dense (const gretl_sparse *S,
+				 GretlMatrixMod smod,
+				 const gretl_matrix *B,
+				 gretl_matrix *C);
+
+gretl_matrix *gretl_sparse_diagonal (const gretl_sparse *S,
+				     int *err);
+
+int gretl_sparse_cut_rows (gretl_sparse *S, const char *mask);
+
+int gretl_sparse_cg_solve (const gretl_sparse *A,
+			   const gretl_matrix *B,
+			   gretl_matrix *X,
+			   double tol, int maxit,
+			   int *iters);
+
+gretl_matrix *gretl_sparse_matrix_cg_solve (const gretl_matrix *A,
+					    const gretl_matrix *B,
+					    int *err);
+
+#endif /* GRETL_SPARSE_H */
@@ -2111,6 +2111,7 @@ void libgretl_init (void)
     gretl_rand_init();
     gretl_xml_init();
     gretl_stopwatch_init();
+    gretl_matrix_pool_init();
     mpf_set_default_prec(get_mp_bits());
 
     if (!gretl_in_tool_mode() && have_optimized_blas()) {
@@ -2156,6 +2157,7 @@ int libgretl_mpi_init (int self, int np, int dcmt)
 
     gretl_xml_init();
     gretl_stopwatch_init();
+    gretl_matrix_pool_init();
     mpf_set_default_prec(get_mp_bits());
 
     /* be relatively quiet by default */
@@ -2214,6 +2216,7 @@ void libgretl_cleanup (void)
     gretl_command_hash_cleanup();
     gretl_function_hash_cleanup();
     lapack_mem_free();
+    gretl_matrix_pool_cleanup();
     forecast_matrix_cleanup();
     stored_options_cleanup();
     option_printing_cleanup();
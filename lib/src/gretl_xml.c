@@ -28,6 +28,7 @@
 #include "dbread.h"
 #include "swap_bytes.h"
 #include "gretl_zip.h"
+#include "libset.h"
 
 #ifdef WIN32
 # include "gretl_win32.h"
@@ -1846,7 +1847,20 @@ static int open_gdt_write_stream (const char *fname, gretlopt opt,
 
 #define BIN_HDRLEN 24
 
-static int write_binary_header (FILE *fp)
+/* Binary data files come in two variants. In the original one
+   ("gretl-bin") every series is stored as an array of doubles.  In
+   the second ("gretl-bn2") the header is followed by a storage map
+   holding one byte per series: 1 indicates that the series is stored
+   as an array of floats, 0 that it is stored as doubles. A series is
+   eligible for float storage only if each of its non-missing values
+   survives a round trip through float unchanged, so the saving in
+   file size (and read time) comes with no loss of precision. NAs are
+   written as float NaNs. Float series are widened to double on
+   reading: the in-memory dataset is always double, since dset->Z
+   is read directly as double by every estimator and genr routine.
+*/
+
+static int write_binary_header (FILE *fp, const char *smap, int nv)
 {
     char header[BIN_HDRLEN] = {0};
     int err = 0;
@@ -1857,21 +1871,104 @@ static int write_binary_header (FILE *fp)
     strcpy(header, "gretl-bin:big-endian");
 #endif
 
+    if (smap != NULL) {
+	memcpy(header, "gretl-bn2:", 10);
+    }
+
     if (fwrite(header, 1, BIN_HDRLEN, fp) != BIN_HDRLEN) {
 	err = E_DATA;
+    } else if (smap != NULL && fwrite(smap, 1, nv, fp) != nv) {
+	err = E_DATA;
     }
 
     return err;
 }
 
+static int series_fits_float (const double *x, int n)
+{
+    int t;
+
+    for (t=0; t<n; t++) {
+	if (!na(x[t]) && (double) (float) x[t] != x[t]) {
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+/* If the user has enabled float storage, build the per-series storage
+   map for the nv series to be written; return NULL if float storage
+   is not enabled or no series qualifies.
+*/
+
+static char *binary_storage_map (const DATASET *dset, const int *list,
+				 int nvars, int nv, int uv, int tv)
+{
+    char *smap = NULL;
+    int T = dset->t2 - dset->t1 + 1;
+    int i, v, nf = 0;
+
+    if (!libset_get_bool(GDTB_FLOAT)) {
+	return NULL;
+    }
+
+    smap = calloc(nv, 1);
+    if (smap == NULL) {
+	return NULL;
+    }
+
+    for (i=1; i<=nv; i++) {
+	if (i <= nvars) {
+	    v = savenum(list, i);
+	} else {
+	    v = (i == nvars + 1)? uv : tv;
+	}
+	if (series_fits_float(dset->Z[v] + dset->t1, T)) {
+	    smap[i-1] = 1;
+	    nf++;
+	}
+    }
+
+    if (nf == 0) {
+	free(smap);
+	smap = NULL;
+    }
+
+    return smap;
+}
+
+static int write_binary_values (FILE *fp, const double *x, int n,
+				float *fbuf)
+{
+    size_t wrote;
+
+    if (fbuf != NULL) {
+	int t;
+
+	for (t=0; t<n; t++) {
+	    fbuf[t] = na(x[t])? NAN : (float) x[t];
+	}
+	wrote = fwrite(fbuf, sizeof(float), n, fp);
+    } else {
+	wrote = fwrite(x, sizeof(double), n, fp);
+    }
+
+    return (wrote == n)? 0 : E_DATA;
+}
+
 static int write_binary_data (const char *fname, const DATASET *dset, 
 			      const int *list, int nvars, int nrows)
 {
     char *bname;
+    char *smap = NULL;
+    float *fbuf = NULL;
+    double *tmp = NULL;
     FILE *fp;
     int T = dset->t2 - dset->t1 + 1;
-    size_t wrote;
-    int i, v, err = 0;
+    int uv = 0, tv = 0;
+    int i, v, nv = nvars;
+    int err = 0;
 
     bname = switch_ext_new(fname, "bin");
     fp = gretl_fopen(bname, "wb");
@@ -1881,13 +1978,9 @@ static int write_binary_data (const char *fname, const DATASET *dset,
 	return E_FOPEN;
     }
 
-    write_binary_header(fp);
-
     if (nrows < T) {
 	/* panel data with skip-padding in force */
-	double *tmp = NULL;
-	int uv = 0, tv = 0;
-	int s, t, nv = 0;
+	int t;
 
 	err = dataset_add_series((DATASET *) dset, 2);
 	if (!err) {
@@ -1911,37 +2004,50 @@ static int write_binary_data (const char *fname, const DATASET *dset,
 	}
 
 	nv = nvars + 2;
-	for (i=1; i<=nv && !err; i++) {
-	    if (i <= nvars) {
-		v = savenum(list, i);
-	    } else {
-		v = (i == nvars + 1)? uv : tv;
+    }
+
+    if (!err) {
+	smap = binary_storage_map(dset, list, nvars, nv, uv, tv);
+	if (smap != NULL) {
+	    fbuf = malloc(nrows * sizeof *fbuf);
+	    if (fbuf == NULL) {
+		/* fall back to storing all series as doubles */
+		free(smap);
+		smap = NULL;
 	    }
-	    s = 0;
-	    for (t=dset->t1; t<=dset->t2 && !err; t++) {
+	}
+	err = write_binary_header(fp, smap, nv);
+    }
+
+    for (i=1; i<=nv && !err; i++) {
+	const double *x;
+
+	if (i <= nvars) {
+	    v = savenum(list, i);
+	} else {
+	    v = (i == nvars + 1)? uv : tv;
+	}
+	if (tmp != NULL) {
+	    int s = 0, t;
+
+	    for (t=dset->t1; t<=dset->t2; t++) {
 		if (dset->Z[uv][t] != 0.0) {
 		    tmp[s++] = dset->Z[v][t];
 		}
 	    }
-	    wrote = fwrite(tmp, sizeof(double), nrows, fp);
-	    if (wrote != nrows) {
-		err = E_DATA;
-	    }
+	    x = tmp;
+	} else {
+	    x = dset->Z[v] + dset->t1;
 	}
+	err = write_binary_values(fp, x, nrows,
+				  (smap != NULL && smap[i-1])? fbuf : NULL);
+    }
 
-	free(tmp);
-	if (uv > 0) {
-	    dataset_drop_last_variables((DATASET *) dset, 2);
-	}
-    } else {
-	for (i=1; i<=nvars && !err; i++) {
-	    v = savenum(list, i);
-	    wrote = fwrite(dset->Z[v] + dset->t1, sizeof(double), 
-			   T, fp);
-	    if (wrote != T) {
-		err = E_DATA;
-	    }
-	}
+    free(tmp);
+    free(fbuf);
+    free(smap);
+    if (uv > 0) {
+	dataset_drop_last_variables((DATASET *) dset, 2);
     }
 
     fclose(fp);
@@ -1949,18 +2055,7 @@ static int write_binary_data (const char *fname, const DATASET *dset,
     return err;
 }
 
-static void gdt_swap_endianness (DATASET *dset)
-{
-    int i, t;
-
-    for (i=1; i<dset->v; i++) {
-	for (t=0; t<dset->n; t++) {
-	    reverse_double(dset->Z[i][t]);
-	}
-    }
-}
-
-static int read_binary_header (FILE *fp, int order)
+static int read_binary_header (FILE *fp, int order, int *fmt)
 {
     char hdr[BIN_HDRLEN] = {0};
     unsigned chk;
@@ -1973,7 +2068,12 @@ static int read_binary_header (FILE *fp, int order)
     } else {
 	int bin_order = 0;
 
-	if (strncmp(hdr, "gretl-bin:", 10)) {
+	if (!strncmp(hdr, "gretl-bin:", 10)) {
+	    *fmt = 1;
+	} else if (!strncmp(hdr, "gretl-bn2:", 10)) {
+	    *fmt = 2;
+	}
+	if (*fmt == 0) {
 	    err = E_DATA;
 	} else if (!strcmp(hdr + 10, "little-endian")) {
 	    bin_order = G_LITTLE_ENDIAN;
@@ -1994,6 +2094,38 @@ static int read_binary_header (FILE *fp, int order)
     return err;
 }
 
+static int read_binary_values (FILE *fp, double *x, int n,
+			       float *fbuf, int swap)
+{
+    size_t got;
+    int t;
+
+    if (fbuf != NULL) {
+	got = fread(fbuf, sizeof(float), n, fp);
+	if (got != n) {
+	    return E_DATA;
+	}
+	for (t=0; t<n; t++) {
+	    if (swap) {
+		reverse_float(fbuf[t]);
+	    }
+	    x[t] = isnan(fbuf[t])? NADBL : (double) fbuf[t];
+	}
+    } else {
+	got = fread(x, sizeof(double), n, fp);
+	if (got != n) {
+	    return E_DATA;
+	}
+	if (swap) {
+	    for (t=0; t<n; t++) {
+		reverse_double(x[t]);
+	    }
+	}
+    }
+
+    return 0;
+}
+
 static int read_binary_data (const char *fname, 
 			     DATASET *dset,
 			     int order,
@@ -2011,31 +2143,44 @@ static int read_binary_data (const char *fname,
 	err = E_FOPEN;
     } else {
 	int T = dset->n;
-	long offset = T * sizeof(double);
-	size_t got;
-	int i, k = 1;
-
-	err = read_binary_header(fp, order);
+	int swap = (order != G_BYTE_ORDER);
+	char *smap = NULL;
+	float *fbuf = NULL;
+	long offset;
+	int i, flt, k = 1;
+	int fmt = 0;
+
+	err = read_binary_header(fp, order, &fmt);
+
+	if (!err && fmt == 2) {
+	    smap = malloc(fullv - 1);
+	    fbuf = malloc(T * sizeof *fbuf);
+	    if (smap == NULL || fbuf == NULL) {
+		err = E_ALLOC;
+	    } else if (fread(smap, 1, fullv - 1, fp) != fullv - 1) {
+		gretl_errmsg_set("Error reading binary data file");
+		err = E_DATA;
+	    }
+	}
 
 	for (i=1; i<fullv && !err; i++) {
+	    flt = (smap != NULL && smap[i-1]);
 	    if (vlist == NULL || in_gretl_list(vlist, i)) {
-		got = fread(dset->Z[k++], sizeof(double), T, fp);
-		if (got != T) {
-		    err = E_DATA;
-		}
+		err = read_binary_values(fp, dset->Z[k++], T,
+					 flt ? fbuf : NULL, swap);
 	    } else {
+		offset = T * (flt ? sizeof(float) : sizeof(double));
 		fseek(fp, offset, SEEK_CUR);
 	    }
 	}
+
+	free(smap);
+	free(fbuf);
 	fclose(fp);
     }
 
     free(bname);
 
-    if (!err && order != G_BYTE_ORDER) {
-	gdt_swap_endianness(dset);
-    }
-
     return err;
 }
 
@@ -83,6 +83,8 @@ struct kalman_ {
 		     number of rows of F that do something other than
 		     shifting down the elements of the state vector
 		  */
+    int ss;       /* P has converged to its steady state, so the gain
+		     and forecast error variance are held fixed */
 
     /* continuously updated matrices */
     gretl_matrix *S0; /* r x 1: state vector, before updating */
@@ -137,6 +139,10 @@ struct kalman_ {
 
     /* structure needed only when smoothing in the time-varying case */
     stepinfo *step;
+
+    /* apparatus for low-memory smoothing */
+    gretl_matrix *Pck; /* P_{t|t-1} at every ckstep'th step, vech by row */
+    int ckstep;        /* interval between checkpoints */
     
     /* workspace matrices */
     gretl_matrix_block *Blk; /* holder for the following */
@@ -153,6 +159,7 @@ struct kalman_ {
     gretl_matrix *Tmprr_2a;
     gretl_matrix *Tmprr_2b;
     gretl_matrix *Tmpr1;
+    gretl_matrix *Plag; /* P_{t|t-1}, for checking convergence of P */
 
     gretl_bundle *b; /* the bundle of which this struct is a member */
     void *data;      /* handle for attching additional info */
@@ -290,7 +297,9 @@ void kalman_free (kalman *K)
 
     if (K->step != NULL) {
 	free_stepinfo(K);
-    }    
+    }
+
+    gretl_matrix_free(K->Pck);
 
     free(K);
 }
@@ -320,9 +329,12 @@ static kalman *kalman_new_empty (int flags)
 	K->matcalls = NULL;
 	K->cross = NULL;
 	K->step = NULL;
+	K->Pck = NULL;
+	K->ckstep = 0;
 	K->flags = flags;
 	K->fnlevel = 0;
 	K->t = 0;
+	K->ss = 0;
 	K->prn = NULL;
 	K->data = NULL;
 	K->b = NULL;
@@ -480,7 +492,12 @@ static int maybe_resize_export_matrix (kalman *K, gretl_matrix *m, int i)
     } else if (i == K_BIG_S) {
 	cols = K->r;
     } else if (i == K_BIG_P) {
-	cols = (K->r * K->r + K->r) / 2;
+	if (K->flags & KALMAN_CKPT) {
+	    /* low-memory smoothing: variances only */
+	    cols = K->r;
+	} else {
+	    cols = (K->r * K->r + K->r) / 2;
+	}
     } else if (i == K_LL) {
 	cols = 1;
     } else if (i == K_K) {
@@ -710,6 +727,19 @@ static void load_to_diag (gretl_matrix *targ,
     }
 }
 
+/* Write the diagonal of square matrix @src into row @t of @targ */
+
+static void load_diag_to_row (gretl_matrix *targ,
+			      const gretl_matrix *src,
+			      int t)
+{
+    int i;
+
+    for (i=0; i<src->rows; i++) {
+	gretl_matrix_set(targ, t, i, gretl_matrix_get(src, i, i));
+    }
+}
+
 /* copy from vector @src into row @t of @targ */
 
 static void load_to_row (gretl_matrix *targ,
@@ -851,6 +881,7 @@ static int kalman_init (kalman *K)
 				    &K->Tmprr_2a, K->r, K->r,
 				    &K->Tmprr_2b, K->r, K->r,
 				    &K->Tmpr1, K->r, 1,
+				    &K->Plag, K->r, K->r,
 				    NULL);
 
     if (K->Blk == NULL) {
@@ -1241,19 +1272,38 @@ static int user_kalman_setup (kalman *K, gretlopt opt)
     return err;
 }
 
-static int matrix_diff (const gretl_matrix *a, const gretl_matrix *b)
-{
-    int i, n = a->rows * a->cols;
+#define KALMAN_SS_TOL 1.0e-13
 
-    /* note: we ignore the 0,0 element here */
+/* When none of F, H, Q and R is time-varying the MSE matrix P
+   converges (under the usual conditions) to the solution of the
+   steady-state Riccati equation, after which the gain and the
+   variance of the forecast errors are constant. Here we check
+   whether P_{t+1|t} (in P1) matches P_{t|t-1} (in Plag) to within
+   a tight relative tolerance. Each element is compared relative to
+   the geometric mean of the corresponding diagonal elements, so the
+   test is not fooled by a large (e.g. diffuse) block of P.
+*/
 
-    for (i=1; i<n; i++) {
-	if (b->val[i] != a->val[i]) {
-	    return 1;
+static int P_converged (kalman *K)
+{
+    const double *p0 = K->Plag->val;
+    const double *p1 = K->P1->val;
+    int i, j, r = K->r;
+    double d, s;
+
+    for (j=0; j<r; j++) {
+	for (i=0; i<=j; i++) {
+	    d = fabs(p1[j*r+i] - p0[j*r+i]);
+	    if (d > 0) {
+		s = sqrt(fabs(p0[i*r+i] * p0[j*r+j]));
+		if (d > KALMAN_SS_TOL * s) {
+		    return 0;
+		}
+	    }
 	}
     }
 
-    return 0;
+    return 1;
 }
 
 /* below: if postmult is non-zero, we're post-multiplying by the
@@ -1379,9 +1429,11 @@ static int kalman_arma_iter_1 (kalman *K, int missobs)
 	K->e->val[0] -= K->H->val[i] * K->S0->val[i];
     }
 
-    /* form FPH */
-    err += multiply_by_F(K, K->PH, K->FPH, 0);
-   
+    if (!K->ss) {
+	/* form FPH */
+	err += multiply_by_F(K, K->PH, K->FPH, 0);
+    }
+
     /* form (H'PH + R)^{-1} * (y - Ax - H'S) = "Ve" */
     Ve = K->Vt->val[0] * K->e->val[0];
 
@@ -1451,13 +1503,15 @@ static int kalman_iter_1 (kalman *K, int missobs, double *llt)
 	}
     }
 
-    /* form the gain, Kt = (FPH + BC') * (H'PH + R)^{-1} */
-    err += multiply_by_F(K, K->PH, K->FPH, 0);
-    if (K->p > 0) {
-	/* cross-correlated case */
-	gretl_matrix_add_to(K->FPH, K->cross->BC);
+    if (!K->ss) {
+	/* form the gain, Kt = (FPH + BC') * (H'PH + R)^{-1} */
+	err += multiply_by_F(K, K->PH, K->FPH, 0);
+	if (K->p > 0) {
+	    /* cross-correlated case */
+	    gretl_matrix_add_to(K->FPH, K->cross->BC);
+	}
+	err += gretl_matrix_multiply(K->FPH, K->Vt, K->Kt);
     }
-    err += gretl_matrix_multiply(K->FPH, K->Vt, K->Kt);
 
     /* form K_t * e_t and add to S+ */
     err += gretl_matrix_multiply_mod(K->Kt, GRETL_MOD_NONE,
@@ -1540,7 +1594,15 @@ static void kalman_record_state (kalman *K)
     }
 
     if (K->P != NULL) {
-	load_to_vech(K->P, K->P0, K->r, K->t);
+	if (K->flags & KALMAN_CKPT) {
+	    load_diag_to_row(K->P, K->P0, K->t);
+	} else {
+	    load_to_vech(K->P, K->P0, K->r, K->t);
+	}
+    }
+
+    if (K->Pck != NULL && K->t % K->ckstep == 0) {
+	load_to_vech(K->Pck, K->P0, K->r, K->t / K->ckstep);
     }
 }
 
@@ -1844,6 +1906,47 @@ static int ksmooth_refresh_matrices (kalman *K, PRN *prn)
     return err;
 }
 
+/* Form PH, H'PH + R and its inverse, Vt, given P_{t|t-1} in P0;
+   write ln |H'PH + R| into @ldet.
+*/
+
+static int kalman_form_V (kalman *K, double *ldet)
+{
+    int i, err = 0;
+
+    gretl_matrix_multiply(K->P0, K->H, K->PH);
+
+    if (K->n == 1) {
+	/* slight speed-up for univariate observable */
+	double x = (K->R == NULL)? 0.0 : K->R->val[0];
+
+	for (i=0; i<K->r; i++) {
+	    x += K->H->val[i] * K->PH->val[i];
+	}
+	if (x <= 0.0) {
+	    err = E_NAN;
+	} else {
+	    K->HPH->val[0] = x;
+	    *ldet = log(x);
+	    K->Vt->val[0] = 1.0 / x;
+	}
+    } else {
+	gretl_matrix_qform(K->H, GRETL_MOD_TRANSPOSE,
+			   K->P0, K->HPH, GRETL_MOD_NONE);
+	if (K->R != NULL) {
+	    gretl_matrix_add_to(K->HPH, K->R);
+	}
+	gretl_matrix_copy_values(K->Vt, K->HPH);
+	err = gretl_invert_symmetric_matrix2(K->Vt, ldet);
+	if (err) {
+	    fprintf(stderr, "kalman_forecast: failed to invert V\n");
+	    gretl_matrix_print(K->Vt, "V");
+	}
+    }
+
+    return err;
+}
+
 /**
  * kalman_forecast:
  * @K: pointer to Kalman struct: see kalman_new().
@@ -1861,10 +1964,10 @@ static int ksmooth_refresh_matrices (kalman *K, PRN *prn)
 
 int kalman_forecast (kalman *K, PRN *prn)
 {
-    double ldet;
-    int smoothing, update_P = 1;
+    double ldet = 0.0;
+    int smoothing, ss_check;
     int Tmiss = 0;
-    int i, err = 0;
+    int err = 0;
 
 #if KDEBUG
     fprintf(stderr, "kalman_forecast: T = %d\n", K->T);
@@ -1879,6 +1982,11 @@ int kalman_forecast (kalman *K, PRN *prn)
     K->SSRw = K->sumldet = K->loglik = 0.0;
     K->s2 = NADBL;
     K->okT = K->T;
+    K->ss = 0;
+
+    /* can we look for a steady state of P? */
+    ss_check = !(matrix_is_varying(K, K_F) || matrix_is_varying(K, K_H) ||
+		 matrix_is_varying(K, K_Q) || matrix_is_varying(K, K_R));
 
     if (K->x == NULL) {
 	/* no exogenous vars */
@@ -1929,39 +2037,19 @@ int kalman_forecast (kalman *K, PRN *prn)
 	       FIXME?
 	     */
 	    Tmiss++;
-	}	
-
-	/* initial matrix calculations: form PH and H'PH 
-	   (note that we need PH later) */
-	gretl_matrix_multiply(K->P0, K->H, K->PH);
-	if (K->n == 1) {
-	    /* slight speed-up for univariate observable */
-	    double x = (K->R == NULL)? 0.0 : K->R->val[0];
-
-	    for (i=0; i<K->r; i++) {
-		x += K->H->val[i] * K->PH->val[i];
-	    }
-	    if (x <= 0.0) {
-		err = E_NAN;
-	    } else {
-		K->HPH->val[0] = x;
-		ldet = log(x);
-		K->Vt->val[0] = 1.0 / x;
-	    }
-	} else {
-	    gretl_matrix_qform(K->H, GRETL_MOD_TRANSPOSE,
-			       K->P0, K->HPH, GRETL_MOD_NONE);
-	    if (K->R != NULL) {
-		gretl_matrix_add_to(K->HPH, K->R);
-	    }
-	    gretl_matrix_copy_values(K->Vt, K->HPH);
-	    err = gretl_invert_symmetric_matrix2(K->Vt, &ldet);
-	    if (err) {
-		fprintf(stderr, "kalman_forecast: failed to invert V\n");
-		gretl_matrix_print(K->Vt, "V");
+	    if (K->ss) {
+		/* P will move away from the steady state */
+		K->ss = 0;
 	    }
 	}
 
+	if (!K->ss) {
+	    /* initial matrix calculations: form PH and H'PH 
+	       (note that we need PH later); in the steady state
+	       these, and ldet, are as at the previous step */
+	    err = kalman_form_V(K, &ldet);
+	}
+
 	/* likelihood bookkeeping */
 	if (err) {
 	    K->loglik = NADBL;
@@ -2016,22 +2104,19 @@ int kalman_forecast (kalman *K, PRN *prn)
 	    gretl_matrix_copy_values(K->S0, K->S1);
 	}
 
-	if (!err && update_P) {
+	if (!err && !K->ss) {
+	    if (ss_check && !missobs) {
+		gretl_matrix_copy_values(K->Plag, K->P0);
+	    }
 	    /* second stage of dual iteration */
 	    err = kalman_iter_2(K, missobs);
-	}
-
-	if (!err) {
-	    /* update MSE matrix, if needed */
-	    if (arma_ll(K) && !smoothing && update_P && K->t > 20) {
-		if (!matrix_diff(K->P1, K->P0)) {
-		    K->P0->val[0] += 1.0;
-		    update_P = 0;
+	    if (!err) {
+		if (ss_check && !missobs) {
+		    K->ss = P_converged(K);
 		}
-	    }
-	    if (update_P) {
+		/* update MSE matrix */
 		gretl_matrix_copy_values(K->P0, K->P1);
-	    } 
+	    }
 	}
     }
 
@@ -3697,14 +3782,72 @@ static int koopman_smooth (kalman *K, int dkstyle)
    stored values for the prediction error, its MSE, and the gain at
    each time step.  Note that u_t and U_t are set to zero for 
    t = T - 1.
+
+   In low-memory mode (K->Pck non-NULL) P_{t|t-1} is not stored
+   for all t; we recompute it a segment at a time, working back
+   from the end, via kalman_replay_P(), and we write only the
+   diagonal of P_{t|T} into K->P.
 */
 
+/* Low-memory smoothing: starting from the checkpoint for step @t1,
+   rerun the MSE recursion of the filter from @t1 to @t2, writing
+   P_{t|t-1} into row t - @t1 of @Pseg.
+*/
+
+static int kalman_replay_P (kalman *K, int t1, int t2,
+			    gretl_matrix *Pseg)
+{
+    double ldet;
+    int t, err = 0;
+
+    load_from_vech(K->P0, K->Pck, K->r, t1 / K->ckstep,
+		   GRETL_MOD_NONE);
+
+    set_kalman_running(K);
+
+    for (t=t1; t<=t2 && !err; t++) {
+	int missobs = 0;
+
+	K->t = t;
+	if (filter_is_varying(K)) {
+	    err = kalman_refresh_matrices(K, NULL);
+	    if (err) {
+		break;
+	    }
+	}
+	load_to_vech(Pseg, K->P0, K->r, t - t1);
+	if (t == t2) {
+	    break;
+	}
+	kalman_initialize_error(K, &missobs);
+	if (K->x != NULL) {
+	    kalman_set_Ax(K, &missobs);
+	}
+	err = kalman_form_V(K, &ldet);
+	if (!err && K->p > 0 && !missobs) {
+	    load_from_vec(K->Kt, K->K, t);
+	}
+	if (!err) {
+	    err = kalman_iter_2(K, missobs);
+	}
+	if (!err) {
+	    gretl_matrix_copy_values(K->P0, K->P1);
+	}
+    }
+
+    set_kalman_stopped(K);
+
+    return err;
+}
+
 static int anderson_moore_smooth (kalman *K)
 {
     gretl_matrix_block *B;
     gretl_matrix *L = K->Tmprr;
     gretl_matrix *u, *u1, *U, *U1;
     gretl_matrix *StT, *PtT;
+    gretl_matrix *Pseg = NULL;
+    int m = 0;
     int t, err = 0;
 
     B = gretl_matrix_block_new(&StT, K->r, 1,
@@ -3718,10 +3861,27 @@ static int anderson_moore_smooth (kalman *K)
 	return E_ALLOC;
     }
 
+    if (K->Pck != NULL) {
+	m = K->ckstep;
+	Pseg = gretl_matrix_alloc(m, (K->r * K->r + K->r) / 2);
+	if (Pseg == NULL) {
+	    gretl_matrix_block_destroy(B);
+	    return E_ALLOC;
+	}
+    }
+
     gretl_matrix_zero(u);
     gretl_matrix_zero(U);
 
     for (t=K->T-1; t>=0 && !err; t--) {
+	if (Pseg != NULL && (t == K->T - 1 || t % m == m - 1)) {
+	    /* entering a new segment: recompute P_{t|t-1} */
+	    err = kalman_replay_P(K, t - t % m, t, Pseg);
+	    if (err) {
+		break;
+	    }
+	}
+
 	/* get F_t and/or H_t if need be */
 	if (matrix_is_varying(K, K_F)) {
 	    err = retrieve_Ft(K, t);
@@ -3768,7 +3928,11 @@ static int anderson_moore_smooth (kalman *K)
 
 	/* S_{t|T} = S_{t|t-1} + P_{t|t-1} u_{t-1} */
 	load_from_row(StT, K->S, t, GRETL_MOD_NONE);
-	load_from_vech(K->P0, K->P, K->r, t, GRETL_MOD_NONE);
+	if (Pseg != NULL) {
+	    load_from_vech(K->P0, Pseg, K->r, t % m, GRETL_MOD_NONE);
+	} else {
+	    load_from_vech(K->P0, K->P, K->r, t, GRETL_MOD_NONE);
+	}
 	gretl_matrix_multiply_mod(K->P0, GRETL_MOD_NONE,
 				  u, GRETL_MOD_NONE,
 				  StT, GRETL_MOD_CUMULATE);
@@ -3778,10 +3942,15 @@ static int anderson_moore_smooth (kalman *K)
 	gretl_matrix_copy_values(PtT, K->P0);
 	gretl_matrix_qform(K->P0, GRETL_MOD_NONE,
 			   U, PtT, GRETL_MOD_DECREMENT);
-	load_to_vech(K->P, PtT, K->r, t);
+	if (Pseg != NULL) {
+	    load_diag_to_row(K->P, PtT, t);
+	} else {
+	    load_to_vech(K->P, PtT, K->r, t);
+	}
     }
 
     gretl_matrix_block_destroy(B);
+    gretl_matrix_free(Pseg);
 
     return err;
 }
@@ -4129,7 +4298,44 @@ gretl_matrix *user_kalman_smooth (const char *Pname,
     return S;
 }
 
-int kalman_bundle_smooth (gretl_bundle *b, int dist, PRN *prn)
+/* Set up for low-memory smoothing: P_{t|t-1} is saved on the
+   forward pass only at intervals of about sqrt(T) steps. This is
+   needed only for Anderson-Moore smoothing; the disturbance
+   smoother does not use P_{t|t-1}.
+*/
+
+static int kalman_add_checkpoints (kalman *K)
+{
+    int nr = (K->r * K->r + K->r) / 2;
+    int m = (int) ceil(sqrt((double) K->T));
+
+    K->ckstep = m;
+    K->Pck = gretl_matrix_alloc((K->T + m - 1) / m, nr);
+
+    return (K->Pck == NULL)? E_ALLOC : 0;
+}
+
+/**
+ * kalman_bundle_smooth:
+ * @b: pointer to Kalman bundle.
+ * @dist: 0 for state smoothing (Anderson-Moore), 1 for
+ * disturbance smoothing, or 2 for disturbance smoothing
+ * in the style of Durbin and Koopman.
+ * @ckpt: if non-zero, economize on memory: the MSE of the
+ * state is not stored in full for all time steps; and in
+ * the state-smoothing case it is recomputed from checkpoints
+ * on the backward pass.
+ * @prn: verbose printer, or NULL.
+ *
+ * Runs a filtering pass followed by a backward, smoothing pass
+ * on the Kalman filter in @b. In the @ckpt case the "stvar"
+ * member of @b holds only the variances of the state.
+ *
+ * Returns: 0 on success, non-zero code on error.
+ */
+
+int kalman_bundle_smooth (gretl_bundle *b, int dist, int ckpt,
+			  PRN *prn)
 {
     kalman *K = gretl_bundle_get_private_data(b);    
     int err;
@@ -4140,6 +4346,12 @@ int kalman_bundle_smooth (gretl_bundle *b, int dist, PRN *prn)
     }
 
     K->b = b; /* attach bundle pointer */
+
+    if (ckpt) {
+	K->flags |= KALMAN_CKPT;
+    } else {
+	K->flags &= ~KALMAN_CKPT;
+    }
     
     err = kalman_ensure_output_matrices(K);
 
@@ -4163,6 +4375,10 @@ int kalman_bundle_smooth (gretl_bundle *b, int dist, PRN *prn)
 	err = kalman_bundle_recheck_matrices(K, prn);
     }
 
+    if (!err && ckpt && !dist) {
+	err = kalman_add_checkpoints(K);
+    }
+
     if (!err) {
 	/* forward pass */
 	K->flags |= KALMAN_SMOOTH;
@@ -4184,8 +4400,11 @@ int kalman_bundle_smooth (gretl_bundle *b, int dist, PRN *prn)
 
  bailout:    
 
-    /* trash the "stepinfo" storage */
+    /* trash the "stepinfo" storage and any checkpoints */
     free_stepinfo(K);
+    gretl_matrix_free(K->Pck);
+    K->Pck = NULL;
+    K->flags &= ~KALMAN_CKPT;
 
     return err;
 }
@@ -32,7 +32,8 @@ enum {
     KALMAN_ETT     = 1 << 8, /* ARMA: producing \epsilon{t|t} estimates */
     KALMAN_CHECK   = 1 << 9, /* checking user-defined matrices */
     KALMAN_BUNDLE  = 1 << 10, /* kalman is inside a bundle */
-    KALMAN_SSFSIM  = 1 << 11  /* on simulation, emulate SsfPack */
+    KALMAN_SSFSIM  = 1 << 11, /* on simulation, emulate SsfPack */
+    KALMAN_CKPT    = 1 << 12  /* low-memory smoothing, via checkpoints */
 };
 
 typedef struct kalman_ kalman;
@@ -102,7 +103,8 @@ int kalman_bundle_run (gretl_bundle *b, PRN *prn, int *errp);
 gretl_matrix *user_kalman_smooth (const char *Pname, const char *Uname,
 				  int *err);
 
-int kalman_bundle_smooth (gretl_bundle *b, int dist, PRN *prn);
+int kalman_bundle_smooth (gretl_bundle *b, int dist, int ckpt,
+			  PRN *prn);
 
 gretl_matrix *user_kalman_simulate (const gretl_matrix *V, 
 				    const gretl_matrix *W,
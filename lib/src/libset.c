@@ -73,7 +73,8 @@ enum {
     STATE_OPENMP_ON       = 1 << 19, /* using openmp */
     STATE_ROBUST_Z        = 1 << 20, /* use z- not t-score with HCCM/HAC */
     STATE_MWRITE_G        = 1 << 21, /* use %g format with mwrite() */
-    STATE_ECHO_SPACE      = 1 << 22  /* preserve vertical space in output */
+    STATE_ECHO_SPACE      = 1 << 22, /* preserve vertical space in output */
+    STATE_GDTB_FLOAT      = 1 << 23  /* allow float storage in binary data files */
 };    
 
 /* for values that really want a non-negative integer */
@@ -158,6 +159,7 @@ struct set_vars_ {
 			   !strcmp(s, USE_DCMT) || \
 			   !strcmp(s, ROBUST_Z) || \
 			   !strcmp(s, MWRITE_G) || \
+			   !strcmp(s, GDTB_FLOAT) || \
 			   !strcmp(s, USE_OPENMP))
 
 #define libset_double(s) (!strcmp(s, CONV_HUGE) || \
@@ -1533,6 +1535,7 @@ static int print_settings (PRN *prn, gretlopt opt)
 
     libset_print_bool(USE_CWD, prn, opt);
     libset_print_bool(SKIP_MISSING, prn, opt);
+    libset_print_bool(GDTB_FLOAT, prn, opt);
 
     libset_print_bool(R_LIB, prn, opt);
     libset_print_bool(R_FUNCTIONS, prn, opt);
@@ -2157,6 +2160,8 @@ static int boolvar_get_flag (const char *s)
 	return STATE_ROBUST_Z;
     } else if (!strcmp(s, MWRITE_G)) {
 	return STATE_MWRITE_G;
+    } else if (!strcmp(s, GDTB_FLOAT)) {
+	return STATE_GDTB_FLOAT;
     } else {
 	fprintf(stderr, "libset_get_bool: unrecognized "
 		"variable '%s'\n", s);	
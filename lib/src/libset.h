@@ -90,6 +90,7 @@ typedef enum {
 #define ROBUST_Z         "robust_z"
 #define WILDBOOT_DIST    "wildboot"
 #define MWRITE_G         "mwrite_g"
+#define GDTB_FLOAT       "gdtb_float"
 
 typedef int (*ITER_PRINT_FUNC) (int, PRN *);
 typedef void (*SHOW_ACTIVITY_FUNC) (void);
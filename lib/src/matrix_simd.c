@@ -17,40 +17,73 @@
  * 
  */
 
-/* All code here is conditional on AVX (128-bit SSE is not really
-   worth the bother when working with doubles)
+/* This file is included by gretl_matrix.c. It has two parts. The
+   first is conditional on AVX having been enabled at build time
+   (128-bit SSE is not really worth the bother for the simple
+   add/subtract/multiply helpers it contains). The second provides
+   elementwise and reduction kernels in SSE2, AVX2+FMA and AVX-512
+   variants, selected at run time according to the capabilities of
+   the CPU.
 */
 
 #define SHOW_SIMD 0
 
-static int gretl_matrix_simd_add_to (gretl_matrix *a,
-				     const gretl_matrix *b,
-				     int n)
+#ifdef USE_SIMD
+
+/* the data arrays of heap-allocated matrices are normally 64-byte
+   aligned (see mval_malloc), but stack matrices and members of
+   matrix blocks need not be, so check before using aligned
+   loads and stores
+*/
+
+#define simd_aligned(p) (((size_t) (p) & 31) == 0)
+
+/* the loop body shared by the aligned and unaligned variants of
+   simd_add_or_subtract(), parameterized by load and store */
+
+#define AVX_ADDSUB_LOOP(load, store)				\
+    for (i=0; i<imax; i++) {					\
+	__m256d Ymm_A = load(ax);				\
+	__m256d Ymm_B = load(bx);				\
+								\
+	store(cx, sub ? _mm256_sub_pd(Ymm_A, Ymm_B) :		\
+	      _mm256_add_pd(Ymm_A, Ymm_B));			\
+	ax += 4;						\
+	bx += 4;						\
+	cx += 4;						\
+    }
+
+/* cx = ax + bx, or ax - bx if @sub is non-zero, processing 4
+   doubles in parallel; @cx may coincide with @ax */
+
+static void simd_add_or_subtract (const double *ax,
+				  const double *bx,
+				  double *cx,
+				  int n, int sub)
 {
-    double *ax = a->val;
-    const double *bx = b->val;
     int i, imax = n / 4;
     int rem = n % 4;
 
-#if SHOW_SIMD
-    fprintf(stderr, "AVX: gretl_matrix_simd_add_to (%d x %d)\n",
-	    a->rows, a->cols);
-#endif
-
-    for (i=0; i<imax; i++) {
-	/* add 4 doubles in parallel */
-	__m256d Ymm_A = _mm256_loadu_pd(ax);
-	__m256d Ymm_B = _mm256_loadu_pd(bx);
-	__m256d Ymm_C = _mm256_add_pd(Ymm_A, Ymm_B);
-	
-	_mm256_storeu_pd(ax, Ymm_C);
-	ax += 4;
-	bx += 4;
+    if (simd_aligned(ax) && simd_aligned(bx) && simd_aligned(cx)) {
+	AVX_ADDSUB_LOOP(_mm256_load_pd, _mm256_store_pd);
+    } else {
+	AVX_ADDSUB_LOOP(_mm256_loadu_pd, _mm256_storeu_pd);
     }
 
     for (i=0; i<rem; i++) {
-	ax[i] += bx[i];
+	cx[i] = sub ? ax[i] - bx[i] : ax[i] + bx[i];
     }
+}
+
+static int gretl_matrix_simd_add_to (gretl_matrix *a,
+				     const gretl_matrix *b,
+				     int n)
+{
+#if SHOW_SIMD
+    fprintf(stderr, "AVX: gretl_matrix_simd_add_to (%d x %d)\n",
+	    a->rows, a->cols);
+#endif
+    simd_add_or_subtract(a->val, b->val, a->val, n, 0);
 
     return 0;
 }
@@ -59,30 +92,11 @@ static int gretl_matrix_simd_subt_from (gretl_matrix *a,
 					const gretl_matrix *b,
 					int n)
 {
-    double *ax = a->val;
-    const double *bx = b->val;
-    int i, imax = n / 4;
-    int rem = n % 4;
-
 #if SHOW_SIMD
     fprintf(stderr, "AVX: gretl_matrix_simd_subt_from (%d x %d)\n",
 	    a->rows, a->cols);
 #endif
-
-    for (i=0; i<imax; i++) {
-	/* subtract 4 doubles in parallel */
-	__m256d Ymm_A = _mm256_loadu_pd(ax);
-	__m256d Ymm_B = _mm256_loadu_pd(bx);
-	__m256d Ymm_C = _mm256_sub_pd(Ymm_A, Ymm_B);
-	
-	_mm256_storeu_pd(ax, Ymm_C);
-	ax += 4;
-	bx += 4;
-    }
-
-    for (i=0; i<rem; i++) {
-	ax[i] -= bx[i];
-    }
+    simd_add_or_subtract(a->val, b->val, a->val, n, 1);
 
     return 0;
 }
@@ -92,29 +106,10 @@ static int gretl_matrix_simd_add (const double *ax,
 				  double *cx,
 				  int n)
 {
-    int i, imax = n / 4;
-    int rem = n % 4;
-
 #if SHOW_SIMD
-    fprintf(stderr, "AVX: gretl_matrix_simd_add (%d x %d)\n",
-	    a->rows, a->cols);
+    fprintf(stderr, "AVX: gretl_matrix_simd_add (n = %d)\n", n);
 #endif
-
-    for (i=0; i<imax; i++) {
-	/* process 4 doubles in parallel */
-	__m256d Ymm_A = _mm256_loadu_pd(ax);
-	__m256d Ymm_B = _mm256_loadu_pd(bx);
-	__m256d Ymm_C = _mm256_add_pd(Ymm_A, Ymm_B);
-	
-	_mm256_storeu_pd(cx, Ymm_C);
-	ax += 4;
-	bx += 4;
-	cx += 4;
-    }
-
-    for (i=0; i<rem; i++) {
-	cx[i] = ax[i] + bx[i];
-    }
+    simd_add_or_subtract(ax, bx, cx, n, 0);
 
     return 0;
 }
@@ -124,29 +119,10 @@ static int gretl_matrix_simd_subtract (const double *ax,
 				       double *cx,
 				       int n)
 {
-    int i, imax = n / 4;
-    int rem = n % 4;
-
 #if SHOW_SIMD
-    fprintf(stderr, "AVX: gretl_matrix_simd_subtract (%d x %d)\n",
-	    a->rows, a->cols);
+    fprintf(stderr, "AVX: gretl_matrix_simd_subtract (n = %d)\n", n);
 #endif
-
-    for (i=0; i<imax; i++) {
-	/* process 4 doubles in parallel */
-	__m256d Ymm_A = _mm256_loadu_pd(ax);
-	__m256d Ymm_B = _mm256_loadu_pd(bx);
-	__m256d Ymm_C = _mm256_sub_pd(Ymm_A, Ymm_B);
-	
-	_mm256_storeu_pd(cx, Ymm_C);
-	cx += 4;
-	ax += 4;
-	bx += 4;
-    }
-
-    for (i=0; i<rem; i++) {
-	cx[i] = ax[i] - bx[i];
-    }
+    simd_add_or_subtract(ax, bx, cx, n, 1);
 
     return 0;
 }
@@ -355,3 +331,592 @@ static int gretl_matrix_simd_mul (const gretl_matrix *A,
     return 0;
 }
 
+#endif /* USE_SIMD */
+
+#ifdef SIMD_DISPATCH
+
+/* Run-time dispatched kernels. Each instruction-set variant is
+   compiled via a GCC "target" attribute, so this code does not
+   depend on the -m flags given for the build as a whole.
+
+   The elementwise operators have the semantics of x_op_y(): the
+   arithmetic operators propagate NaNs in the usual IEEE manner,
+   "==" and the ordering comparisons yield 0 if either operand is
+   NaN, and "!=" yields 1. The min/max kernels skip NaNs in the
+   data, except that a NaN in the initial position is sticky; this
+   again matches the scalar code in gretl_matrix_minmax().
+*/
+
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+
+enum {
+    SIMD_BC_NONE, /* neither operand is broadcast */
+    SIMD_BC_A,    /* the first operand is a scalar */
+    SIMD_BC_B     /* the second operand is a scalar */
+};
+
+#define simd_op_supported(op) (op == '+' || op == '-' || op == '*' || \
+			       op == '/' || op == '=' || op == '>' || \
+			       op == '<' || op == ']' || op == '[' || \
+			       op == '!')
+
+typedef struct simd_kernels_ simd_kernels;
+
+struct simd_kernels_ {
+    const char *id;
+    void (*binop) (const double *, const double *, double *,
+		   int, int, int);
+    double (*sum) (const double *, int);
+    void (*vadd) (double *, const double *, int);
+    double (*ssd) (const double *, int, double);
+    double (*minmax) (const double *, int, int);
+    void (*vminmax) (double *, const double *, int, int);
+};
+
+static inline double simd_elem (const double *x, int i, int bc)
+{
+    return bc ? x[0] : x[i];
+}
+
+/* SSE2: 2 doubles per register */
+
+SIMD_TARGET_SSE2
+static inline __m128d sse2_op (__m128d x, __m128d y, int op)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+
+    switch (op) {
+    case '+': return _mm_add_pd(x, y);
+    case '-': return _mm_sub_pd(x, y);
+    case '*': return _mm_mul_pd(x, y);
+    case '/': return _mm_div_pd(x, y);
+    case '=': return _mm_and_pd(_mm_cmpeq_pd(x, y), one);
+    case '>': return _mm_and_pd(_mm_cmpgt_pd(x, y), one);
+    case '<': return _mm_and_pd(_mm_cmplt_pd(x, y), one);
+    case ']': return _mm_and_pd(_mm_cmpge_pd(x, y), one);
+    case '[': return _mm_and_pd(_mm_cmple_pd(x, y), one);
+    case '!': return _mm_and_pd(_mm_cmpneq_pd(x, y), one);
+    default:  return _mm_setzero_pd();
+    }
+}
+
+SIMD_TARGET_SSE2
+static void simd_binop_sse2 (const double *a, const double *b,
+			     double *c, int n, int op, int bc)
+{
+    __m128d x = _mm_set1_pd(a[0]);
+    __m128d y = _mm_set1_pd(b[0]);
+    int i, n2 = n - n % 2;
+
+    for (i=0; i<n2; i+=2) {
+	if (bc != SIMD_BC_A) {
+	    x = _mm_loadu_pd(a + i);
+	}
+	if (bc != SIMD_BC_B) {
+	    y = _mm_loadu_pd(b + i);
+	}
+	_mm_storeu_pd(c + i, sse2_op(x, y, op));
+    }
+    for (; i<n; i++) {
+	c[i] = x_op_y(simd_elem(a, i, bc == SIMD_BC_A),
+		      simd_elem(b, i, bc == SIMD_BC_B), op);
+    }
+}
+
+SIMD_TARGET_SSE2
+static double simd_sum_sse2 (const double *x, int n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    double tmp[2], ret;
+    int i, n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	acc0 = _mm_add_pd(acc0, _mm_loadu_pd(x + i));
+	acc1 = _mm_add_pd(acc1, _mm_loadu_pd(x + i + 2));
+    }
+    _mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+    ret = tmp[0] + tmp[1];
+    for (; i<n; i++) {
+	ret += x[i];
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_SSE2
+static void simd_vadd_sse2 (double *s, const double *x, int n)
+{
+    int i, n2 = n - n % 2;
+
+    for (i=0; i<n2; i+=2) {
+	_mm_storeu_pd(s + i, _mm_add_pd(_mm_loadu_pd(s + i),
+					_mm_loadu_pd(x + i)));
+    }
+    for (; i<n; i++) {
+	s[i] += x[i];
+    }
+}
+
+SIMD_TARGET_SSE2
+static double simd_ssd_sse2 (const double *x, int n, double xbar)
+{
+    __m128d m = _mm_set1_pd(xbar);
+    __m128d acc = _mm_setzero_pd();
+    __m128d d;
+    double tmp[2], ret;
+    int i, n2 = n - n % 2;
+
+    for (i=0; i<n2; i+=2) {
+	d = _mm_sub_pd(_mm_loadu_pd(x + i), m);
+	acc = _mm_add_pd(acc, _mm_mul_pd(d, d));
+    }
+    _mm_storeu_pd(tmp, acc);
+    ret = tmp[0] + tmp[1];
+    for (; i<n; i++) {
+	ret += (x[i] - xbar) * (x[i] - xbar);
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_SSE2
+static double simd_minmax_sse2 (const double *x, int n, int mm)
+{
+    double tmp[2], d = x[0];
+    __m128d acc;
+    int i, n2;
+
+    if (isnan(d)) {
+	return d;
+    }
+
+    acc = _mm_set1_pd(d);
+    n2 = n - n % 2;
+
+    /* note: the data must be the first operand of max/min,
+       so that a NaN in the data yields the accumulator */
+    for (i=0; i<n2; i+=2) {
+	acc = mm ? _mm_max_pd(_mm_loadu_pd(x + i), acc) :
+	    _mm_min_pd(_mm_loadu_pd(x + i), acc);
+    }
+    _mm_storeu_pd(tmp, acc);
+    for (i=0; i<2; i++) {
+	if ((mm && tmp[i] > d) || (!mm && tmp[i] < d)) {
+	    d = tmp[i];
+	}
+    }
+    for (i=n2; i<n; i++) {
+	if ((mm && x[i] > d) || (!mm && x[i] < d)) {
+	    d = x[i];
+	}
+    }
+
+    return d;
+}
+
+SIMD_TARGET_SSE2
+static void simd_vminmax_sse2 (double *s, const double *x, int n, int mm)
+{
+    __m128d v;
+    int i, n2 = n - n % 2;
+
+    for (i=0; i<n2; i+=2) {
+	v = _mm_loadu_pd(x + i);
+	v = mm ? _mm_max_pd(v, _mm_loadu_pd(s + i)) :
+	    _mm_min_pd(v, _mm_loadu_pd(s + i));
+	_mm_storeu_pd(s + i, v);
+    }
+    for (; i<n; i++) {
+	if ((mm && x[i] > s[i]) || (!mm && x[i] < s[i])) {
+	    s[i] = x[i];
+	}
+    }
+}
+
+static const simd_kernels sse2_kernels = {
+    "SSE2",
+    simd_binop_sse2,
+    simd_sum_sse2,
+    simd_vadd_sse2,
+    simd_ssd_sse2,
+    simd_minmax_sse2,
+    simd_vminmax_sse2
+};
+
+/* AVX2 with FMA: 4 doubles per register */
+
+SIMD_TARGET_AVX2
+static inline __m256d avx2_op (__m256d x, __m256d y, int op)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    switch (op) {
+    case '+': return _mm256_add_pd(x, y);
+    case '-': return _mm256_sub_pd(x, y);
+    case '*': return _mm256_mul_pd(x, y);
+    case '/': return _mm256_div_pd(x, y);
+    case '=': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ), one);
+    case '>': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_GT_OQ), one);
+    case '<': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_LT_OQ), one);
+    case ']': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_GE_OQ), one);
+    case '[': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_LE_OQ), one);
+    case '!': return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_NEQ_UQ), one);
+    default:  return _mm256_setzero_pd();
+    }
+}
+
+SIMD_TARGET_AVX2
+static void simd_binop_avx2 (const double *a, const double *b,
+			     double *c, int n, int op, int bc)
+{
+    __m256d x = _mm256_set1_pd(a[0]);
+    __m256d y = _mm256_set1_pd(b[0]);
+    int i, n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	if (bc != SIMD_BC_A) {
+	    x = _mm256_loadu_pd(a + i);
+	}
+	if (bc != SIMD_BC_B) {
+	    y = _mm256_loadu_pd(b + i);
+	}
+	_mm256_storeu_pd(c + i, avx2_op(x, y, op));
+    }
+    for (; i<n; i++) {
+	c[i] = x_op_y(simd_elem(a, i, bc == SIMD_BC_A),
+		      simd_elem(b, i, bc == SIMD_BC_B), op);
+    }
+}
+
+SIMD_TARGET_AVX2
+static double simd_sum_avx2 (const double *x, int n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    double tmp[4], ret;
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+	acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i + 4));
+    }
+    _mm256_storeu_pd(tmp, _mm256_add_pd(acc0, acc1));
+    ret = (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+    for (; i<n; i++) {
+	ret += x[i];
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_AVX2
+static void simd_vadd_avx2 (double *s, const double *x, int n)
+{
+    int i, n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	_mm256_storeu_pd(s + i, _mm256_add_pd(_mm256_loadu_pd(s + i),
+					      _mm256_loadu_pd(x + i)));
+    }
+    for (; i<n; i++) {
+	s[i] += x[i];
+    }
+}
+
+SIMD_TARGET_AVX2
+static double simd_ssd_avx2 (const double *x, int n, double xbar)
+{
+    __m256d m = _mm256_set1_pd(xbar);
+    __m256d acc = _mm256_setzero_pd();
+    __m256d d;
+    double tmp[4], ret;
+    int i, n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	d = _mm256_sub_pd(_mm256_loadu_pd(x + i), m);
+	acc = _mm256_fmadd_pd(d, d, acc);
+    }
+    _mm256_storeu_pd(tmp, acc);
+    ret = (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+    for (; i<n; i++) {
+	ret += (x[i] - xbar) * (x[i] - xbar);
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_AVX2
+static double simd_minmax_avx2 (const double *x, int n, int mm)
+{
+    double tmp[4], d = x[0];
+    __m256d acc;
+    int i, n4;
+
+    if (isnan(d)) {
+	return d;
+    }
+
+    acc = _mm256_set1_pd(d);
+    n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	acc = mm ? _mm256_max_pd(_mm256_loadu_pd(x + i), acc) :
+	    _mm256_min_pd(_mm256_loadu_pd(x + i), acc);
+    }
+    _mm256_storeu_pd(tmp, acc);
+    for (i=0; i<4; i++) {
+	if ((mm && tmp[i] > d) || (!mm && tmp[i] < d)) {
+	    d = tmp[i];
+	}
+    }
+    for (i=n4; i<n; i++) {
+	if ((mm && x[i] > d) || (!mm && x[i] < d)) {
+	    d = x[i];
+	}
+    }
+
+    return d;
+}
+
+SIMD_TARGET_AVX2
+static void simd_vminmax_avx2 (double *s, const double *x, int n, int mm)
+{
+    __m256d v;
+    int i, n4 = n - n % 4;
+
+    for (i=0; i<n4; i+=4) {
+	v = _mm256_loadu_pd(x + i);
+	v = mm ? _mm256_max_pd(v, _mm256_loadu_pd(s + i)) :
+	    _mm256_min_pd(v, _mm256_loadu_pd(s + i));
+	_mm256_storeu_pd(s + i, v);
+    }
+    for (; i<n; i++) {
+	if ((mm && x[i] > s[i]) || (!mm && x[i] < s[i])) {
+	    s[i] = x[i];
+	}
+    }
+}
+
+static const simd_kernels avx2_kernels = {
+    "AVX2",
+    simd_binop_avx2,
+    simd_sum_avx2,
+    simd_vadd_avx2,
+    simd_ssd_avx2,
+    simd_minmax_avx2,
+    simd_vminmax_avx2
+};
+
+#ifdef SIMD_HAVE_AVX512
+
+/* AVX-512: 8 doubles per register. Comparisons yield a mask
+   rather than a vector, so we use a masked move of 1.0 to
+   produce the 0/1 result */
+
+SIMD_TARGET_AVX512
+static inline __m512d avx512_op (__m512d x, __m512d y, int op)
+{
+    const __m512d one = _mm512_set1_pd(1.0);
+
+    switch (op) {
+    case '+': return _mm512_add_pd(x, y);
+    case '-': return _mm512_sub_pd(x, y);
+    case '*': return _mm512_mul_pd(x, y);
+    case '/': return _mm512_div_pd(x, y);
+    case '=':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_EQ_OQ), one);
+    case '>':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_GT_OQ), one);
+    case '<':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_LT_OQ), one);
+    case ']':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_GE_OQ), one);
+    case '[':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_LE_OQ), one);
+    case '!':
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, _CMP_NEQ_UQ), one);
+    default:
+	return _mm512_setzero_pd();
+    }
+}
+
+SIMD_TARGET_AVX512
+static void simd_binop_avx512 (const double *a, const double *b,
+			       double *c, int n, int op, int bc)
+{
+    __m512d x = _mm512_set1_pd(a[0]);
+    __m512d y = _mm512_set1_pd(b[0]);
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	if (bc != SIMD_BC_A) {
+	    x = _mm512_loadu_pd(a + i);
+	}
+	if (bc != SIMD_BC_B) {
+	    y = _mm512_loadu_pd(b + i);
+	}
+	_mm512_storeu_pd(c + i, avx512_op(x, y, op));
+    }
+    for (; i<n; i++) {
+	c[i] = x_op_y(simd_elem(a, i, bc == SIMD_BC_A),
+		      simd_elem(b, i, bc == SIMD_BC_B), op);
+    }
+}
+
+SIMD_TARGET_AVX512
+static double simd_sum_avx512 (const double *x, int n)
+{
+    __m512d acc = _mm512_setzero_pd();
+    double tmp[8], ret;
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	acc = _mm512_add_pd(acc, _mm512_loadu_pd(x + i));
+    }
+    _mm512_storeu_pd(tmp, acc);
+    ret = ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3])) +
+	((tmp[4] + tmp[5]) + (tmp[6] + tmp[7]));
+    for (; i<n; i++) {
+	ret += x[i];
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_AVX512
+static void simd_vadd_avx512 (double *s, const double *x, int n)
+{
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	_mm512_storeu_pd(s + i, _mm512_add_pd(_mm512_loadu_pd(s + i),
+					      _mm512_loadu_pd(x + i)));
+    }
+    for (; i<n; i++) {
+	s[i] += x[i];
+    }
+}
+
+SIMD_TARGET_AVX512
+static double simd_ssd_avx512 (const double *x, int n, double xbar)
+{
+    __m512d m = _mm512_set1_pd(xbar);
+    __m512d acc = _mm512_setzero_pd();
+    __m512d d;
+    double tmp[8], ret;
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	d = _mm512_sub_pd(_mm512_loadu_pd(x + i), m);
+	acc = _mm512_fmadd_pd(d, d, acc);
+    }
+    _mm512_storeu_pd(tmp, acc);
+    ret = ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3])) +
+	((tmp[4] + tmp[5]) + (tmp[6] + tmp[7]));
+    for (; i<n; i++) {
+	ret += (x[i] - xbar) * (x[i] - xbar);
+    }
+
+    return ret;
+}
+
+SIMD_TARGET_AVX512
+static double simd_minmax_avx512 (const double *x, int n, int mm)
+{
+    double tmp[8], d = x[0];
+    __m512d acc;
+    int i, n8;
+
+    if (isnan(d)) {
+	return d;
+    }
+
+    acc = _mm512_set1_pd(d);
+    n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	acc = mm ? _mm512_max_pd(_mm512_loadu_pd(x + i), acc) :
+	    _mm512_min_pd(_mm512_loadu_pd(x + i), acc);
+    }
+    _mm512_storeu_pd(tmp, acc);
+    for (i=0; i<8; i++) {
+	if ((mm && tmp[i] > d) || (!mm && tmp[i] < d)) {
+	    d = tmp[i];
+	}
+    }
+    for (i=n8; i<n; i++) {
+	if ((mm && x[i] > d) || (!mm && x[i] < d)) {
+	    d = x[i];
+	}
+    }
+
+    return d;
+}
+
+SIMD_TARGET_AVX512
+static void simd_vminmax_avx512 (double *s, const double *x, int n, int mm)
+{
+    __m512d v;
+    int i, n8 = n - n % 8;
+
+    for (i=0; i<n8; i+=8) {
+	v = _mm512_loadu_pd(x + i);
+	v = mm ? _mm512_max_pd(v, _mm512_loadu_pd(s + i)) :
+	    _mm512_min_pd(v, _mm512_loadu_pd(s + i));
+	_mm512_storeu_pd(s + i, v);
+    }
+    for (; i<n; i++) {
+	if ((mm && x[i] > s[i]) || (!mm && x[i] < s[i])) {
+	    s[i] = x[i];
+	}
+    }
+}
+
+static const simd_kernels avx512_kernels = {
+    "AVX-512",
+    simd_binop_avx512,
+    simd_sum_avx512,
+    simd_vadd_avx512,
+    simd_ssd_avx512,
+    simd_minmax_avx512,
+    simd_vminmax_avx512
+};
+
+#endif /* SIMD_HAVE_AVX512 */
+
+/* Determine, once, the best set of kernels supported by the
+   CPU we're running on; return NULL if there's none.
+*/
+
+static const simd_kernels *simd_get_kernels (void)
+{
+    static const simd_kernels *K;
+    static int checked;
+
+    if (!checked) {
+	__builtin_cpu_init();
+#ifdef SIMD_HAVE_AVX512
+	if (__builtin_cpu_supports("avx512f")) {
+	    K = &avx512_kernels;
+	}
+#endif
+	if (K == NULL && __builtin_cpu_supports("avx2") &&
+	    __builtin_cpu_supports("fma")) {
+	    K = &avx2_kernels;
+	}
+	if (K == NULL && __builtin_cpu_supports("sse2")) {
+	    K = &sse2_kernels;
+	}
+#if SHOW_SIMD
+	fprintf(stderr, "SIMD kernels: %s\n", K != NULL ? K->id : "none");
+#endif
+	checked = 1;
+    }
+
+    return K;
+}
+
+#endif /* SIMD_DISPATCH */
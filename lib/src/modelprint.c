@@ -1389,9 +1389,27 @@ static void panel_vcv_line (const VCVInfo *vi, PRN *prn)
 static void cluster_vcv_line (const MODEL *pmod, const VCVInfo *vi, 
 			      const DATASET *dset, PRN *prn)
 {
+    const int *clist = gretl_model_get_list(pmod, "cluster_vars");
+    const int *nlist = gretl_model_get_list(pmod, "cluster_sizes");
     gchar *cstr;
 
-    if (vi->vmin >= 1 && vi->vmin < dset->v) {
+    if (clist != NULL && nlist != NULL && clist[0] == nlist[0]) {
+	/* multi-way clustering */
+	GString *gs = g_string_new(NULL);
+	int i, v;
+
+	for (i=1; i<=clist[0]; i++) {
+	    v = clist[i];
+	    if (i > 1) {
+		g_string_append(gs, ", ");
+	    }
+	    g_string_append_printf(gs, "%s (%d)", v < dset->v ?
+				   dset->varname[v] : "?", nlist[i]);
+	}
+	cstr = g_strdup_printf(A_("Standard errors clustered by %s"),
+			       gs->str);
+	g_string_free(gs, TRUE);
+    } else if (vi->vmin >= 1 && vi->vmin < dset->v) {
 	int n_c = gretl_model_get_int(pmod, "n_clusters");
 
 	cstr = g_strdup_printf(A_("Standard errors clustered by %d values of %s"),
@@ -223,8 +223,10 @@ struct plugin_function_info plugin_functions[] = {
 
     /* modeling */
     { "arma_model",        P_ARMA },
+    { "arma_auto_select",  P_ARMA },
     { "arma_x12_model",    P_ARMA_X12 },
     { "garch_model",       P_GARCH },
+    { "garch_batch_estimate", P_GARCH },
     { "count_data_estimate", P_POISSON },
     { "heckit_estimate",   P_HECKIT },
     { "interval_estimate", P_INTREG },
@@ -24,6 +24,7 @@
 #include "libset.h"
 #include "gretl_panel.h"
 #include "estim_private.h"
+#include "gretl_fft.h"
 
 #include "gretl_f2c.h"
 #include "clapack_double.h"
@@ -333,23 +334,6 @@ static gretl_matrix *make_data_X (const MODEL *pmod,
     return X;
 }
 
-/* Calculate W(t)-transpose * W(t-lag) */
-
-static void wtw (gretl_matrix *wt, const gretl_matrix *X, 
-		 int n, int t, int lag)
-{
-    int i, j;
-    double xi, xj;
-
-    for (i=0; i<n; i++) {
-	xi = gretl_matrix_get(X, t, i);
-	for (j=0; j<n; j++) {
-	    xj = gretl_matrix_get(X, t - lag, j);
-	    gretl_matrix_set(wt, i, j, xi * xj);
-	}
-    }
-}
-
 /* special handling for quadratic spectral kernel */
 
 double qs_hac_weight (double bt, int i)
@@ -726,6 +710,218 @@ static gretl_matrix *newey_west_H (const gretl_matrix *X,
     return H;
 }
 
+/* Write into column @j of @Z the weighted sum of lags of column
+   @j of @H, z_t = sum_{i=1}^{p} w_i h_{t-i}.
+*/
+
+static void hac_filter_column (const gretl_matrix *H,
+			       const double *w, int p,
+			       gretl_matrix *Z, int j)
+{
+    int T = H->rows;
+    const double *h = H->val + j * T;
+    double *z = Z->val + j * T;
+    int i, t, imax;
+    double x;
+
+    for (t=0; t<T; t++) {
+	imax = t < p ? t : p;
+	x = 0.0;
+	for (i=1; i<=imax; i++) {
+	    x += w[i] * h[t-i];
+	}
+	z[t] = x;
+    }
+}
+
+static void hac_filter_direct (const gretl_matrix *H,
+			       const double *w, int p,
+			       gretl_matrix *Z)
+{
+    int j, k = H->cols;
+
+#if defined(_OPENMP)
+    guint64 fpm = (guint64) H->rows * k * p;
+
+    if (!libset_use_openmp(fpm)) {
+	goto st_mode;
+    }
+
+#pragma omp parallel for private(j)
+    for (j=0; j<k; j++) {
+	hac_filter_column(H, w, p, Z, j);
+    }
+    return;
+
+ st_mode:
+#endif
+
+    for (j=0; j<k; j++) {
+	hac_filter_column(H, w, p, Z, j);
+    }
+}
+
+/* As hac_filter_direct(), but computing the lag sums for all
+   columns of @H as linear convolutions via the FFT. The series
+   are padded with zeros to a length of at least T + p, so that
+   the circular convolution does not wrap around into the first
+   T rows. This is worthwhile when the number of lags is large,
+   in particular for the QS kernel, for which p = T - 1.
+*/
+
+static int hac_filter_fft (const gretl_matrix *H,
+			   const double *w, int p,
+			   gretl_matrix *Z)
+{
+    gretl_matrix *Hp = NULL;
+    gretl_matrix *wp = NULL;
+    gretl_matrix *FH = NULL;
+    gretl_matrix *Fw = NULL;
+    gretl_matrix *ZL = NULL;
+    int T = H->rows;
+    int k = H->cols;
+    int i, j, L = 2;
+    int err = 0;
+
+    while (L < T + p) {
+	L *= 2;
+    }
+
+    Hp = gretl_zero_matrix_new(L, k);
+    wp = gretl_zero_matrix_new(L, 1);
+    if (Hp == NULL || wp == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    for (j=0; j<k; j++) {
+	memcpy(Hp->val + j * L, H->val + j * T, T * sizeof(double));
+    }
+    for (i=1; i<=p; i++) {
+	wp->val[i] = w[i];
+    }
+
+    FH = gretl_matrix_fft(Hp, &err);
+    if (!err) {
+	Fw = gretl_matrix_fft(wp, &err);
+    }
+
+    if (!err) {
+	/* multiply the transforms, column by column */
+	double a, b, c, d;
+
+	for (j=0; j<k; j++) {
+	    double *re = FH->val + 2 * j * L;
+	    double *im = re + L;
+
+	    for (i=0; i<L; i++) {
+		a = re[i];
+		b = im[i];
+		c = Fw->val[i];
+		d = Fw->val[i+L];
+		re[i] = a * c - b * d;
+		im[i] = a * d + b * c;
+	    }
+	}
+	ZL = gretl_matrix_ffti(FH, &err);
+    }
+
+    if (!err) {
+	for (j=0; j<k; j++) {
+	    memcpy(Z->val + j * T, ZL->val + j * L, T * sizeof(double));
+	}
+    }
+
+ bailout:
+
+    gretl_matrix_free(Hp);
+    gretl_matrix_free(wp);
+    gretl_matrix_free(FH);
+    gretl_matrix_free(Fw);
+    gretl_matrix_free(ZL);
+
+    return err;
+}
+
+/* Write into @XOX the kernel-weighted sum of the autocovariance
+   matrices of @H,
+
+     Gamma_0 + sum_{j=1}^{p} w_j (Gamma_j + Gamma_j').
+
+   Since sum_{j=1}^{p} w_j Gamma_j = sum_t H_t' z_t, with z_t the
+   weighted sum of lags of H_t, the entire sum can be formed as
+   H'H + H'Z + Z'H, where Z holds the z_t as rows. Forming Z costs
+   O(T*k*p) directly, or O(k*T*log T) via the FFT, as against
+   O(T*k^2*p) for accumulating Gamma_j one outer product at a time.
+*/
+
+static int hac_weighted_sum (const gretl_matrix *H, int kern,
+			     int p, double bt, gretl_matrix *XOX)
+{
+    gretl_matrix *Z = NULL;
+    double *w = NULL;
+    int T = H->rows;
+    int pmax = p;
+    int j, err = 0;
+
+    /* Gamma(0) */
+    gretl_matrix_multiply_mod(H, GRETL_MOD_TRANSPOSE,
+			      H, GRETL_MOD_NONE,
+			      XOX, GRETL_MOD_NONE);
+
+    if (pmax >= T) {
+	/* lags beyond T-1 contribute nothing; but note that
+	   the kernel weights still depend on the original @p */
+	pmax = T - 1;
+    }
+    if (pmax < 1) {
+	return 0;
+    }
+
+    Z = gretl_matrix_alloc(T, H->cols);
+    w = malloc((pmax + 1) * sizeof *w);
+    if (Z == NULL || w == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    w[0] = 1.0;
+    for (j=1; j<=pmax; j++) {
+	if (kern == KERNEL_QS) {
+	    w[j] = qs_hac_weight(bt, j);
+	} else {
+	    w[j] = hac_weight(kern, p, j);
+	}
+    }
+
+    if (pmax > 10 * log2(2.0 * T)) {
+	err = hac_filter_fft(H, w, pmax, Z);
+	if (err == E_EXTERNAL) {
+	    /* FFT not available */
+	    err = 0;
+	    hac_filter_direct(H, w, pmax, Z);
+	}
+    } else {
+	hac_filter_direct(H, w, pmax, Z);
+    }
+
+    if (!err) {
+	gretl_matrix_multiply_mod(H, GRETL_MOD_TRANSPOSE,
+				  Z, GRETL_MOD_NONE,
+				  XOX, GRETL_MOD_CUMULATE);
+	gretl_matrix_multiply_mod(Z, GRETL_MOD_TRANSPOSE,
+				  H, GRETL_MOD_NONE,
+				  XOX, GRETL_MOD_CUMULATE);
+    }
+
+ bailout:
+
+    gretl_matrix_free(Z);
+    free(w);
+
+    return err;
+}
+
 /* HAC_XOX: compute the "sandwich filling" for the HAC estimator */
 
 gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
@@ -734,8 +930,6 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
 		       int *err)
 {
     gretl_matrix *XOX = NULL;
-    gretl_matrix *Wtj = NULL;
-    gretl_matrix *Gj = NULL;
     gretl_matrix *H = NULL;
     gretl_matrix *A = NULL;
     gretl_matrix *w = NULL;
@@ -744,7 +938,7 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
     int kern;
     int T = X->rows;
     int k = X->cols;
-    int p, j, t;
+    int p;
     double bt = 0;
 
     if (use_prior) {
@@ -784,10 +978,8 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
     }
 
     if (!*err) {
-	XOX = gretl_zero_matrix_new(k, k);
-	Wtj = gretl_matrix_alloc(k, k);
-	Gj = gretl_matrix_alloc(k, k);
-	if (XOX == NULL || Wtj == NULL || Gj == NULL) {
+	XOX = gretl_matrix_alloc(k, k);
+	if (XOX == NULL) {
 	    *err = E_ALLOC;
 	}
     }
@@ -813,30 +1005,9 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
     }
 
     if (!*err) {
-	double wj;
-
-	for (j=0; j<=p; j++) {
-	    /* cumulate running sum of Gamma-hat terms */
-	    gretl_matrix_zero(Gj);
-
-	    for (t=j; t<T; t++) {
-		/* W(t)-transpose * W(t-j) */
-		wtw(Wtj, H, k, t, j);
-		gretl_matrix_add_to(Gj, Wtj);
-	    }
-
-	    if (j > 0) {
-		/* Gamma(j) = Gamma(j) + Gamma(j)-transpose */
-		gretl_matrix_add_self_transpose(Gj);
-		if (kern == KERNEL_QS) {
-		    wj = qs_hac_weight(bt, j);
-		} else {
-		    wj = hac_weight(kern, p, j);
-		}
-		gretl_matrix_multiply_by_scalar(Gj, wj);
-	    }
-
-	    gretl_matrix_add_to(XOX, Gj);
+	*err = hac_weighted_sum(H, kern, p, bt, XOX);
+	if (*err) {
+	    goto bailout;
 	}
     }
 
@@ -861,8 +1032,6 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
  bailout:
 
     gretl_matrix_free(H);
-    gretl_matrix_free(Wtj);
-    gretl_matrix_free(Gj);
     gretl_matrix_free(A);
     gretl_matrix_free(w);
 
@@ -1554,224 +1723,436 @@ int qr_tsls_vcv (MODEL *pmod, const DATASET *dset, gretlopt opt)
     return err;    
 }
 
-static int cval_count (MODEL *pmod, double cvi, const double *cZ)
+/* Support for cluster-robust variance estimation. Observations
+   are grouped by sorting (value, index) pairs on the clustering
+   variable, after which the per-cluster sums of the scores can
+   be formed in a single pass through the sample. The cost is
+   O(n log n) regardless of the number of clusters, M, where
+   the earlier approach of rescanning the sample for each
+   cluster was O(n * M).
+*/
+
+#define CDEBUG 0
+
+#define CLUSTER_CHUNK 512
+
+typedef struct cl_pair_ cl_pair;
+
+struct cl_pair_ {
+    double x;
+    int t;
+};
+
+static int compare_cl_pairs (const void *a, const void *b)
 {
-    int t, cc = 0;
+    const cl_pair *pa = a;
+    const cl_pair *pb = b;
+    int ret = (pa->x > pb->x) - (pa->x < pb->x);
 
-    for (t=pmod->t1; t<=pmod->t2; t++) {
-	if (!na(pmod->uhat[t]) && cZ[t] == cvi) {
-	    cc++;
+    return ret != 0 ? ret : pa->t - pb->t;
+}
+
+/* On return @ord holds the indices 0 to @n-1 arranged such that
+   observations belonging to a given cluster are adjacent, and
+   @g holds the 0-based cluster index for each observation. The
+   return value is the number of distinct values in @x.
+*/
+
+static int cluster_sort (const double *x, int n, int *ord,
+			 int *g, int *err)
+{
+    cl_pair *pp;
+    int i, M = 0;
+
+    pp = malloc(n * sizeof *pp);
+    if (pp == NULL) {
+	*err = E_ALLOC;
+	return 0;
+    }
+
+    for (i=0; i<n; i++) {
+	pp[i].x = x[i];
+	pp[i].t = i;
+    }
+
+    qsort(pp, n, sizeof *pp, compare_cl_pairs);
+
+    for (i=0; i<n; i++) {
+	if (i == 0 || pp[i].x != pp[i-1].x) {
+	    M++;
 	}
+	ord[i] = pp[i].t;
+	g[pp[i].t] = M - 1;
     }
 
-    return cc;
+    free(pp);
+
+    return M;
 }
 
-static int cval_count_max (MODEL *pmod, const gretl_matrix *cvals, 
-			   const double *cZ)
+/* Write into @W the sum over clusters of s_c s_c', where s_c is
+   the sum of the rows of @G belonging to cluster c, with @ord and
+   @g as produced by cluster_sort(). The cluster sums are written
+   as columns of the workspace @S and flushed into @W whenever @S
+   fills up, so that memory use is bounded independently of the
+   number of clusters.
+*/
+
+static void cluster_sums_XTX (const gretl_matrix *G,
+			      const int *ord, const int *g,
+			      gretl_matrix *S, gretl_matrix *W)
 {
-    int n = gretl_vector_get_length(cvals);
-    int i, cc, cmax = 0;
+    int n = G->rows, k = G->cols;
+    int chunk = S->cols;
+    int i, j, t, c = -1, r = -1;
+    double *s = NULL;
+
+    gretl_matrix_zero(W);
 
     for (i=0; i<n; i++) {
-	cc = cval_count(pmod, cvals->val[i], cZ);
-	if (cc > cmax) {
-	    cmax = cc;
+	t = ord[i];
+	if (g[t] != c) {
+	    if (++r == chunk) {
+		gretl_matrix_multiply_mod(S, GRETL_MOD_NONE,
+					  S, GRETL_MOD_TRANSPOSE,
+					  W, GRETL_MOD_CUMULATE);
+		r = 0;
+	    }
+	    s = S->val + r * k;
+	    for (j=0; j<k; j++) {
+		s[j] = 0.0;
+	    }
+	    c = g[t];
+	}
+	for (j=0; j<k; j++) {
+	    s[j] += G->val[j * n + t];
 	}
     }
 
-    return cmax;
+    if (r >= 0) {
+	gretl_matrix_reuse(S, -1, r + 1);
+	gretl_matrix_multiply_mod(S, GRETL_MOD_NONE,
+				  S, GRETL_MOD_TRANSPOSE,
+				  W, GRETL_MOD_CUMULATE);
+	gretl_matrix_reuse(S, -1, chunk);
+    }
 }
 
-#define CDEBUG 0
-
-static gretl_matrix *cluster_vcv_calc (MODEL *pmod,
-				       int cvar,
-				       gretl_matrix *cvals, 
-				       gretl_matrix *XX,
-				       const DATASET *dset,
-				       int *err)
+/* Multi-way clustering can in principle produce a "meat" matrix
+   that is not positive semidefinite: in that case, following
+   Cameron, Gelbach and Miller, we zero any negative eigenvalues.
+*/
 
+static int cluster_meat_fix_psd (gretl_matrix *W)
 {
-    gretl_matrix *V = NULL;
-    gretl_matrix *W = NULL;
-    gretl_matrix *XXW = NULL;
-    gretl_vector *ei = NULL;
-    gretl_matrix *Xi = NULL;
-    gretl_vector *eXi = NULL;
-    const double *cZ;
-    int n_c, M, N, k = pmod->ncoeff;
-    int total_obs = 0;
-    int i, j, v, t;
-
-    cZ = dset->Z[cvar];    
-    N = cval_count_max(pmod, cvals, cZ);
-#if CDEBUG
-    fprintf(stderr, "max cval count = %d\n", N);
-#endif
-
-    V   = gretl_matrix_alloc(k, k);
-    W   = gretl_zero_matrix_new(k, k);
-    XXW = gretl_zero_matrix_new(k, k);
-    ei  = gretl_column_vector_alloc(N);
-    Xi  = gretl_matrix_alloc(N, k);
-    eXi = gretl_vector_alloc(k);
+    gretl_matrix *E, *lam;
+    int k = W->rows;
+    int i, j, l;
+    int err = 0;
 
-    if (V == NULL || W == NULL || XXW == NULL || 
-	ei == NULL || Xi == NULL || eXi == NULL) {
-	*err = E_ALLOC;
-	goto bailout;
+    E = gretl_matrix_copy(W);
+    if (E == NULL) {
+	return E_ALLOC;
     }
 
-    M = gretl_vector_get_length(cvals);
-    n_c = 0;
+    lam = gretl_symmetric_matrix_eigenvals(E, 1, &err);
 
-    for (i=0; i<M; i++) {
-	double cvi = cvals->val[i];
-	int Ni = cval_count(pmod, cvi, cZ);
-	int s = 0;
+    if (!err && lam->val[0] < 0) {
+	double wij, el;
 
-	if (Ni == 0) {
-	    continue;
+	for (i=0; i<k; i++) {
+	    for (j=0; j<=i; j++) {
+		wij = 0.0;
+		for (l=0; l<k; l++) {
+		    el = lam->val[l];
+		    if (el > 0) {
+			wij += el * gretl_matrix_get(E, i, l) *
+			    gretl_matrix_get(E, j, l);
+		    }
+		}
+		gretl_matrix_set(W, i, j, wij);
+		gretl_matrix_set(W, j, i, wij);
+	    }
 	}
+    }
 
-#if CDEBUG
-	fprintf(stderr, "i=%d, cvi=%g, Ni=%d\n", i, cvi, Ni);
-#endif
-	ei = gretl_matrix_reuse(ei, Ni, -1);
-	Xi = gretl_matrix_reuse(Xi, Ni, -1);
+    gretl_matrix_free(E);
+    gretl_matrix_free(lam);
 
-	for (t=pmod->t1; t<=pmod->t2; t++) {
-	    if (!na(pmod->uhat[t]) && cZ[t] == cvi) {
-		gretl_vector_set(ei, s, pmod->uhat[t]);
-		for (j=0; j<k; j++) {
-		    v = pmod->list[j+2];
-		    gretl_matrix_set(Xi, s, j, dset->Z[v][t]);
+    return err;
+}
+
+/**
+ * cluster_list_from_option:
+ * @ci: command index.
+ * @dset: pointer to dataset.
+ * @err: location to receive error code.
+ *
+ * Parses the parameter to the --cluster option for command
+ * @ci, which should hold the names of between one and four
+ * series, separated by commas or spaces.
+ *
+ * Returns: a gretl list holding the IDs of the clustering
+ * series, or NULL on failure.
+ */
+
+int *cluster_list_from_option (int ci, const DATASET *dset, int *err)
+{
+    const char *s = get_optval_string(ci, OPT_C);
+    char vname[VNAMELEN];
+    int *list = NULL;
+    int n, v;
+
+    if (s == NULL) {
+	*err = E_PARSE;
+	return NULL;
+    }
+
+    while (*s && !*err) {
+	s += strspn(s, ", ");
+	n = strcspn(s, ", ");
+	if (n == 0) {
+	    break;
+	} else if (n >= VNAMELEN) {
+	    *err = E_UNKVAR;
+	} else {
+	    *vname = '\0';
+	    strncat(vname, s, n);
+	    v = current_series_index(dset, vname);
+	    if (v < 1 || v >= dset->v) {
+		*err = E_UNKVAR;
+	    } else {
+		gretl_list_append_term(&list, v);
+		if (list == NULL) {
+		    *err = E_ALLOC;
 		}
-		s++;
-	    }
-	    if (s == Ni) {
-		/* we've filled this matrix */
-		break;
 	    }
 	}
+	s += n;
+    }
 
-	gretl_matrix_multiply_mod(ei, GRETL_MOD_TRANSPOSE,
-				  Xi, GRETL_MOD_NONE,
-				  eXi, GRETL_MOD_NONE);
-	gretl_matrix_multiply_mod(eXi, GRETL_MOD_TRANSPOSE,
-				  eXi, GRETL_MOD_NONE,
-				  W, GRETL_MOD_CUMULATE);
-#if CDEBUG > 1
-	gretl_matrix_print(ei, "e(i)");
-	gretl_matrix_print(Xi, "X(i)");
-	gretl_matrix_print(W, "W");
-#endif
-	n_c++;
-	total_obs += s;
+    if (!*err && (list == NULL || list[0] > CLUSTER_MAXDIM)) {
+	*err = E_INVARG;
     }
 
-    if (n_c < 2) {
-	gretl_errmsg_set("Invalid clustering variable");
-	*err = E_DATA;
-	goto bailout;
-    } else if (total_obs < pmod->nobs) {
-	*err = E_MISSDATA;
+    if (*err) {
+	free(list);
+	list = NULL;
+    }
+
+    return list;
+}
+
+/**
+ * cluster_meat:
+ * @G: n x k matrix of per-observation scores, where n is the
+ * number of observations used in estimation of @pmod.
+ * @pmod: pointer to model.
+ * @clist: list of clustering series.
+ * @dset: pointer to dataset.
+ * @dfcorr: if non-zero, apply the factor M/(M-1) to the sum
+ * for M clusters.
+ * @nc: array of length @clist[0] to receive the number of
+ * clusters for each of the clustering series.
+ * @err: location to receive error code.
+ *
+ * Computes the "meat" of the cluster-robust sandwich variance
+ * estimator, namely the sum over clusters of g_c g_c', where
+ * g_c is the sum of the rows of @G belonging to cluster c. If
+ * @clist contains more than one series, the multi-way estimator
+ * of Cameron, Gelbach and Miller (2011) is computed: this is the
+ * sum over the non-empty subsets of the clustering dimensions of
+ * the one-way estimators based on the intersection of the
+ * dimensions in each subset, with sign positive for subsets of
+ * odd cardinality and negative otherwise.
+ *
+ * Returns: a k x k matrix, or NULL on failure.
+ */
+
+gretl_matrix *cluster_meat (const gretl_matrix *G,
+			    const MODEL *pmod,
+			    const int *clist,
+			    const DATASET *dset,
+			    int dfcorr, int *nc,
+			    int *err)
+{
+    gretl_matrix *W = NULL;
+    gretl_matrix *Wc = NULL;
+    gretl_matrix *S = NULL;
+    double *x = NULL;
+    int *gd = NULL;
+    int *ord = NULL;
+    int *g = NULL;
+    int nd = clist[0];
+    int n = G->rows;
+    int k = G->cols;
+    int d, i, t, set;
+
+    if (n != pmod->nobs) {
+	*err = E_NONCONF;
+	return NULL;
+    }
+
+    W = gretl_zero_matrix_new(k, k);
+    Wc = gretl_matrix_alloc(k, k);
+    S = gretl_matrix_alloc(k, CLUSTER_CHUNK);
+    x = malloc(n * sizeof *x);
+    gd = malloc(nd * n * sizeof *gd);
+    ord = malloc(n * sizeof *ord);
+    g = malloc(n * sizeof *g);
+
+    if (W == NULL || Wc == NULL || S == NULL || x == NULL ||
+	gd == NULL || ord == NULL || g == NULL) {
+	*err = E_ALLOC;
 	goto bailout;
     }
 
-    /* form V(W) = (X'X)^{-1} W (X'X)^{-1} */
-    gretl_matrix_multiply(XX, W, XXW);
-    gretl_matrix_multiply(XXW, XX, V);
-    gretl_matrix_xtr_symmetric(V);
+    /* find the clusters in each dimension, checking for missing
+       values of the clustering variables */
 
-#if CDEBUG
-    gretl_matrix_print(XX, "X'X^{-1}");
-    gretl_matrix_print(W, "W");
-    gretl_matrix_print(V, "V");
-#endif
+    for (d=0; d<nd && !*err; d++) {
+	const double *cz = dset->Z[clist[d+1]];
+
+	i = 0;
+	for (t=pmod->t1; t<=pmod->t2; t++) {
+	    if (!model_missing(pmod, t)) {
+		if (na(cz[t])) {
+		    *err = E_MISSDATA;
+		    break;
+		}
+		x[i++] = cz[t];
+	    }
+	}
+	if (!*err) {
+	    nc[d] = cluster_sort(x, n, ord, gd + d * n, err);
+	}
+	if (!*err && nc[d] < 2) {
+	    gretl_errmsg_set("Invalid clustering variable");
+	    *err = E_DATA;
+	}
+    }
 
-    if (!(pmod->opt & OPT_N)) {
-	/* apply df adjustment a la Stata */
-	/* FIXME IVREG case? */
-	double dfadj;
+    /* loop across the non-empty subsets of the dimensions,
+       identifying the clusters for each subset by sorting on
+       the combined (dense) indices of its members */
 
-	N = pmod->nobs;
-	dfadj = (M/(M-1.0)) * (N-1.0)/(N-k);
-	gretl_matrix_multiply_by_scalar(V, dfadj);
-#if CDEBUG > 1
-	gretl_matrix_print(V, "V(adjusted)");
+    for (set=1; set < (1 << nd) && !*err; set++) {
+	double scale;
+	int card = 0;
+	int M = 0;
+
+	for (d=0; d<nd && !*err; d++) {
+	    if (set & (1 << d)) {
+		const int *gi = gd + d * n;
+
+		for (i=0; i<n; i++) {
+		    x[i] = (card == 0)? gi[i] : (double) g[i] * nc[d] + gi[i];
+		}
+		M = cluster_sort(x, n, ord, g, err);
+		card++;
+	    }
+	}
+
+	if (*err) {
+	    break;
+	}
+
+	cluster_sums_XTX(G, ord, g, S, Wc);
+	scale = (card % 2)? 1.0 : -1.0;
+	if (dfcorr && M > 1) {
+	    scale *= M / (M - 1.0);
+	}
+#if CDEBUG
+	fprintf(stderr, "cluster_meat: set %d, M = %d, scale %g\n",
+		set, M, scale);
 #endif
+	for (i=0; i<k*k; i++) {
+	    W->val[i] += scale * Wc->val[i];
+	}
+    }
 
+    if (!*err && nd > 1) {
+	*err = cluster_meat_fix_psd(W);
     }
 
  bailout:
 
-    gretl_matrix_free(W);
-    gretl_matrix_free(XXW);
-    gretl_matrix_free(ei);
-    gretl_matrix_free(Xi);
-    gretl_matrix_free(eXi);
+    gretl_matrix_free(Wc);
+    gretl_matrix_free(S);
+    free(x);
+    free(gd);
+    free(ord);
+    free(g);
 
     if (*err) {
-	gretl_matrix_free(V);
-	V = NULL;
+	gretl_matrix_free(W);
+	W = NULL;
     }
 
-    return V;
+    return W;
 }
 
-/* Get the sorted values of the clustering series, @cvar, checking
-   for missing values as we go. This is a little more complicated
-   if there are interior missing values for the regressand or
-   regressors: in that case we need to construct a temporary
-   array to hold the relevant values of the clustering series.
-*/
+static gretl_matrix *cluster_vcv_calc (MODEL *pmod,
+				       const int *clist,
+				       gretl_matrix *XX,
+				       const DATASET *dset,
+				       int *nc,
+				       int *err)
 
-static gretl_matrix *cluster_var_values (const double *cvar,
-					 MODEL *pmod,
-					 int *err)
 {
-    gretl_matrix *cvals = NULL;
-    int t;
-
-    if (pmod->missmask != NULL) {
-	double *ctmp = malloc(pmod->nobs * sizeof *ctmp);
-
-	if (ctmp == NULL) {
-	    *err = E_ALLOC;
-	} else {
-	    int i = 0;
+    gretl_matrix *G = NULL;
+    gretl_matrix *W = NULL;
+    gretl_matrix *V = NULL;
+    int dfcorr = !(pmod->opt & OPT_N);
+    int N = pmod->nobs;
+    int k = pmod->ncoeff;
+    int i, j, s, t;
 
-	    for (t=pmod->t1; t<=pmod->t2 && !*err; t++) {
-		if (pmod->missmask[t] != '1') {
-		    if (na(cvar[t])) {
-			*err = E_MISSDATA;
-		    } else {
-			ctmp[i++] = cvar[t];
-		    }
-		}
-	    }
+    G = gretl_matrix_alloc(N, k);
+    if (G == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
 
-	    if (!*err) {
-		cvals = gretl_matrix_values(ctmp, pmod->nobs, OPT_S, err);
+    /* per-observation scores, u_t * X_t */
+    s = 0;
+    for (t=pmod->t1; t<=pmod->t2; t++) {
+	if (!model_missing(pmod, t)) {
+	    for (j=0; j<k; j++) {
+		i = pmod->list[j+2];
+		gretl_matrix_set(G, s, j, pmod->uhat[t] * dset->Z[i][t]);
 	    }
-	    free(ctmp);
+	    s++;
 	}
-    } else {
-	/* no interior missing values for y or X */
-	for (t=pmod->t1; t<=pmod->t2 && !*err; t++) {
-	    if (na(cvar[t])) {
-		*err = E_MISSDATA;
-	    }
+    }
+
+    W = cluster_meat(G, pmod, clist, dset, dfcorr, nc, err);
+
+    if (!*err) {
+	V = gretl_matrix_alloc(k, k);
+	if (V == NULL) {
+	    *err = E_ALLOC;
 	}
-	if (!*err) {
-	    cvals = gretl_matrix_values(cvar + pmod->t1, pmod->nobs, 
-					OPT_S, err);
+    }
+
+    if (!*err) {
+	/* form V(W) = (X'X)^{-1} W (X'X)^{-1} */
+	gretl_matrix_qform(XX, GRETL_MOD_NONE, W, V, GRETL_MOD_NONE);
+#if CDEBUG
+	gretl_matrix_print(W, "W");
+	gretl_matrix_print(V, "V");
+#endif
+	if (dfcorr) {
+	    /* complete the df adjustment a la Stata */
+	    /* FIXME IVREG case? */
+	    gretl_matrix_multiply_by_scalar(V, (N-1.0)/(N-k));
 	}
     }
 
-    return cvals;
+    gretl_matrix_free(G);
+    gretl_matrix_free(W);
+
+    return V;
 }
 
 /**
@@ -1782,8 +2163,9 @@ static gretl_matrix *cluster_var_values (const double *cvar,
  * @XX: X'X matrix.
  * 
  * Compute and set on @pmod a variance matrix that is "clustered"
- * by the value of a selected variable via the --cluster=foo 
- * command-line option.
+ * by the value of one or more selected variables via the
+ * --cluster=foo command-line option; two-way clustering is
+ * specified as --cluster=foo,bar.
  *
  * Returns: 0 on success, non-zero code on error.
  */
@@ -1793,10 +2175,9 @@ static int qr_make_cluster_vcv (MODEL *pmod, int ci,
 				gretl_matrix *XX,
 				gretlopt opt)
 {
-    gretl_matrix *cvals = NULL;
     gretl_matrix *V = NULL;
-    const char *cname;
-    int cvar, n_c = 0;
+    int nc[CLUSTER_MAXDIM];
+    int *clist;
     int err = 0;
 
     if (pmod->ci != OLS && pmod->ci != IVREG) {
@@ -1804,34 +2185,10 @@ static int qr_make_cluster_vcv (MODEL *pmod, int ci,
 	return E_NOTIMP;
     }
 
-    cname = get_optval_string(ci, OPT_C); 
-    if (cname == NULL) {
-	return E_PARSE;
-    }
-
-    cvar = current_series_index(dset, cname);
-    if (cvar < 1 || cvar >= dset->v) {
-	err = E_UNKVAR;
-    }
-
-    if (!err) {
-	cvals = cluster_var_values(dset->Z[cvar], pmod, &err);
-	if (!err) {
-	    n_c = gretl_vector_get_length(cvals);
-	    if (n_c < 2) {
-		err = E_DATA;
-	    }
-	}
-    }
-
-#if CDEBUG
-    fprintf(stderr, "qr_make_cluster_vcv: err = %d\n", err);
-    fprintf(stderr, "cluster var = %s (%d)\n", cname, cvar);
-    gretl_matrix_print(cvals, "cvals");
-#endif
+    clist = cluster_list_from_option(ci, dset, &err);
 
     if (!err) {
-	V = cluster_vcv_calc(pmod, cvar, cvals, XX, dset, &err);
+	V = cluster_vcv_calc(pmod, clist, XX, dset, nc, &err);
     }
 
     if (!err) {
@@ -1839,12 +2196,11 @@ static int qr_make_cluster_vcv (MODEL *pmod, int ci,
     }
 
     if (!err) {
-	gretl_model_set_vcv_info(pmod, VCV_CLUSTER, cvar);
-	gretl_model_set_int(pmod, "n_clusters", n_c);
+	err = gretl_model_set_cluster_info(pmod, clist, nc);
     }
 
     gretl_matrix_free(V);
-    gretl_matrix_free(cvals);
+    free(clist);
 
     return err;
 }
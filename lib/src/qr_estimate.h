@@ -20,6 +20,8 @@
 #ifndef QR_ESTIMATE_H
 #define QR_ESTIMATE_H
 
+#define CLUSTER_MAXDIM 4 /* max number of clustering dimensions */
+
 int gretl_qr_regress (MODEL *pmod, DATASET *dset, gretlopt opt);
 
 int qr_tsls_vcv (MODEL *pmod, const DATASET *dset, gretlopt opt);
@@ -50,4 +52,13 @@ gretl_matrix *HAC_XOX (const gretl_matrix *uhat,
 		       VCVInfo *vi, int use_prior,
 		       int *err);
 
+int *cluster_list_from_option (int ci, const DATASET *dset, int *err);
+
+gretl_matrix *cluster_meat (const gretl_matrix *G,
+			    const MODEL *pmod,
+			    const int *clist,
+			    const DATASET *dset,
+			    int dfcorr, int *nc,
+			    int *err);
+
 #endif  /* QR_ESTIMATE_H */
@@ -425,6 +425,52 @@ static int resample_sync_dataset (DATASET *dset)
     return 0;
 }
 
+/* gather: copy the observations selected by @mask (of length
+   @n) from the full series @x into the subsample series @y,
+   writing NA for panel padding; if @mask is NULL all @n
+   observations are selected. Working straight from the mask
+   requires no per-call allocation, and the series are
+   independent so several can be transcribed in parallel.
+*/
+
+static void subsample_gather (double *y, const double *x,
+			      const char *mask, int n)
+{
+    int s = 0, t;
+
+    if (mask == NULL) {
+	memcpy(y, x, n * sizeof *y);
+	return;
+    }
+
+    for (t=0; t<n; t++) {
+	if (mask[t] == 1) {
+	    y[s++] = x[t];
+	} else if (mask[t] == 'p') {
+	    /* panel padding */
+	    y[s++] = NADBL;
+	}
+    }
+}
+
+/* scatter: write the subsample series @y back into the
+   observations of the full series @x selected by @mask */
+
+static void subsample_scatter (double *x, const double *y,
+			       const char *mask, int n)
+{
+    int s = 0, t;
+
+    for (t=0; t<n; t++) {
+	if (mask[t] == 1) {
+	    x[t] = y[s++];
+	} else if (mask[t] == 'p') {
+	    /* skip panel padding */
+	    s++;
+	}
+    }
+}
+
 /* Apparatus for updating full dataset when restoring full sample
    after sub-sampling.  
 */
@@ -432,23 +478,30 @@ static int resample_sync_dataset (DATASET *dset)
 static void
 update_full_data_values (const DATASET *dset)
 {
-    int i, s, t;
+    int i, vmax = MIN(fullset->v, dset->v);
 
 #if SUBDEBUG
     fprintf(stderr, "update_full_data_values: fullset->Z=%p, dset->Z=%p, dset=%p\n",
 	    (void *) fullset->Z, (void *) dset->Z, (void *) dset);
 #endif
 
-    for (i=1; i<fullset->v && i<dset->v; i++) {
-	s = 0;
-	for (t=0; t<fullset->n; t++) {
-	    if (dset->submask[t] == 1) {
-		fullset->Z[i][t] = dset->Z[i][s++];
-	    } else if (dset->submask[t] == 'p') {
-		/* skip panel padding (?) */
-		s++;
-	    }
-	}
+#if defined(_OPENMP)
+    if (!libset_use_openmp((guint64) fullset->n * vmax)) {
+	goto st_mode;
+    }
+#pragma omp parallel for private(i)
+    for (i=1; i<vmax; i++) {
+	subsample_scatter(fullset->Z[i], dset->Z[i], dset->submask,
+			  fullset->n);
+    }
+    return;
+
+ st_mode:
+#endif
+
+    for (i=1; i<vmax; i++) {
+	subsample_scatter(fullset->Z[i], dset->Z[i], dset->submask,
+			  fullset->n);
     }
 }
 
@@ -1184,7 +1237,7 @@ static int mask_contiguous (const char *mask,
     return contig;
 }
 
-static void 
+static int 
 copy_data_to_subsample (DATASET *subset, const DATASET *dset,
 			int maxv, const char *mask)
 {
@@ -1196,19 +1249,26 @@ copy_data_to_subsample (DATASET *subset, const DATASET *dset,
 #endif
 
     /* copy data values */
+#if defined(_OPENMP)
+    if (!libset_use_openmp((guint64) dset->n * maxv)) {
+	goto st_mode;
+    }
+#pragma omp parallel for private(i)
     for (i=1; i<maxv; i++) {
-	s = 0;
-	for (t=0; t<dset->n; t++) {
-	    if (mask == NULL) {
-		subset->Z[i][s++] = dset->Z[i][t];
-	    } else if (mask[t] == 1) {
-		subset->Z[i][s++] = dset->Z[i][t];
-	    } else if (mask[t] == 'p') {
-		/* panel padding */
-		subset->Z[i][s++] = NADBL;
-	    }
-	}
+	subsample_gather(subset->Z[i], dset->Z[i], mask, dset->n);
     }
+    goto data_done;
+
+ st_mode:
+#endif
+
+    for (i=1; i<maxv; i++) {
+	subsample_gather(subset->Z[i], dset->Z[i], mask, dset->n);
+    }
+
+#if defined(_OPENMP)
+ data_done:
+#endif
 
     /* copy observation markers, if any */
     if (dset->markers && subset->markers) {
@@ -1233,6 +1293,8 @@ copy_data_to_subsample (DATASET *subset, const DATASET *dset,
 	strcpy(subset->stobs, "1");
 	sprintf(subset->endobs, "%d", subset->n);
     }
+
+    return 0;
 }
 
 int get_restriction_mode (gretlopt opt)
@@ -1761,7 +1823,13 @@ restrict_sample_from_mask (char *mask, DATASET *dset, gretlopt opt)
     }
 
     /* copy across data (and case markers, if any) */
-    copy_data_to_subsample(subset, dset, dset->v, mask);
+    err = copy_data_to_subsample(subset, dset, dset->v, mask);
+    if (err) {
+	dataset_destroy_obs_markers(subset);
+	free_Z(subset);
+	free(subset);
+	return err;
+    }
 
     if (opt & OPT_T) {
 	/* --permanent */
@@ -2811,6 +2879,7 @@ int add_dataset_to_model (MODEL *pmod, const DATASET *dset,
     const DATASET *srcset;
     char *mask = NULL;
     int maxv, sn = 0;
+    int err;
 
     if (pmod->dataset != NULL) {
 	/* FIXME? */
@@ -2879,7 +2948,13 @@ int add_dataset_to_model (MODEL *pmod, const DATASET *dset,
     copy_series_info(pmod->dataset, srcset, maxv);
 
     /* copy across data */
-    copy_data_to_subsample(pmod->dataset, srcset, maxv, mask);
+    err = copy_data_to_subsample(pmod->dataset, srcset, maxv, mask);
+    if (err) {
+	destroy_dataset(pmod->dataset);
+	pmod->dataset = NULL;
+	free(mask);
+	return err;
+    }
 
     /* dataset characteristics such as pd: if we're rebuilding the
        full dataset copy these across; but if we're reconstructing a
@@ -20,6 +20,7 @@
 #include "libgretl.h"
 #include "uservar.h"
 #include "matrix_extra.h"
+#include "gretl_func.h"
 
 #define TRDEBUG 0
 
@@ -320,6 +321,202 @@ static double *testvec (int n)
     return x;
 }
 
+/* Registry of generated transformations, keyed by (transform,
+   source series, lag or second series). This allows us to
+   recognize a request for a transform that we have already
+   generated, and whose inputs have not changed since, in constant
+   time: we can then skip both the recomputation and the
+   observation-by-observation comparison with the existing series
+   performed by check_vals().
+
+   A record is valid only if (a) the global generation counter
+   has not been bumped since it was made, (b) neither the source
+   series nor the generated series has been modified since (as
+   judged by the series "mtime"), and (c) the dataset and sample
+   range are as they were. The generation counter is bumped via
+   gretl_transforms_invalidate() whenever series values may be
+   altered without updating their mtime (sorting, deletion of
+   series, observation-level assignment and so on).
+*/
+
+typedef struct tr_key_ tr_key;
+typedef struct tr_record_ tr_record;
+
+struct tr_key_ {
+    int ci;   /* transformation code */
+    int v;    /* ID of source series */
+    int aux;  /* lag order or ID of second series */
+};
+
+struct tr_record_ {
+    tr_key key;              /* must come first */
+    int targv;               /* ID of generated series */
+    char vname[VNAMELEN];    /* name of generated series */
+    char srcname[VNAMELEN];  /* name of source series */
+    const DATASET *dset;     /* dataset on which generated */
+    const double *x;         /* source data */
+    const double *y;         /* second source (SQUARE only) */
+    const double *targ;      /* generated data */
+    int n, pd, structure;    /* dataset characteristics */
+    int t1, t2;              /* sample range */
+    guint gen;               /* generation at creation */
+    gint64 stamp;            /* time of creation */
+};
+
+static GHashTable *tr_registry;
+static guint tr_generation;
+
+static guint tr_key_hash (gconstpointer p)
+{
+    const tr_key *k = p;
+
+    return ((guint) k->v * 31 + (guint) k->ci) * 31 + (guint) k->aux;
+}
+
+static gboolean tr_key_equal (gconstpointer a, gconstpointer b)
+{
+    const tr_key *ka = a;
+    const tr_key *kb = b;
+
+    return ka->v == kb->v && ka->ci == kb->ci && ka->aux == kb->aux;
+}
+
+static int tr_registered_type (int ci)
+{
+    return ci == LAGS || ci == LOGS || ci == SQUARE ||
+	ci == DIFF || ci == LDIFF || ci == SDIFF;
+}
+
+static int tr_series_unchanged (const DATASET *dset, int v,
+				const double *x, gint64 stamp)
+{
+    /* note: an mtime equal to @stamp is ambiguous as to
+       ordering, so we treat it as a change */
+    return v >= 0 && v < dset->v && dset->Z[v] == x &&
+	series_get_mtime(dset, v) < stamp;
+}
+
+/* Return the ID of a previously generated series that is known to
+   be up to date, or -1 if there's no such series.
+*/
+
+static int tr_registry_lookup (int ci, int v, int aux,
+			       const DATASET *dset)
+{
+    tr_key key = {ci, v, aux};
+    tr_record *r;
+
+    if (tr_registry == NULL) {
+	return -1;
+    }
+
+    r = g_hash_table_lookup(tr_registry, &key);
+
+    if (r == NULL || r->gen != tr_generation || r->dset != dset) {
+	return -1;
+    } else if (r->n != dset->n || r->pd != dset->pd ||
+	       r->structure != dset->structure) {
+	return -1;
+    } else if (ci != LAGS && (r->t1 != dset->t1 || r->t2 != dset->t2)) {
+	/* other transforms are computed over the sample range only */
+	return -1;
+    } else if (!tr_series_unchanged(dset, v, r->x, r->stamp) ||
+	       !tr_series_unchanged(dset, r->targv, r->targ, r->stamp)) {
+	return -1;
+    } else if (ci == SQUARE && !tr_series_unchanged(dset, aux, r->y,
+						     r->stamp)) {
+	return -1;
+    } else if (strcmp(dset->varname[v], r->srcname) ||
+	       strcmp(dset->varname[r->targv], r->vname)) {
+	return -1;
+    } else if (series_get_stack_level(dset, r->targv) !=
+	       gretl_function_depth()) {
+	return -1;
+    }
+
+#if TRDEBUG
+    fprintf(stderr, "tr_registry_lookup: reusing var %d (%s)\n",
+	    r->targv, r->vname);
+#endif
+
+    return r->targv;
+}
+
+static void tr_registry_add (int ci, int v, int aux, int targv,
+			     const DATASET *dset)
+{
+    tr_record *r;
+
+    if (tr_registry == NULL) {
+	tr_registry = g_hash_table_new_full(tr_key_hash, tr_key_equal,
+					    NULL, free);
+	if (tr_registry == NULL) {
+	    return;
+	}
+    }
+
+    r = malloc(sizeof *r);
+    if (r == NULL) {
+	return;
+    }
+
+    r->key.ci = ci;
+    r->key.v = v;
+    r->key.aux = aux;
+    r->targv = targv;
+    strcpy(r->vname, dset->varname[targv]);
+    strcpy(r->srcname, dset->varname[v]);
+    r->dset = dset;
+    r->x = dset->Z[v];
+    r->y = (ci == SQUARE)? dset->Z[aux] : NULL;
+    r->targ = dset->Z[targv];
+    r->n = dset->n;
+    r->pd = dset->pd;
+    r->structure = dset->structure;
+    r->t1 = dset->t1;
+    r->t2 = dset->t2;
+    r->gen = tr_generation;
+    r->stamp = gretl_monotonic_time();
+
+    /* note: the key lives inside the record, so we must use
+       "replace" rather than "insert" here */
+    g_hash_table_replace(tr_registry, &r->key, r);
+}
+
+static gboolean tr_targets_series (gpointer key, gpointer value,
+				   gpointer data)
+{
+    tr_record *r = value;
+
+    return r->targv == GPOINTER_TO_INT(data);
+}
+
+/* called when the values of an existing generated series are
+   being overwritten: drop any records that point to it */
+
+static void tr_registry_forget_target (int v)
+{
+    if (tr_registry != NULL) {
+	g_hash_table_foreach_remove(tr_registry, tr_targets_series,
+				    GINT_TO_POINTER(v));
+    }
+}
+
+/**
+ * gretl_transforms_invalidate:
+ *
+ * Marks as out of date all records of previously generated
+ * transformations (lags, logs, differences, squares) of series
+ * in the dataset. Should be called when series values may have
+ * been modified by some means that does not update their
+ * modification time, or when series have been deleted.
+ */
+
+void gretl_transforms_invalidate (void)
+{
+    tr_generation++;
+}
+
 /**
  * gretl_transforms_cleanup:
  *
@@ -330,6 +527,11 @@ static double *testvec (int n)
 void gretl_transforms_cleanup (void)
 {
     testvec(0);
+
+    if (tr_registry != NULL) {
+	g_hash_table_destroy(tr_registry);
+	tr_registry = NULL;
+    }
 }
 
 /* write lagged values of variable v into xlag */
@@ -617,6 +819,7 @@ static int transform_handle_duplicate (int ci, int lag, int v,
 	series_set_transform(dset, v, ci);
 	series_set_lag(dset, v, lag);
 	series_zero_flags(dset, v);
+	tr_registry_forget_target(v);
 	ret = VAR_EXISTS_OK;
     }	
 
@@ -652,6 +855,7 @@ check_add_transform (int ci, int lag, int vnum, const double *x,
 	    for (t=0; t<dset->n; t++) {
 		dset->Z[vnum][t] = x[t];
 	    }
+	    tr_registry_forget_target(vnum);
 	    ret = VAR_EXISTS_OK;
 	} else {
 	    ret = transform_handle_duplicate(ci, lag, vnum, x, label, dset,
@@ -713,6 +917,13 @@ static int get_transform (int ci, int v, int aux, double x,
     const char *srcname;
     double *vx;
 
+    if (tr_registered_type(ci)) {
+	vno = tr_registry_lookup(ci, v, aux, dset);
+	if (vno > 0) {
+	    return vno;
+	}
+    }
+
     vx = testvec(dset->n);
     if (vx == NULL) {
 	return -1;
@@ -748,6 +959,8 @@ static int get_transform (int ci, int v, int aux, double x,
 	err = check_add_transform(ci, lag, vno, vx, vname, label, dset, origv);
 	if (err != VAR_EXISTS_OK) {
 	    vno = -1;
+	} else {
+	    tr_registry_add(ci, v, aux, vno, dset);
 	}
 	return vno;
     }
@@ -814,6 +1027,11 @@ static int get_transform (int ci, int v, int aux, double x,
 	}
     }
 
+    if (vno > 0 && (err == VAR_ADDED_OK || err == VAR_EXISTS_OK) &&
+	tr_registered_type(ci)) {
+	tr_registry_add(ci, v, aux, vno, dset);
+    }
+
     return vno;
 }
 
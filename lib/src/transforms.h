@@ -64,6 +64,8 @@ int list_makediscrete (const int *list, DATASET *dset, gretlopt opt);
 
 int hf_list_diffgenr (int *list, int ci, double parm, DATASET *dset);
 
+void gretl_transforms_invalidate (void);
+
 void gretl_transforms_cleanup (void);
 
 #endif /* TRANSFORMS_H */
@@ -523,6 +523,102 @@ gretl_matrix *matrix_get_submatrix (const gretl_matrix *M,
     return S;
 }
 
+/* If @slice (a gretl list of 1-based indices, or NULL for "all
+   of @n") is a run of consecutive values, return its length
+   and write its 0-based starting point into @start; otherwise
+   return 0.
+*/
+
+static int slice_is_consecutive (const int *slice, int n, int *start)
+{
+    int i;
+
+    if (slice == NULL) {
+	*start = 0;
+	return n;
+    }
+
+    for (i=2; i<=slice[0]; i++) {
+	if (slice[i] != slice[1] + i - 1) {
+	    return 0;
+	}
+    }
+
+    *start = slice[1] - 1;
+
+    return slice[0];
+}
+
+/**
+ * matrix_get_submatrix_view:
+ * @M: source matrix.
+ * @spec: submatrix specification.
+ * @V: matrix "shell" to be filled out.
+ *
+ * Checks whether the selection from @M given by @spec is a
+ * contiguous proper sub-block of @M's data -- that is, a range
+ * of complete columns, or a range of rows within a single
+ * column -- and if so sets up @V as a view onto that portion
+ * of @M, without copying. @V does not own its data: it must
+ * be treated as read-only, it must not be freed via
+ * gretl_matrix_free(), and it becomes invalid if @M is
+ * modified or freed.
+ *
+ * Returns: 1 if @V was set up as a view, otherwise 0, in which
+ * case matrix_get_submatrix() should be used (any error in
+ * @spec is left to be reported by that function).
+ */
+
+int matrix_get_submatrix_view (const gretl_matrix *M,
+			       matrix_subspec *spec,
+			       gretl_matrix *V)
+{
+    int r0 = 0, c0 = 0;
+    int r, c;
+
+    if (gretl_is_null_matrix(M) || spec == NULL ||
+	gretl_matrix_is_dated(M)) {
+	/* a copy would carry the dating info */
+	return 0;
+    }
+
+    if (check_matrix_subspec(spec, M)) {
+	return 0;
+    }
+
+    if (spec->type[0] == SEL_DIAG || spec->type[0] == SEL_ELEMENT) {
+	return 0;
+    }
+
+    if (spec->rslice == NULL && spec->cslice == NULL) {
+	if (get_slices(spec, M)) {
+	    /* don't leave a partial specification behind */
+	    free(spec->rslice);
+	    free(spec->cslice);
+	    spec->rslice = spec->cslice = NULL;
+	    return 0;
+	}
+    }
+
+    r = slice_is_consecutive(spec->rslice, M->rows, &r0);
+    c = slice_is_consecutive(spec->cslice, M->cols, &c0);
+
+    if (r == 0 || c == 0 || (r == M->rows && c == M->cols)) {
+	/* not contiguous, or not a proper sub-block */
+	return 0;
+    } else if (r < M->rows && c > 1) {
+	/* a partial row range is contiguous only within one column */
+	return 0;
+    }
+
+    V->rows = r;
+    V->cols = c;
+    V->val = M->val + c0 * M->rows + r0;
+    V->info = NULL;
+
+    return 1;
+}
+
 double matrix_get_element (const gretl_matrix *M, int i, int j,
 			   int *err)
 {
@@ -1105,7 +1201,7 @@ static int revise_SVD_V (gretl_matrix **pV, int r, int c)
 gretl_matrix *user_matrix_SVD (const gretl_matrix *m, 
 			       const char *uname, 
 			       const char *vname, 
-			       int *err)
+			       int k, int *err)
 {
     gretl_matrix *U = NULL;
     gretl_matrix *S = NULL;
@@ -1136,6 +1232,22 @@ gretl_matrix *user_matrix_SVD (const gretl_matrix *m,
 	}
     }
 
+    if (!*err && k < 0) {
+	*err = E_INVARG;
+    }
+
+    if (!*err && k > 0 && k < m->rows && k < m->cols) {
+	/* truncated decomposition */
+	S = gretl_matrix_rsvd(m, k, pU, pV, err);
+	if (!*err && U != NULL) {
+	    user_matrix_replace_matrix_by_name(uname, U);
+	}
+	if (!*err && V != NULL) {
+	    user_matrix_replace_matrix_by_name(vname, V);
+	}
+	return S;
+    }
+
     if (!*err) {
 	*err = gretl_matrix_SVD(m, pU, &S, pV);
     }
@@ -1453,7 +1565,7 @@ static void maybe_eigen_trim (gretl_matrix *E)
 
 gretl_matrix *
 user_matrix_eigen_analysis (const gretl_matrix *m, const char *rname, int symm,
-			    int *err)
+			    int k, int *err)
 {
     gretl_matrix *C = NULL;
     gretl_matrix *E = NULL;
@@ -1478,6 +1590,19 @@ user_matrix_eigen_analysis (const gretl_matrix *m, const char *rname, int symm,
 	}
     }
 
+    if (k < 0) {
+	*err = E_INVARG;
+	return NULL;
+    } else if (symm && k > 0 && k < m->rows) {
+	/* only the @k largest eigenvalues wanted */
+	E = gretl_symmetric_matrix_eigenvals_partial(m, k, vecs ? &C : NULL,
+						     err);
+	if (!*err && vecs) {
+	    user_matrix_replace_matrix_by_name(rname, C);
+	}
+	return E;
+    }
+
     C = gretl_matrix_copy(m);
     if (C == NULL) {
 	*err = E_ALLOC;
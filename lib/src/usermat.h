@@ -109,7 +109,7 @@ user_matrix_QR_decomp (const gretl_matrix *m, const char *rname,
 gretl_matrix *user_matrix_SVD (const gretl_matrix *m, 
 			       const char *uname, 
 			       const char *vname, 
-			       int *err);
+			       int k, int *err);
 
 gretl_matrix *user_matrix_ols (const gretl_matrix *Y, 
 			       const gretl_matrix *X, 
@@ -135,7 +135,7 @@ gretl_matrix *user_matrix_GHK (const gretl_matrix *C,
 
 gretl_matrix *
 user_matrix_eigen_analysis (const gretl_matrix *m, const char *rname, int symm,
-			    int *err);
+			    int k, int *err);
 
 gretl_matrix *user_gensymm_eigenvals (const gretl_matrix *A, 
 				      const gretl_matrix *B,
@@ -152,6 +152,10 @@ gretl_matrix *matrix_get_submatrix (const gretl_matrix *M,
 				    int prechecked,
 				    int *err);
 
+int matrix_get_submatrix_view (const gretl_matrix *M,
+			       matrix_subspec *spec,
+			       gretl_matrix *V);
+
 gretl_matrix *user_matrix_get_submatrix (const char *name, 
 					 matrix_subspec *spec,
 					 int *err);
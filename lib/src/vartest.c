@@ -331,6 +331,232 @@ static int lagsel_get_min_lag (int p, int *err)
     return m;
 }
 
+#define lag_wanted(v, i) (v->lags == NULL || in_gretl_list(v->lags, i))
+
+/* the number of lags of the endogenous variables, up to and
+   including lag @j, that are included in @var */
+
+static int lagsel_n_lags (const GRETL_VAR *var, int j)
+{
+    int i, nl = 0;
+
+    for (i=1; i<=j; i++) {
+	if (lag_wanted(var, i)) {
+	    nl++;
+	}
+    }
+
+    return nl;
+}
+
+/* Lag selection via re-estimation of the VAR at each order
+   j < p: write the log-determinant of the residual covariance
+   matrix into @ldet[j - @minlag] and the number of regressors
+   per equation into @q[j - @minlag]. This is the fallback if
+   the method below is not applicable.
+*/
+
+static int lagsel_ldets_via_ols (GRETL_VAR *var, const DATASET *dset,
+				 int minlag, double *ldet, int *q)
+{
+    gretl_matrix *E;
+    int p = var->order;
+    int T = var->T;
+    int n = var->neqns;
+    int nlp = lagsel_n_lags(var, p);
+    int j, use_QR = 0;
+    int err = 0;
+
+    E = gretl_matrix_alloc(T, n);
+    if (E == NULL) {
+	return E_ALLOC;
+    }
+
+    if (getenv("VAR_USE_QR") != NULL) {
+	use_QR = 1;
+    }
+
+    for (j=minlag; j<p && !err; j++) {
+	int jxcols = var->ncoeff - n * (nlp - lagsel_n_lags(var, j));
+
+	if (jxcols == 0) {
+	    gretl_matrix_copy_values(E, var->Y);
+	} else {
+	    VAR_fill_X(var, j, dset);
+
+	    gretl_matrix_reuse(var->X, T, jxcols);
+	    gretl_matrix_reuse(var->B, jxcols, n);
+
+	    if (use_QR) {
+		err = gretl_matrix_QR_ols(var->Y, var->X, var->B, 
+					  E, NULL, NULL);
+	    } else {
+		err = gretl_matrix_multi_ols(var->Y, var->X, var->B, 
+					     E, NULL);
+	    }
+	}
+
+	if (!err) {
+	    ldet[j - minlag] = gretl_VAR_ldet(var, E, &err);
+	    q[j - minlag] = jxcols;
+	}
+    }
+
+    gretl_matrix_free(E);
+
+    return err;
+}
+
+/* Lag selection without re-estimation. Arrange the columns of
+   the full-order regressor matrix X so that the terms other than
+   lags of the endogenous variables come first, followed by all
+   first lags, all second lags and so on. The regressors for order
+   j are then the leading k_j columns. Given the Cholesky factor L
+   of Z'Z, where Z = [X Y], the residual sum of squares and
+   cross-products from the regression of Y on the first k_j columns
+   of X is the sum over columns i >= k_j of L_{yi} L_{yi}', where
+   L_{yi} is the Y part of column i of L. So one factorization
+   yields the residual covariance matrices for all orders.
+*/
+
+static int lagsel_ldets_via_cholesky (GRETL_VAR *var, int minlag,
+				      double *ldet, int *q)
+{
+    gretl_matrix *XX = NULL, *XY = NULL;
+    gretl_matrix *M = NULL, *S = NULL;
+    gretl_matrix *Sj = NULL;
+    int *lag = NULL, *perm = NULL;
+    int p = var->order;
+    int n = var->neqns;
+    int K = var->ncoeff;
+    int nz = K + n;
+    int i, j, k, ii, jj;
+    double x;
+    int err = 0;
+
+    lag = malloc(K * sizeof *lag);
+    perm = malloc(K * sizeof *perm);
+    XX = gretl_matrix_alloc(K, K);
+    XY = gretl_matrix_alloc(K, n);
+    M = gretl_matrix_alloc(nz, nz);
+    S = gretl_zero_matrix_new(n, n);
+    Sj = gretl_matrix_alloc(n, n);
+
+    if (lag == NULL || perm == NULL || XX == NULL || XY == NULL ||
+	M == NULL || S == NULL || Sj == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    /* the lag order of each column of X, as written by
+       VAR_fill_X(), with 0 for terms that are not lags */
+    k = 0;
+    if (var->detflags & DET_CONST) {
+	lag[k++] = 0;
+    }
+    for (i=0; i<n; i++) {
+	for (j=1; j<=p; j++) {
+	    if (lag_wanted(var, j)) {
+		lag[k++] = j;
+	    }
+	}
+    }
+    while (k < K) {
+	lag[k++] = 0;
+    }
+
+    /* order the columns by lag */
+    k = 0;
+    for (j=0; j<=p; j++) {
+	for (i=0; i<K; i++) {
+	    if (lag[i] == j) {
+		perm[k++] = i;
+	    }
+	}
+    }
+
+    /* form Z'Z with X permuted */
+    gretl_matrix_multiply_mod(var->X, GRETL_MOD_TRANSPOSE,
+			      var->X, GRETL_MOD_NONE,
+			      XX, GRETL_MOD_NONE);
+    gretl_matrix_multiply_mod(var->X, GRETL_MOD_TRANSPOSE,
+			      var->Y, GRETL_MOD_NONE,
+			      XY, GRETL_MOD_NONE);
+    for (j=0; j<K; j++) {
+	jj = perm[j];
+	for (i=j; i<K; i++) {
+	    ii = perm[i];
+	    x = gretl_matrix_get(XX, ii, jj);
+	    gretl_matrix_set(M, i, j, x);
+	    gretl_matrix_set(M, j, i, x);
+	}
+	for (i=0; i<n; i++) {
+	    x = gretl_matrix_get(XY, jj, i);
+	    gretl_matrix_set(M, K + i, j, x);
+	    gretl_matrix_set(M, j, K + i, x);
+	}
+    }
+    for (j=0; j<n; j++) {
+	for (i=j; i<n; i++) {
+	    x = 0.0;
+	    for (k=0; k<var->T; k++) {
+		x += gretl_matrix_get(var->Y, k, i) *
+		    gretl_matrix_get(var->Y, k, j);
+	    }
+	    gretl_matrix_set(M, K + i, K + j, x);
+	    gretl_matrix_set(M, K + j, K + i, x);
+	}
+    }
+
+    err = gretl_matrix_cholesky_decomp(M);
+    if (err) {
+	/* not positive definite: let the caller fall back */
+	goto bailout;
+    }
+
+    /* Accumulate S = E_j'E_j working down from the full order,
+       starting with the columns belonging to Y itself */
+    k = nz;
+    for (j=p; j>=minlag && !err; j--) {
+	int kj = 0;
+
+	while (kj < K && lag[perm[kj]] <= j) {
+	    kj++;
+	}
+	while (k > kj) {
+	    k--;
+	    for (jj=0; jj<n; jj++) {
+		double lj = gretl_matrix_get(M, K + jj, k);
+
+		for (ii=jj; ii<n; ii++) {
+		    x = gretl_matrix_get(S, ii, jj);
+		    x += gretl_matrix_get(M, K + ii, k) * lj;
+		    gretl_matrix_set(S, ii, jj, x);
+		    gretl_matrix_set(S, jj, ii, x);
+		}
+	    }
+	}
+	if (j < p) {
+	    gretl_matrix_copy_values(Sj, S);
+	    gretl_matrix_divide_by_scalar(Sj, var->T);
+	    ldet[j - minlag] = gretl_vcv_log_determinant(Sj, &err);
+	    q[j - minlag] = kj;
+	}
+    }
+
+ bailout:
+
+    free(lag);
+    free(perm);
+    gretl_matrix_free(XX);
+    gretl_matrix_free(XY);
+    gretl_matrix_free(M);
+    gretl_matrix_free(S);
+    gretl_matrix_free(Sj);
+
+    return err;
+}
+
 /* apparatus for selecting the optimal lag length for a VAR */
 
 int VAR_do_lagsel (GRETL_VAR *var, const DATASET *dset, 
@@ -338,7 +564,8 @@ int VAR_do_lagsel (GRETL_VAR *var, const DATASET *dset,
 {
     gretl_matrix *crittab = NULL;
     gretl_matrix *lltab = NULL;
-    gretl_matrix *E = NULL;
+    double *ldet = NULL;
+    int *q = NULL;
     int p = var->order;
     int r = p - 1;
     int T = var->T;
@@ -348,15 +575,11 @@ int VAR_do_lagsel (GRETL_VAR *var, const DATASET *dset,
     int best_row[N_IVALS] = { r, r, r };
     double crit[N_IVALS];
     double LRtest;
-    double ldet = NADBL;
-    int cols0, minlag = 1;
-    int nrows, use_QR = 0;
+    int minlag = 1;
+    int nrows;
     int j, m = 0;
     int err = 0;
 
-    /* number of cols in X that are not Y lags */
-    cols0 = var->ncoeff - p * n;
-
     if (opt & OPT_M) {
 	minlag = lagsel_get_min_lag(p, &err);
     }
@@ -365,76 +588,50 @@ int VAR_do_lagsel (GRETL_VAR *var, const DATASET *dset,
 	return 0;
     }
 
-    E = gretl_matrix_alloc(T, n);
-    if (E == NULL) {
-	return E_ALLOC;
-    }
-
     nrows = p - minlag + 1;
     crittab = gretl_matrix_alloc(nrows, N_IVALS);
     lltab = gretl_matrix_alloc(nrows, 2);
+    ldet = malloc(nrows * sizeof *ldet);
+    q = malloc(nrows * sizeof *q);
 
-    if (crittab == NULL || lltab == NULL) {
+    if (crittab == NULL || lltab == NULL || ldet == NULL || q == NULL) {
 	err = E_ALLOC;
 	goto bailout;
     }
 
-    if (getenv("VAR_USE_QR") != NULL) {
-	use_QR = 1;
+    if (getenv("VAR_USE_QR") != NULL || libset_get_bool(USE_SVD) ||
+	lagsel_ldets_via_cholesky(var, minlag, ldet, q)) {
+	/* the user wants a specific OLS method, or the Cholesky
+	   variant failed */
+	err = lagsel_ldets_via_ols(var, dset, minlag, ldet, q);
     }
 
     for (j=minlag; j<p && !err; j++) {
-	int jxcols = cols0 + j * n;
-
-	if (jxcols == 0) {
-	    gretl_matrix_copy_values(E, var->Y);
-	} else {
-	    VAR_fill_X(var, j, dset);
-
-	    gretl_matrix_reuse(var->X, T, jxcols);
-	    gretl_matrix_reuse(var->B, jxcols, n);
-
-	    if (use_QR) {
-		err = gretl_matrix_QR_ols(var->Y, var->X, var->B, 
-					  E, NULL, NULL);
-	    } else {
-		err = gretl_matrix_multi_ols(var->Y, var->X, var->B, 
-					     E, NULL);
-	    }
-	}
+	double ll;
+	int c, k = n * q[m];
 
-	if (!err) {
-	    ldet = gretl_VAR_ldet(var, E, &err);
-	}
+	ll = -(n * T / 2.0) * (LN_2_PI + 1) - (T / 2.0) * ldet[m];
+	crit[0] = (-2.0 * ll + 2.0 * k) / T;               /* AIC */
+	crit[1] = (-2.0 * ll + k * log(T)) / T;            /* BIC */
+	crit[2] = (-2.0 * ll + 2.0 * k * log(log(T))) / T; /* HQC */
 
-	if (!err) {
-	    double ll;
-	    int q = var->ncoeff - (n * (p - j));
-	    int c, k = n * q;
-
-	    ll = -(n * T / 2.0) * (LN_2_PI + 1) - (T / 2.0) * ldet;
-	    crit[0] = (-2.0 * ll + 2.0 * k) / T;               /* AIC */
-	    crit[1] = (-2.0 * ll + k * log(T)) / T;            /* BIC */
-	    crit[2] = (-2.0 * ll + 2.0 * k * log(log(T))) / T; /* HQC */
-
-	    gretl_matrix_set(lltab, m, 0, ll);
-	    if (j == minlag) {
-		gretl_matrix_set(lltab, m, 1, 0);
-	    } else {
-		LRtest = 2.0 * (ll - gretl_matrix_get(lltab, m-1, 0));
-		gretl_matrix_set(lltab, m, 1, chisq_cdf_comp(n * n, LRtest));
-	    }	
+	gretl_matrix_set(lltab, m, 0, ll);
+	if (j == minlag) {
+	    gretl_matrix_set(lltab, m, 1, 0);
+	} else {
+	    LRtest = 2.0 * (ll - gretl_matrix_get(lltab, m-1, 0));
+	    gretl_matrix_set(lltab, m, 1, chisq_cdf_comp(n * n, LRtest));
+	}	
 	    
-	    for (c=0; c<N_IVALS; c++) {
-		gretl_matrix_set(crittab, m, c, crit[c]);
-		if (crit[c] < best[c]) {
-		    best[c] = crit[c];
-		    best_row[c] = m;
-		}
+	for (c=0; c<N_IVALS; c++) {
+	    gretl_matrix_set(crittab, m, c, crit[c]);
+	    if (crit[c] < best[c]) {
+		best[c] = crit[c];
+		best_row[c] = m;
 	    }
-	
-	    m++; /* increment table row */
 	}
+	
+	m++; /* increment table row */
     }
 
     if (!err) {
@@ -455,7 +652,8 @@ int VAR_do_lagsel (GRETL_VAR *var, const DATASET *dset,
 
     gretl_matrix_free(crittab);
     gretl_matrix_free(lltab);
-    gretl_matrix_free(E);
+    free(ldet);
+    free(q);
 
     return err;
 }
@@ -989,7 +1187,6 @@ int gretl_VAR_wald_omit_test (GRETL_VAR *var, const int *omitlist,
 {
     gretl_matrix *B = NULL;
     gretl_matrix *S = NULL;
-    gretl_matrix *V = NULL;
     gretl_matrix *R = NULL;
     gretl_matrix *RB = NULL;
     gretl_matrix *RVR = NULL;
@@ -1047,11 +1244,6 @@ int gretl_VAR_wald_omit_test (GRETL_VAR *var, const int *omitlist,
 	gretl_matrix_set(S, i, i, x);
     }
 
-    V = gretl_matrix_kronecker_product_new(S, var->XTX, &err);
-    if (err) {
-	goto bailout;
-    }
-
     eqk = var->B->rows;
     pos = var->ifc + neq * var->order;
     row0 = 0;
@@ -1088,9 +1280,12 @@ int gretl_VAR_wald_omit_test (GRETL_VAR *var, const int *omitlist,
     }
 
     gretl_matrix_multiply(R, B, RB);
-    gretl_matrix_qform(R, GRETL_MOD_NONE, V,
-		       RVR, GRETL_MOD_NONE);
-    err = gretl_invert_symmetric_matrix(RVR);
+    /* R (S \otimes XTX) R', without forming the Kronecker product */
+    err = gretl_matrix_kronecker_qform(R, GRETL_MOD_NONE, S, var->XTX,
+				       RVR);
+    if (!err) {
+	err = gretl_invert_symmetric_matrix(RVR);
+    }
 
     if (!err) {
 	test = gretl_scalar_qform(RB, RVR, &err);
@@ -1114,7 +1309,6 @@ int gretl_VAR_wald_omit_test (GRETL_VAR *var, const int *omitlist,
 
     gretl_matrix_free(B);
     gretl_matrix_free(S);
-    gretl_matrix_free(V);
     gretl_matrix_free(R);
     gretl_matrix_free(RB);
     gretl_matrix_free(RVR);
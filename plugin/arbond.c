@@ -20,6 +20,8 @@
 #include "libgretl.h"
 #include "version.h"
 #include "matrix_extra.h"
+#include "gretl_sparse.h"
+#include "libset.h"
 
 #define ADEBUG 0
 #define WRITE_MATRICES 0
@@ -108,7 +110,8 @@ struct ddset_ {
     gretl_matrix *A;      /* \sum Z'_i H Z_i */
     gretl_matrix *Acpy;   /* back-up of A matrix */
     gretl_matrix *V;      /* covariance matrix */
-    gretl_matrix *ZT;     /* transpose of full instrument matrix */
+    gretl_sparse *ZT;     /* transpose of full instrument matrix */
+    int zcap;             /* allocated storage for non-zeros in ZT */
     gretl_matrix *Zi;     /* per-unit instrument matrix */
     gretl_matrix *Y;      /* transformed dependent var */
     gretl_matrix *X;      /* lagged differences of y, indep vars, etc. */
@@ -155,6 +158,7 @@ static void ddset_free (ddset *dpd)
     gretl_matrix_block_destroy(dpd->B2);
 
     gretl_matrix_free(dpd->V);
+    gretl_sparse_free(dpd->ZT);
 
     free(dpd->xlist);
     free(dpd->ilist);
@@ -174,7 +178,6 @@ static int dpd_allocate_matrices (ddset *dpd)
     dpd->B1 = gretl_matrix_block_new(&dpd->beta,  dpd->k, 1,
 				     &dpd->vbeta, dpd->k, dpd->k,
 				     &dpd->uhat,  dpd->totobs, 1,
-				     &dpd->ZT,    dpd->nz, dpd->totobs,
 				     &dpd->H,     T, T,
 				     &dpd->A,     dpd->nz, dpd->nz,
 				     &dpd->Acpy,  dpd->nz, dpd->nz,
@@ -197,11 +200,307 @@ static int dpd_allocate_matrices (ddset *dpd)
 
     if (dpd->B2 == NULL) {
 	return E_ALLOC;
-    }    
+    }
+
+    /* The instrument matrix is mostly zeros, since GMM-style
+       instruments are specific to a single period: we store only
+       the non-zero elements, starting from a guess at how many
+       there will be per observation.
+    */
+    dpd->zcap = dpd->nzr + dpd->ndum + 8;
+    if (dpd->zcap > dpd->nz) {
+	dpd->zcap = dpd->nz;
+    }
+    dpd->zcap *= dpd->totobs;
+
+    dpd->ZT = gretl_sparse_new(dpd->nz, dpd->totobs, dpd->zcap);
+    if (dpd->ZT == NULL) {
+	return E_ALLOC;
+    }
+    dpd->ZT->nnz = 0;
+
+    return 0;
+}
+
+/* Append to ZT, as column @s, the non-zero elements among the
+   dpd->nz instrument values at @z, which are @stride apart.
+   Columns must be appended in order.
+*/
+
+static int zt_append_column (ddset *dpd, int s, const double *z,
+			     int stride)
+{
+    gretl_sparse *ZT = dpd->ZT;
+    int i, k = ZT->nnz;
+    double x;
+
+    if (k + dpd->nz > dpd->zcap) {
+	int newcap = 2 * dpd->zcap;
+	int *ri;
+	double *v;
+
+	if (newcap < k + dpd->nz) {
+	    newcap = k + dpd->nz;
+	}
+	ri = realloc(ZT->rowidx, newcap * sizeof *ri);
+	if (ri == NULL) {
+	    return E_ALLOC;
+	}
+	ZT->rowidx = ri;
+	v = realloc(ZT->val, newcap * sizeof *v);
+	if (v == NULL) {
+	    return E_ALLOC;
+	}
+	ZT->val = v;
+	dpd->zcap = newcap;
+    }
+
+    ZT->colptr[s] = k;
+    for (i=0; i<dpd->nz; i++) {
+	x = z[i * stride];
+	if (x != 0.0) {
+	    ZT->rowidx[k] = i;
+	    ZT->val[k++] = x;
+	}
+    }
+    ZT->colptr[s+1] = ZT->nnz = k;
+
+    return 0;
+}
+
+/* Set the offsets for any columns of ZT beyond the last one
+   appended, @n - 1 */
+
+static void zt_complete (ddset *dpd, int n)
+{
+    int s;
+
+    for (s=n+1; s<=dpd->ZT->cols; s++) {
+	dpd->ZT->colptr[s] = dpd->ZT->nnz;
+    }
+}
+
+/* If ZT has rows (instruments) with no non-zero values,
+   return a mask identifying them, otherwise NULL */
+
+static char *zt_zero_row_mask (const ddset *dpd, int *err)
+{
+    const gretl_sparse *ZT = dpd->ZT;
+    char *mask;
+    int i, p, any0 = 0;
+
+    mask = malloc(ZT->rows);
+    if (mask == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    memset(mask, 1, ZT->rows);
+    for (p=0; p<ZT->nnz; p++) {
+	mask[ZT->rowidx[p]] = 0;
+    }
+
+    for (i=0; i<ZT->rows && !any0; i++) {
+	any0 = mask[i];
+    }
+
+    if (!any0) {
+	free(mask);
+	mask = NULL;
+    }
+
+    return mask;
+}
+
+/* Write column @s of ZT into @targ, whose elements are @stride
+   apart, filling in the zeros */
+
+static void zt_get_column (const ddset *dpd, int s, double *targ,
+			   int stride)
+{
+    const gretl_sparse *ZT = dpd->ZT;
+    int i, p;
+
+    for (i=0; i<ZT->rows; i++) {
+	targ[i * stride] = 0.0;
+    }
+    for (p=ZT->colptr[s]; p<ZT->colptr[s+1]; p++) {
+	targ[ZT->rowidx[p] * stride] = ZT->val[p];
+    }
+}
+
+/* Add to @targ (of length nz) the product of columns @s0 to
+   @s0 + @n - 1 of ZT with the vector @u */
+
+static void zt_multiply_vec (const ddset *dpd, int s0, int n,
+			     const double *u, double *targ)
+{
+    const gretl_sparse *ZT = dpd->ZT;
+    int t, p;
+
+    for (t=0; t<n; t++) {
+	for (p=ZT->colptr[s0+t]; p<ZT->colptr[s0+t+1]; p++) {
+	    targ[ZT->rowidx[p]] += ZT->val[p] * u[t];
+	}
+    }
+}
+
+/* X'Z (k x nz) and Z'Y (nz x 1) from the sparse ZT */
+
+static void dpd_moment_matrices (ddset *dpd)
+{
+    const gretl_sparse *ZT = dpd->ZT;
+    int k = dpd->k;
+    int i, j, p, s;
+    double z;
+
+    gretl_matrix_zero(dpd->XZ);
+    gretl_sparse_multiply_dense(ZT, GRETL_MOD_NONE, dpd->Y, dpd->ZY);
+
+    for (s=0; s<ZT->cols; s++) {
+	for (p=ZT->colptr[s]; p<ZT->colptr[s+1]; p++) {
+	    i = ZT->rowidx[p];
+	    z = ZT->val[p];
+	    for (j=0; j<k; j++) {
+		dpd->XZ->val[i*k+j] += z * gretl_matrix_get(dpd->X, s, j);
+	    }
+	}
+    }
+}
+
+/* Non-zero elements of the per-unit H matrices, indexed by
+   observation (column of ZT): together these make up the
+   block-diagonal matrix H such that A = Z'HZ.
+*/
+
+typedef struct h_elem_ {
+    int s, u;
+    double h;
+} h_elem;
+
+typedef struct h_list_ {
+    h_elem *e;
+    int n;
+    int cap;
+} h_list;
+
+/* Add the non-zero elements of the @n x @n matrix @H to @hl,
+   where @map gives the column of ZT corresponding to each row
+   of @H, or -1 if the row is not used.
+*/
+
+static int h_list_add (h_list *hl, const gretl_matrix *H,
+		       const int *map, int n)
+{
+    double h;
+    int j, k;
+
+    for (j=0; j<n; j++) {
+	if (map[j] < 0) {
+	    continue;
+	}
+	for (k=0; k<n; k++) {
+	    h = gretl_matrix_get(H, j, k);
+	    if (h == 0.0 || map[k] < 0) {
+		continue;
+	    }
+	    if (hl->n == hl->cap) {
+		int newcap = hl->cap == 0 ? 1024 : 2 * hl->cap;
+		h_elem *e = realloc(hl->e, newcap * sizeof *e);
+
+		if (e == NULL) {
+		    return E_ALLOC;
+		}
+		hl->e = e;
+		hl->cap = newcap;
+	    }
+	    hl->e[hl->n].s = map[j];
+	    hl->e[hl->n].u = map[k];
+	    hl->e[hl->n].h = h;
+	    hl->n += 1;
+	}
+    }
 
     return 0;
 }
 
+/* Cumulate into columns @r0 to @r1 - 1 of the upper triangle
+   of @A the contributions h * z_s * z_u' for the elements of
+   @hl. Each element of A is updated by a single caller, in the
+   order of @hl, so the result does not depend on how the
+   columns are split up.
+*/
+
+static void dpd_A_columns (const gretl_sparse *ZT, const h_list *hl,
+			   gretl_matrix *A, int r0, int r1)
+{
+    const int *ci = ZT->colptr;
+    const int *ri = ZT->rowidx;
+    const double *v = ZT->val;
+    double x, *a;
+    int i, p, q, r;
+
+    for (i=0; i<hl->n; i++) {
+	int s = hl->e[i].s;
+	int u = hl->e[i].u;
+
+	for (p=ci[s]; p<ci[s+1] && ri[p] < r1; p++) {
+	    r = ri[p];
+	    if (r < r0) {
+		continue;
+	    }
+	    x = hl->e[i].h * v[p];
+	    a = A->val + r * A->rows;
+	    for (q=ci[u]; q<ci[u+1] && ri[q] <= r; q++) {
+		a[ri[q]] += x * v[q];
+	    }
+	}
+    }
+}
+
+#define A_BLOCKS 32
+
+/* Form A = \sum_i Z_i' H_i Z_i from ZT and the elements of the
+   H_i matrices, working only on non-zero elements. If OpenMP
+   is available the columns of A are divided among threads.
+*/
+
+static void dpd_make_A (ddset *dpd, const h_list *hl)
+{
+    int nz = dpd->nz;
+    int done = 0;
+
+    gretl_matrix_reuse(dpd->A, nz, nz);
+    gretl_matrix_zero(dpd->A);
+
+#if defined(_OPENMP)
+    if (nz >= 2 * A_BLOCKS &&
+	libset_use_openmp((guint64) hl->n * (dpd->ZT->nnz / dpd->totobs + 1))) {
+	int rb[A_BLOCKS + 1];
+	int b;
+
+	/* the work for column r of the upper triangle is roughly
+	   proportional to r, so set the block boundaries at nz
+	   times the square roots of equal fractions */
+	for (b=0; b<A_BLOCKS; b++) {
+	    rb[b] = (int) (nz * sqrt(b / (double) A_BLOCKS));
+	}
+	rb[A_BLOCKS] = nz;
+#pragma omp parallel for private(b) schedule(dynamic, 1)
+	for (b=0; b<A_BLOCKS; b++) {
+	    dpd_A_columns(dpd->ZT, hl, dpd->A, rb[b], rb[b+1]);
+	}
+	done = 1;
+    }
+#endif
+
+    if (!done) {
+	dpd_A_columns(dpd->ZT, hl, dpd->A, 0, nz);
+    }
+
+    gretl_matrix_mirror(dpd->A, 'U');
+}
+
 static int dpd_add_unit_info (ddset *dpd)
 {
     int i, err = 0;
@@ -278,6 +577,7 @@ static ddset *ddset_new (int ci, const int *list, const int *ylags,
     /* set pointer members to NULL just in case */
     dpd->B1 = dpd->B2 = NULL;
     dpd->V = NULL;
+    dpd->ZT = NULL;
     dpd->ui = NULL;
     dpd->used = NULL;
     dpd->xlist = NULL;
@@ -994,7 +1294,7 @@ static int dpd_sargan_test (ddset *dpd)
     save_cols = gretl_matrix_cols(dpd->L1);
 
     Zu = gretl_matrix_reuse(dpd->L1, dpd->nz, 1);
-    gretl_matrix_multiply(dpd->ZT, dpd->uhat, Zu);
+    gretl_sparse_multiply_dense(dpd->ZT, GRETL_MOD_NONE, dpd->uhat, Zu);
     gretl_matrix_divide_by_scalar(dpd->A, dpd->effN);
     dpd->sargan = gretl_scalar_qform(Zu, dpd->A, &err);
 
@@ -1017,11 +1317,19 @@ static int dpd_sargan_test (ddset *dpd)
 	    dpd->nz, dpd->k, dpd->sargan);
     if (1) {
 	/* try to replicate the xtabond2 'Sargan test' */ 
+	const gretl_sparse *ZT = dpd->ZT;
+	int p, q, t;
 	double sg;
 
-	gretl_matrix_multiply_mod(dpd->ZT, GRETL_MOD_NONE,
-				  dpd->ZT, GRETL_MOD_TRANSPOSE,
-				  dpd->Acpy, GRETL_MOD_NONE);
+	gretl_matrix_zero(dpd->Acpy);
+	for (t=0; t<ZT->cols; t++) {
+	    for (p=ZT->colptr[t]; p<ZT->colptr[t+1]; p++) {
+		for (q=ZT->colptr[t]; q<ZT->colptr[t+1]; q++) {
+		    dpd->Acpy->val[ZT->rowidx[q] * dpd->nz + ZT->rowidx[p]] +=
+			ZT->val[p] * ZT->val[q];
+		}
+	    }
+	}
 	gretl_matrix_multiply_by_scalar(dpd->Acpy, dpd->s2);
 	err = gretl_invert_symmetric_matrix(dpd->Acpy);
 	if (!err) {
@@ -1221,10 +1529,7 @@ static int dpd_ar_test (ddset *dpd)
 		    x = gretl_matrix_get(dpd->X, s, j);
 		    gretl_matrix_set(Xi, k, j, x);
 		}
-		for (j=0; j<nz; j++) {
-		    x = gretl_matrix_get(dpd->ZT, j, s);
-		    gretl_matrix_set(Zi, k, j, x);
-		}
+		zt_get_column(dpd, s, Zi->val + k, Ti);
 		k++;
 		s++;
 	    }
@@ -1267,14 +1572,10 @@ static int dpd_ar_test (ddset *dpd)
 	    gretl_matrix_multiply_mod(Zi, GRETL_MOD_TRANSPOSE,
 				      ui, GRETL_MOD_NONE,
 				      ZU, GRETL_MOD_NONE);
-	    for (t=0; t<unit->nlev; t++) {
-		/* catch the levels terms */
-		for (j=0; j<nz; j++) {
-		    x = gretl_matrix_get(dpd->ZT, j, s);
-		    ZU->val[j] += x * dpd->uhat->val[s];
-		}
-		s++;
-	    }
+	    /* catch the levels terms */
+	    zt_multiply_vec(dpd, s, unit->nlev, dpd->uhat->val + s,
+			    ZU->val);
+	    s += unit->nlev;
 	    gretl_matrix_multiply_by_scalar(ZU, uw);
 	    gretl_matrix_add_to(ZHw, ZU);
 	} else {
@@ -1377,8 +1678,7 @@ static int windmeijer_correct (ddset *dpd, const gretl_matrix *uhat1,
     gretl_matrix *dWj; /* one component of the above */
     gretl_matrix *ui;  /* per-unit residuals */
     gretl_matrix *xij; /* per-unit X_j values */
-    gretl_matrix *mT;  /* workspace follows */
-    gretl_matrix *km;  
+    gretl_matrix *km;  /* workspace follows */
     gretl_matrix *k1; 
     gretl_matrix *R1;
     gretl_matrix *Zui; 
@@ -1395,7 +1695,6 @@ static int windmeijer_correct (ddset *dpd, const gretl_matrix *uhat1,
 			       &dWj, dpd->nz, dpd->nz,
 			       &ui,  dpd->max_ni, 1,
 			       &xij, dpd->max_ni, 1,
-			       &mT,  dpd->nz, dpd->totobs,
 			       &km,  dpd->k, dpd->nz,
 			       &k1,  dpd->k, 1,
 			       &Zui, dpd->nz, 1,
@@ -1413,8 +1712,8 @@ static int windmeijer_correct (ddset *dpd, const gretl_matrix *uhat1,
     gretl_matrix_multiply_by_scalar(dpd->kmtmp, -1.0 / dpd->effN);
 
     /* form W^{-1}Z'v_2 */
-    gretl_matrix_multiply(dpd->A, dpd->ZT, mT);
-    gretl_matrix_multiply(mT, dpd->uhat, R1);
+    gretl_sparse_multiply_dense(dpd->ZT, GRETL_MOD_NONE, dpd->uhat, Zui);
+    gretl_matrix_multiply(dpd->A, Zui, R1);
 
     for (j=0; j<dpd->k; j++) { /* loop across the X's */
 	int s = 0;
@@ -1432,7 +1731,6 @@ static int windmeijer_correct (ddset *dpd, const gretl_matrix *uhat1,
 	
 	    gretl_matrix_reuse(ui, ni, 1);
 	    gretl_matrix_reuse(xij, ni, 1);
-	    gretl_matrix_reuse(dpd->Zi, ni, dpd->nz);
 
 	    /* extract ui (first-step residuals) */
 	    for (t=0; t<ni; t++) {
@@ -1443,17 +1741,11 @@ static int windmeijer_correct (ddset *dpd, const gretl_matrix *uhat1,
 	    gretl_matrix_extract_matrix(xij, dpd->X, s - ni, j,
 					GRETL_MOD_NONE);
 
-	    /* extract Zi */
-	    gretl_matrix_extract_matrix(dpd->Zi, dpd->ZT, 0, s - ni,
-					GRETL_MOD_TRANSPOSE);
-
-	    gretl_matrix_multiply_mod(dpd->Zi, GRETL_MOD_TRANSPOSE,
-				      ui, GRETL_MOD_NONE,
-				      Zui, GRETL_MOD_NONE);
-
-	    gretl_matrix_multiply_mod(xij, GRETL_MOD_TRANSPOSE,
-				      dpd->Zi, GRETL_MOD_NONE,
-				      Zxi, GRETL_MOD_NONE);
+	    /* form Z_i'u_i and x_ij'Z_i */
+	    gretl_matrix_zero(Zui);
+	    gretl_matrix_zero(Zxi);
+	    zt_multiply_vec(dpd, s - ni, ni, ui->val, Zui->val);
+	    zt_multiply_vec(dpd, s - ni, ni, xij->val, Zxi->val);
 
 	    gretl_matrix_multiply_mod(Zui, GRETL_MOD_NONE,
 				      Zxi, GRETL_MOD_NONE,
@@ -1571,21 +1863,18 @@ static int dpd_variance_1 (ddset *dpd)
 	    continue;
 	}
 
-	/* get per-unit instruments matrix, Zi */
-	gretl_matrix_reuse(dpd->Zi, ni, dpd->nz);
 	gretl_matrix_reuse(ui, ni, 1);
-	gretl_matrix_extract_matrix(dpd->Zi, dpd->ZT, 0, c,
-				    GRETL_MOD_TRANSPOSE);
-	c += ni;
-	
+
 	/* load residuals into the ui vector */
 	for (t=0; t<ni; t++) {
 	    ui->val[t] = dpd->uhat->val[k++];
 	}
 
-	gretl_matrix_multiply_mod(ui, GRETL_MOD_TRANSPOSE,
-				  dpd->Zi, GRETL_MOD_NONE,
-				  dpd->L1, GRETL_MOD_NONE);
+	/* L1 = u_i' Z_i */
+	gretl_matrix_zero(dpd->L1);
+	zt_multiply_vec(dpd, c, ni, ui->val, dpd->L1->val);
+	c += ni;
+
 	gretl_matrix_multiply_mod(dpd->L1, GRETL_MOD_TRANSPOSE,
 				  dpd->L1, GRETL_MOD_NONE,
 				  V, GRETL_MOD_CUMULATE);
@@ -1949,7 +2238,7 @@ static void dpd_shrink_matrices (ddset *dpd, const char *mask)
 	    (dpd->ci == DPANEL)? "dpanel" : "arbond", 
 	    dpd->nz, dpd->A->rows);
 
-    gretl_matrix_cut_rows(dpd->ZT, mask);
+    gretl_sparse_cut_rows(dpd->ZT, mask);
 
     dpd->nz = dpd->A->rows;
 
@@ -2234,27 +2523,29 @@ static int arbond_make_Z_and_A (ddset *dpd, const DATASET *dset)
     int s, t, t0;
     int zi, zj, zk;
     double x;
+    h_list hl = {NULL, 0, 0};
     int *rc = NULL;
+    int *map = NULL;
 #if ADEBUG
     char zstr[8];
 #endif
     int err = 0;
 
-    if (!(dpd->flags & DPD_ORTHDEV)) {
-	rc = malloc(dpd->T * sizeof *rc);
-	if (rc == NULL) {
-	    return E_ALLOC;
-	}
+    rc = malloc(dpd->T * sizeof *rc);
+    map = malloc(dpd->max_ni * sizeof *map);
+    if (rc == NULL || map == NULL) {
+	free(rc);
+	free(map);
+	return E_ALLOC;
     }
 
-    gretl_matrix_zero(dpd->A);
     gretl_matrix_zero(dpd->XZ);
     gretl_matrix_zero(dpd->ZY);
 
     /* t0 holds the obs index in the full dataset at the start
        of the data for unit i */
 
-    for (i=0; i<dpd->N; i++) {
+    for (i=0; i<dpd->N && !err; i++) {
 	unit_info *unit = &dpd->ui[i];
 	int ycols = dpd->p;   /* intial y block width */
 	int offj = 0;         /* initialize column offset */
@@ -2351,25 +2642,38 @@ static int arbond_make_Z_and_A (ddset *dpd, const DATASET *dset)
 	gretl_matrix_print(dpd->Zi, "Zi, arbond");
 #endif
 
-	/* Cumulate Z_i' H Z_i into A_N */
+	/* Store the non-zero elements of Zi as columns c to
+	   c + Ti - 1 of ZT, and those of H_i for cumulating
+	   Z_i' H_i Z_i into A_N below */
+	for (t=0; t<Ti && !err; t++) {
+	    map[t] = c + t;
+	    err = zt_append_column(dpd, c + t, dpd->Zi->val + t, Ti);
+	}
+	if (err) {
+	    break;
+	}
 	if (dpd->flags & DPD_ORTHDEV) {
 	    /* orthogonal deviations: "H" is identity matrix */
-	    gretl_matrix_multiply_mod(dpd->Zi, GRETL_MOD_TRANSPOSE,
-				      dpd->Zi, GRETL_MOD_NONE,
-				      dpd->A, GRETL_MOD_CUMULATE);
+	    gretl_matrix_reuse(dpd->H, Ti, Ti);
+	    gretl_matrix_zero(dpd->H);
+	    for (t=0; t<Ti; t++) {
+		gretl_matrix_set(dpd->H, t, t, 1.0);
+	    }
 	} else {
 	    arbond_H_matrix(dpd, rc, i, t0);
-	    gretl_matrix_qform(dpd->Zi, GRETL_MOD_TRANSPOSE,
-			       dpd->H, dpd->A, GRETL_MOD_CUMULATE);
 	}
-
-	/* Write Zi into ZT at offset 0, c */
-	gretl_matrix_inscribe_matrix(dpd->ZT, dpd->Zi, 0, c, 
-				     GRETL_MOD_TRANSPOSE);
+	err = h_list_add(&hl, dpd->H, map, Ti);
 	c += Ti;
     }
 
+    if (!err) {
+	zt_complete(dpd, c);
+	dpd_make_A(dpd, &hl);
+    }
+
     free(rc);
+    free(map);
+    free(hl.e);
 
 #if WRITE_MATRICES
     gretl_matrix_write_as_text(dpd->A, "arbond-bigA.mat", 0);
@@ -2377,7 +2681,7 @@ static int arbond_make_Z_and_A (ddset *dpd, const DATASET *dset)
 
     if (!err) {
 	/* mask zero rows of ZT, if required */
-	char *mask = gretl_matrix_zero_row_mask(dpd->ZT, &err);
+	char *mask = zt_zero_row_mask(dpd, &err);
 
 	if (mask != NULL) {
 	    err = gretl_matrix_cut_rows_cols(dpd->A, mask);
@@ -2397,14 +2701,9 @@ static int arbond_make_Z_and_A (ddset *dpd, const DATASET *dset)
     }
 
 #if ADEBUG
-    gretl_matrix_print(dpd->ZT, "ZT");
     gretl_matrix_print(dpd->A, "N^{-1} * \\sum Z_i' H Z_i");
 #endif
 
-#if WRITE_MATRICES
-    gretl_matrix_write_as_text(dpd->ZT, "arbondZT.mat", 0);
-#endif
-
     return err;
 }
 
@@ -2468,10 +2767,7 @@ static int dpd_step_1 (ddset *dpd)
 	/* construct additional moment matrices: we waited
 	   until we knew what size these should really be 
 	*/
-	gretl_matrix_multiply(dpd->ZT, dpd->Y, dpd->ZY);
-	gretl_matrix_multiply_mod(dpd->X, GRETL_MOD_TRANSPOSE,
-				  dpd->ZT, GRETL_MOD_TRANSPOSE,
-				  dpd->XZ, GRETL_MOD_NONE);
+	dpd_moment_matrices(dpd);
     }
 
 #if ADEBUG > 1
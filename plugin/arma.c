@@ -29,6 +29,12 @@
 #define ARMA_DEBUG 0
 #define ARMA_MDEBUG 0
 
+#if defined(_OPENMP) && !defined(OS_OSX)
+# define ARMA_MP 1
+#else
+# define ARMA_MP 0
+#endif
+
 #include "arma_common.c"
 
 #define KALMAN_ALL 999
@@ -77,13 +83,23 @@ static struct bchecker *bchecker_allocate (arma_info *ainfo)
     return b;
 }
 
+/* workspace for the MA roots check: this is per-thread, since
+   the automatic order search may run several conditional ML
+   estimations at once */
+
+static struct bchecker *bchk;
+
+#if ARMA_MP
+#pragma omp threadprivate(bchk)
+#endif
+
 /* check whether the MA estimates have gone out of bounds in the
    course of iteration */
 
 int ma_out_of_bounds (arma_info *ainfo, const double *theta,
 		      const double *Theta)
 {
-    static struct bchecker *b = NULL;
+    struct bchecker *b = bchk;
     double re, im, rt;
     int i, j, k, m, si, qtot;
     int tzero = 1, Tzero = 1;
@@ -92,7 +108,7 @@ int ma_out_of_bounds (arma_info *ainfo, const double *theta,
     if (ainfo == NULL) {
 	/* signal for cleanup */
 	bchecker_free(b);
-	b = NULL;
+	bchk = NULL;
 	return 0;
     }
 
@@ -116,8 +132,14 @@ int ma_out_of_bounds (arma_info *ainfo, const double *theta,
 	return 0;
     }
 
+    if (b != NULL && b->qmax != ainfo->q + ainfo->Q * ainfo->pd) {
+	/* left over from a different specification */
+	bchecker_free(b);
+	b = bchk = NULL;
+    }
+
     if (b == NULL) {
-	b = bchecker_allocate(ainfo);
+	b = bchk = bchecker_allocate(ainfo);
 	if (b == NULL) {
 	    return 1;
 	}
@@ -1623,12 +1645,20 @@ static int check_arma_options (gretlopt opt)
 	err = incompatible_options(opt, OPT_E | OPT_X);
     }      
 
+    if (!err) {
+	/* nor --auto with X-12-ARIMA */
+	err = incompatible_options(opt, OPT_A | OPT_X);
+    }
+
     return err;
 }
 
-MODEL arma_model (const int *list, const int *pqspec,
-		  const DATASET *dset, gretlopt opt, 
-		  PRN *prn)
+/* If @init is non-NULL it holds conditional ML estimates of
+   the specification in @list, to be used as starting values */
+
+static MODEL real_arma_model (const int *list, const int *pqspec,
+			      const DATASET *dset, gretlopt opt,
+			      const double *init, PRN *prn)
 {
     double *coeff = NULL;
     MODEL armod;
@@ -1714,8 +1744,14 @@ MODEL arma_model (const int *list, const int *pqspec,
 
     /* initialize the coefficients: there are 3 possible methods */
 
-    /* first pass: see if the user specified some values */
-    err = user_arma_init(coeff, ainfo, &init_done);
+    /* first pass: see if the user specified some values, or
+       we have estimates from the automatic order search */
+    if (init != NULL) {
+	cml_arma_init(coeff, init, ainfo);
+	init_done = 1;
+    } else {
+	err = user_arma_init(coeff, ainfo, &init_done);
+    }
     if (err) {
 	goto bailout;
     }
@@ -1769,3 +1805,889 @@ MODEL arma_model (const int *list, const int *pqspec,
 
     return armod;
 }
+
+/* Automatic ARIMA order selection. Given maximal orders p and q
+   (and P, Q for a seasonal specification) we estimate all the
+   nested specifications by conditional ML on a common sample,
+   holding the differencing orders fixed, and pick the one that
+   minimizes the chosen information criterion. Specifications are
+   visited in "waves" of equal total order, each one warm-started
+   from the estimates of a specification with one lag fewer; the
+   members of a wave are independent so they can be estimated in
+   parallel.
+*/
+
+enum {
+    CAND_PENDING,
+    CAND_DONE,
+    CAND_FAILED,
+    CAND_PRUNED
+};
+
+typedef struct arma_cand_ arma_cand;
+typedef struct arma_search_ arma_search;
+
+struct arma_cand_ {
+    int p, q, P, Q;  /* orders */
+    int k;           /* number of coefficients */
+    int status;      /* one of the CAND_* values above */
+    double ll;       /* conditional log-likelihood */
+    double crit;     /* value of information criterion */
+    double *b;       /* coefficient estimates */
+};
+
+struct arma_search_ {
+    DATASET sset;    /* shallow copy of dataset, common sample */
+    int *tail;       /* y plus regressors, for building lists */
+    int seasonal;    /* seasonal specification? */
+    int d, D;        /* (fixed) orders of differencing */
+    int pmax, qmax;  /* maximal non-seasonal orders */
+    int Pmax, Qmax;  /* maximal seasonal orders */
+    int ifc;         /* includes a constant? */
+    int nexo;        /* number of regressors */
+    int T;           /* number of observations */
+    int ic;          /* C_AIC, C_BIC or C_HQC */
+    double ll0;      /* loglikelihood of null model, if needed */
+    gretlopt opt;    /* options for candidate estimation */
+    int ncand;       /* number of candidates */
+    arma_cand *cand; /* array of candidates */
+    int best;        /* index of best candidate, or -1 */
+};
+
+static int arma_search_criterion (const char *s, int *err)
+{
+    if (s == NULL || *s == '\0' || !strcmp(s, "AIC")) {
+	return C_AIC;
+    } else if (!strcmp(s, "BIC")) {
+	return C_BIC;
+    } else if (!strcmp(s, "HQC")) {
+	return C_HQC;
+    } else {
+	gretl_errmsg_set(_("Invalid option"));
+	*err = E_DATA;
+	return C_AIC;
+    }
+}
+
+static const char *arma_search_critname (int ic)
+{
+    return ic == C_BIC ? "BIC" : ic == C_HQC ? "HQC" : "AIC";
+}
+
+/* as in mle_criteria(), the innovation variance is counted
+   as an additional parameter */
+
+static double arma_search_ic (const arma_search *S, double ll, int k)
+{
+    double n = S->T;
+
+    k++;
+
+    if (S->ic == C_BIC) {
+	return -2.0 * ll + k * log(n);
+    } else if (S->ic == C_HQC) {
+	return -2.0 * ll + 2 * k * log(log(n));
+    } else {
+	return -2.0 * ll + 2.0 * k;
+    }
+}
+
+static int arma_cand_index (const arma_search *S, int p, int q,
+			    int P, int Q)
+{
+    return ((p * (S->qmax + 1) + q) * (S->Pmax + 1) + P) *
+	(S->Qmax + 1) + Q;
+}
+
+static void arma_search_free (arma_search *S)
+{
+    int i;
+
+    if (S->cand != NULL) {
+	for (i=0; i<S->ncand; i++) {
+	    free(S->cand[i].b);
+	}
+	free(S->cand);
+    }
+
+    free(S->tail);
+}
+
+/* record the dependent variable and any regressors; when there
+   are regressors an explicit constant is needed, since otherwise
+   arma_check_list() will take it that there's no intercept
+*/
+
+static int arma_search_make_tail (arma_search *S, arma_info *ainfo)
+{
+    int n = 1 + ainfo->nexo;
+    int i, j = 1;
+
+    if (ainfo->nexo > 0 && ainfo->ifc) {
+	n++;
+    }
+
+    S->tail = gretl_list_new(n);
+    if (S->tail == NULL) {
+	return E_ALLOC;
+    }
+
+    S->tail[j++] = ainfo->yno;
+    if (ainfo->nexo > 0 && ainfo->ifc) {
+	S->tail[j++] = 0;
+    }
+    for (i=1; i<=ainfo->nexo; i++) {
+	S->tail[j++] = ainfo->xlist[i];
+    }
+
+    return 0;
+}
+
+/* loglikelihood for the specification with no coefficients
+   at all: (differenced) y is taken to be white noise */
+
+static double arma_null_ll (arma_info *ainfo)
+{
+    double s2 = 0.0;
+    int t;
+
+    for (t=ainfo->t1; t<=ainfo->t2; t++) {
+	s2 += ainfo->y[t] * ainfo->y[t];
+    }
+    s2 /= ainfo->T;
+
+    return -ainfo->T * (0.5 * log(s2) + LN_SQRT_2_PI + 0.5);
+}
+
+/* Parse the maximal specification given in @list, set the
+   sample range that all candidates will share (the one
+   appropriate for the maximal specification) and allocate
+   the grid of candidates.
+*/
+
+static int arma_search_init (arma_search *S, const int *list,
+			     const DATASET *dset, gretlopt opt,
+			     int ic)
+{
+    arma_info ainfo;
+    int p, q, P, Q;
+    int err = 0;
+
+    S->tail = NULL;
+    S->cand = NULL;
+    S->ncand = 0;
+    S->best = -1;
+    S->ll0 = NADBL;
+    S->ic = ic;
+    S->opt = opt & (OPT_N | OPT_Y);
+
+    arma_info_init(&ainfo, S->opt | OPT_C, NULL, dset);
+
+    ainfo.alist = gretl_list_copy(list);
+    if (ainfo.alist == NULL) {
+	err = E_ALLOC;
+    }
+
+    if (!err) {
+	err = arma_check_list(&ainfo, dset, S->opt);
+    }
+
+    if (!err) {
+	calc_max_lag(&ainfo);
+	err = arma_adjust_sample(&ainfo, dset, NULL, NULL);
+    }
+
+    if (!err) {
+	S->seasonal = arma_has_seasonal(&ainfo) ? 1 : 0;
+	S->d = ainfo.d;
+	S->D = ainfo.D;
+	S->pmax = ainfo.p;
+	S->qmax = ainfo.q;
+	S->Pmax = ainfo.P;
+	S->Qmax = ainfo.Q;
+	S->ifc = ainfo.ifc;
+	S->nexo = ainfo.nexo;
+	S->T = ainfo.T;
+	S->sset = *dset;
+	S->sset.t1 = ainfo.t1;
+	S->sset.t2 = ainfo.t2;
+	err = arma_search_make_tail(S, &ainfo);
+    }
+
+    if (!err && !S->ifc && !S->nexo) {
+	ainfo.y = (double *) dset->Z[ainfo.yno];
+	if (ainfo.d > 0 || ainfo.D > 0) {
+	    err = arima_difference(&ainfo, dset, 0);
+	}
+	if (!err) {
+	    S->ll0 = arma_null_ll(&ainfo);
+	}
+    }
+
+    if (!err) {
+	S->ncand = (S->pmax + 1) * (S->qmax + 1) *
+	    (S->Pmax + 1) * (S->Qmax + 1);
+	S->cand = malloc(S->ncand * sizeof *S->cand);
+	if (S->cand == NULL) {
+	    err = E_ALLOC;
+	}
+    }
+
+    if (!err) {
+	arma_cand *c = S->cand;
+
+	for (p=0; p<=S->pmax; p++) {
+	    for (q=0; q<=S->qmax; q++) {
+		for (P=0; P<=S->Pmax; P++) {
+		    for (Q=0; Q<=S->Qmax; Q++) {
+			c->p = p;
+			c->q = q;
+			c->P = P;
+			c->Q = Q;
+			c->k = S->ifc + S->nexo + p + q + P + Q;
+			c->status = CAND_PENDING;
+			c->ll = c->crit = NADBL;
+			c->b = NULL;
+			c++;
+		    }
+		}
+	    }
+	}
+    }
+
+    arma_info_cleanup(&ainfo);
+
+    if (err) {
+	arma_search_free(S);
+	S->tail = NULL;
+	S->cand = NULL;
+    }
+
+    return err;
+}
+
+/* compose an arima list for candidate @c */
+
+static int *arma_cand_list (const arma_search *S, const arma_cand *c)
+{
+    int n = (S->seasonal ? 8 : 4) + S->tail[0];
+    int *list = gretl_list_new(n);
+    int i, j = 1;
+
+    if (list != NULL) {
+	list[j++] = c->p;
+	list[j++] = S->d;
+	list[j++] = c->q;
+	list[j++] = LISTSEP;
+	if (S->seasonal) {
+	    list[j++] = c->P;
+	    list[j++] = S->D;
+	    list[j++] = c->Q;
+	    list[j++] = LISTSEP;
+	}
+	for (i=1; i<=S->tail[0]; i++) {
+	    list[j++] = S->tail[i];
+	}
+    }
+
+    return list;
+}
+
+/* find an already estimated specification with one lag fewer
+   than @c, for use as a starting point */
+
+static const arma_cand *arma_cand_parent (const arma_search *S,
+					  const arma_cand *c)
+{
+    const arma_cand *pc = NULL;
+    int i = -1;
+
+    if (c->Q > 0) {
+	i = arma_cand_index(S, c->p, c->q, c->P, c->Q - 1);
+	pc = S->cand[i].status == CAND_DONE ? &S->cand[i] : NULL;
+    }
+    if (pc == NULL && c->P > 0) {
+	i = arma_cand_index(S, c->p, c->q, c->P - 1, c->Q);
+	pc = S->cand[i].status == CAND_DONE ? &S->cand[i] : NULL;
+    }
+    if (pc == NULL && c->q > 0) {
+	i = arma_cand_index(S, c->p, c->q - 1, c->P, c->Q);
+	pc = S->cand[i].status == CAND_DONE ? &S->cand[i] : NULL;
+    }
+    if (pc == NULL && c->p > 0) {
+	i = arma_cand_index(S, c->p - 1, c->q, c->P, c->Q);
+	pc = S->cand[i].status == CAND_DONE ? &S->cand[i] : NULL;
+    }
+
+    return pc != NULL && pc->b != NULL ? pc : NULL;
+}
+
+static void cand_copy_block (double *b, int *ib, int nb,
+			     const double *a, int *ia, int an,
+			     double pad)
+{
+    int i;
+
+    for (i=0; i<nb; i++) {
+	b[*ib + i] = (i < an)? a[*ia + i] : pad;
+    }
+
+    *ib += nb;
+    *ia += an;
+}
+
+/* Starting values for candidate @c: transcribe the estimates
+   for @pc, if available, into the layout const, phi, Phi, theta,
+   Theta, beta, padding the extra lag with zero (or a small value
+   in the MA case, as in ar_arma_init). Otherwise start from the
+   mean of y.
+*/
+
+static void arma_cand_start (const arma_search *S, arma_cand *c,
+			     const arma_cand *pc, arma_info *ainfo)
+{
+    double *b = c->b;
+    int ia = 0, ib = 0;
+    int i;
+
+    if (pc == NULL) {
+	for (i=0; i<c->k; i++) {
+	    b[i] = 0.0;
+	}
+	if (S->ifc) {
+	    b[0] = gretl_mean(ainfo->t1, ainfo->t2, ainfo->y);
+	}
+	return;
+    }
+
+    if (S->ifc) {
+	b[ib++] = pc->b[ia++];
+    }
+
+    cand_copy_block(b, &ib, c->p, pc->b, &ia, pc->p, 0.0);
+    cand_copy_block(b, &ib, c->P, pc->b, &ia, pc->P, 0.0);
+    cand_copy_block(b, &ib, c->q, pc->b, &ia, pc->q, 0.0001);
+    cand_copy_block(b, &ib, c->Q, pc->b, &ia, pc->Q, 0.0001);
+    cand_copy_block(b, &ib, S->nexo, pc->b, &ia, S->nexo, 0.0);
+}
+
+/* Estimate candidate @c via conditional ML. Failure to converge
+   just marks the candidate as failed; only an allocation failure
+   is returned as an error. Note that this may be called from
+   several threads at once.
+*/
+
+static int arma_cand_fit (const arma_search *S, arma_cand *c,
+			  const arma_cand *pc)
+{
+    arma_info ainfo;
+    MODEL mod;
+    int err = 0;
+
+    if (c->k == 0) {
+	c->ll = S->ll0;
+	c->crit = arma_search_ic(S, c->ll, 0);
+	c->status = CAND_DONE;
+	return 0;
+    }
+
+    c->b = malloc(c->k * sizeof *c->b);
+    if (c->b == NULL) {
+	return E_ALLOC;
+    }
+
+    arma_info_init(&ainfo, S->opt | OPT_C, NULL, &S->sset);
+
+    ainfo.alist = arma_cand_list(S, c);
+    if (ainfo.alist == NULL) {
+	return E_ALLOC;
+    }
+
+    err = arma_check_list(&ainfo, &S->sset, S->opt);
+
+    if (!err) {
+	calc_max_lag(&ainfo);
+	err = arma_adjust_sample(&ainfo, &S->sset, NULL, NULL);
+    }
+
+    if (!err) {
+	ainfo.y = (double *) S->sset.Z[ainfo.yno];
+	if (ainfo.d > 0 || ainfo.D > 0) {
+	    err = arima_difference(&ainfo, &S->sset, 0);
+	}
+    }
+
+    if (!err) {
+	arma_cand_start(S, c, pc, &ainfo);
+	gretl_model_init(&mod, &S->sset);
+	err = bhhh_arma(c->b, &S->sset, &ainfo, &mod, OPT_NONE);
+	if (!err) {
+	    c->ll = mod.lnL;
+	}
+	clear_model(&mod);
+    }
+
+    arma_info_cleanup(&ainfo);
+    bounds_checker_cleanup();
+
+    if (err || na(c->ll)) {
+	c->status = CAND_FAILED;
+	free(c->b);
+	c->b = NULL;
+    } else {
+	c->crit = arma_search_ic(S, c->ll, c->k);
+	c->status = CAND_DONE;
+    }
+
+    return err == E_ALLOC ? err : 0;
+}
+
+/* estimate the members of a wave, in parallel if possible */
+
+static int arma_search_wave (arma_search *S, const int *wave,
+			     int nw, int parallel)
+{
+    int i, err = 0;
+
+#if ARMA_MP
+    if (parallel && nw > 1 &&
+	libset_use_openmp((guint64) nw * S->T * S->cand[S->ncand-1].k)) {
+#pragma omp parallel for schedule(dynamic)
+	for (i=0; i<nw; i++) {
+	    arma_cand *c = &S->cand[wave[i]];
+	    int myerr;
+
+	    myerr = arma_cand_fit(S, c, arma_cand_parent(S, c));
+	    if (myerr) {
+#pragma omp critical
+		err = myerr;
+	    }
+	}
+	return err;
+    }
+#endif
+
+    for (i=0; i<nw && !err; i++) {
+	arma_cand *c = &S->cand[wave[i]];
+
+	err = arma_cand_fit(S, c, arma_cand_parent(S, c));
+    }
+
+    return err;
+}
+
+/* pick the best candidate so far; ties go to the more
+   parsimonious specification */
+
+static void arma_search_set_best (arma_search *S)
+{
+    arma_cand *c, *b = NULL;
+    int i;
+
+    for (i=0; i<S->ncand; i++) {
+	c = &S->cand[i];
+	if (c->status != CAND_DONE) {
+	    continue;
+	}
+	if (b == NULL || c->crit < b->crit ||
+	    (c->crit == b->crit && c->k < b->k)) {
+	    b = c;
+	    S->best = i;
+	}
+    }
+}
+
+/* Can we skip the specifications of total order @o? All of
+   them are nested in the maximal one, so their loglikelihood
+   is bounded by the largest found so far, and all of them
+   have the same number of coefficients. If the criterion
+   evaluated at that bound can't beat the current best, the
+   whole wave (and every later wave) is out of the running.
+*/
+
+static int arma_search_prune (const arma_search *S, int o)
+{
+    double llmax = NADBL;
+    int i;
+
+    if (S->best < 0 || S->cand[S->ncand - 1].status != CAND_DONE) {
+	/* no valid bound as yet */
+	return 0;
+    }
+
+    for (i=0; i<S->ncand; i++) {
+	if (S->cand[i].status == CAND_DONE &&
+	    (na(llmax) || S->cand[i].ll > llmax)) {
+	    llmax = S->cand[i].ll;
+	}
+    }
+
+    return arma_search_ic(S, llmax, S->ifc + S->nexo + o) >=
+	S->cand[S->best].crit;
+}
+
+static int arma_search_run (arma_search *S, int parallel)
+{
+    int omax = S->pmax + S->qmax + S->Pmax + S->Qmax;
+    arma_cand *c, *cmax = &S->cand[S->ncand - 1];
+    int *wave;
+    int i, o, nw;
+    int err = 0;
+
+    wave = malloc(S->ncand * sizeof *wave);
+    if (wave == NULL) {
+	return E_ALLOC;
+    }
+
+    /* Estimate the maximal specification first, to supply a
+       bound on the loglikelihood for pruning. If it fails from
+       a cold start, try again later from a warm one.
+    */
+    err = arma_cand_fit(S, cmax, NULL);
+    if (!err && cmax->status == CAND_FAILED) {
+	cmax->status = CAND_PENDING;
+    }
+
+    for (o=0; o<=omax && !err; o++) {
+	nw = 0;
+	for (i=0; i<S->ncand; i++) {
+	    c = &S->cand[i];
+	    if (c->status == CAND_PENDING &&
+		c->p + c->q + c->P + c->Q == o) {
+		wave[nw++] = i;
+	    }
+	}
+	if (nw == 0) {
+	    continue;
+	}
+	if (arma_search_prune(S, o)) {
+	    for (i=0; i<S->ncand; i++) {
+		if (S->cand[i].status == CAND_PENDING) {
+		    S->cand[i].status = CAND_PRUNED;
+		}
+	    }
+	    break;
+	}
+	err = arma_search_wave(S, wave, nw, parallel);
+	if (!err) {
+	    arma_search_set_best(S);
+	}
+    }
+
+    if (!err && S->best < 0) {
+	gretl_errmsg_set(_("arma: no specification could be estimated"));
+	err = E_NOCONV;
+    }
+
+    free(wave);
+
+    return err;
+}
+
+/* the record of the search, as a matrix with one row per
+   candidate: p, q, P, Q, loglikelihood, criterion (the last two
+   are NA for candidates that were pruned or failed)
+*/
+
+static gretl_matrix *arma_search_matrix (const arma_search *S)
+{
+    const char *cnames[] = {
+	"p", "q", "P", "Q", "logLik", NULL
+    };
+    gretl_matrix *m;
+    char **names;
+    int i;
+
+    m = gretl_matrix_alloc(S->ncand, 6);
+    if (m == NULL) {
+	return NULL;
+    }
+
+    for (i=0; i<S->ncand; i++) {
+	const arma_cand *c = &S->cand[i];
+
+	gretl_matrix_set(m, i, 0, c->p);
+	gretl_matrix_set(m, i, 1, c->q);
+	gretl_matrix_set(m, i, 2, c->P);
+	gretl_matrix_set(m, i, 3, c->Q);
+	if (c->status == CAND_DONE) {
+	    gretl_matrix_set(m, i, 4, c->ll);
+	    gretl_matrix_set(m, i, 5, c->crit);
+	} else {
+	    gretl_matrix_set(m, i, 4, M_NA);
+	    gretl_matrix_set(m, i, 5, M_NA);
+	}
+    }
+
+    cnames[5] = arma_search_critname(S->ic);
+    names = strings_array_new(6);
+    if (names != NULL) {
+	for (i=0; i<6; i++) {
+	    names[i] = gretl_strdup(cnames[i]);
+	}
+	gretl_matrix_set_colnames(m, names);
+    }
+
+    return m;
+}
+
+static void arma_search_print (const arma_search *S, PRN *prn)
+{
+    const arma_cand *c;
+    int i;
+
+    pprintf(prn, "\n%s (%s, T = %d)\n\n",
+	    _("Automatic ARIMA order selection"),
+	    arma_search_critname(S->ic), S->T);
+
+    pputs(prn, "   p   q");
+    if (S->seasonal) {
+	pputs(prn, "   P   Q");
+    }
+    pprintf(prn, " %14s %12s\n", "logLik", arma_search_critname(S->ic));
+
+    for (i=0; i<S->ncand; i++) {
+	c = &S->cand[i];
+	pprintf(prn, "%4d%4d", c->p, c->q);
+	if (S->seasonal) {
+	    pprintf(prn, "%4d%4d", c->P, c->Q);
+	}
+	if (c->status == CAND_DONE) {
+	    pprintf(prn, " %14.5f %12.5f%s\n", c->ll, c->crit,
+		    i == S->best ? " *" : "");
+	} else if (c->status == CAND_PRUNED) {
+	    pprintf(prn, " %14s\n", _("pruned"));
+	} else {
+	    pprintf(prn, " %14s\n", _("failed"));
+	}
+    }
+
+    pputc(prn, '\n');
+}
+
+/* the --auto variant of the arima command: search over orders
+   up to those given in @list, then estimate the winner using the
+   method called for by @opt, starting from its conditional ML
+   estimates */
+
+static MODEL arma_auto_model (const int *list, const int *pqspec,
+			      const DATASET *dset, gretlopt opt,
+			      PRN *prn)
+{
+    arma_search S;
+    MODEL armod;
+    int *blist = NULL;
+    int ic = C_AIC;
+    int err = 0;
+
+    S.tail = NULL;
+    S.cand = NULL;
+
+    if (pqspec != NULL && pqspec[0] > 0) {
+	gretl_errmsg_set(_("arma: --auto cannot be combined with "
+			   "specific AR or MA lags"));
+	gretl_model_init(&armod, dset);
+	armod.errcode = E_BADOPT;
+	return armod;
+    }
+
+    err = check_arma_options(opt);
+
+    if (!err) {
+	ic = arma_search_criterion(get_optval_string(ARMA, OPT_A), &err);
+    }
+
+    if (!err) {
+	err = arma_search_init(&S, list, dset, opt, ic);
+	if (!err) {
+	    err = arma_search_run(&S, 1);
+	}
+    }
+
+    if (!err) {
+	blist = arma_cand_list(&S, &S.cand[S.best]);
+	if (blist == NULL) {
+	    err = E_ALLOC;
+	}
+    }
+
+    if (err) {
+	gretl_model_init(&armod, dset);
+	armod.errcode = err;
+    } else {
+	if (opt & OPT_V) {
+	    arma_search_print(&S, prn);
+	}
+	armod = real_arma_model(blist, NULL, dset, opt & ~OPT_A,
+				S.cand[S.best].b, prn);
+	if (!armod.errcode) {
+	    gretl_matrix *m = arma_search_matrix(&S);
+
+	    if (m != NULL) {
+		gretl_model_set_matrix_as_data(&armod, "arma_search", m);
+	    }
+	}
+    }
+
+    free(blist);
+    arma_search_free(&S);
+
+    return armod;
+}
+
+/* run the order search for series @v, writing the selected
+   orders and the criterion value into row @i of @m, or NAs
+   if the search fails */
+
+static int arma_auto_row (gretl_matrix *m, int i, int v,
+			  const gretl_matrix *orders, int ic,
+			  const DATASET *dset, int parallel)
+{
+    int seasonal = (orders->rows * orders->cols == 6);
+    int list[10];
+    arma_search S;
+    int j, err;
+
+    list[0] = seasonal ? 9 : 5;
+    list[1] = (int) orders->val[0];
+    list[2] = (int) orders->val[1];
+    list[3] = (int) orders->val[2];
+    list[4] = LISTSEP;
+    if (seasonal) {
+	list[5] = (int) orders->val[3];
+	list[6] = (int) orders->val[4];
+	list[7] = (int) orders->val[5];
+	list[8] = LISTSEP;
+    }
+    list[list[0]] = v;
+
+    err = arma_search_init(&S, list, dset, OPT_NONE, ic);
+
+    if (!err) {
+	err = arma_search_run(&S, parallel);
+    }
+
+    if (!err) {
+	const arma_cand *c = &S.cand[S.best];
+
+	gretl_matrix_set(m, i, 0, c->p);
+	gretl_matrix_set(m, i, 1, S.d);
+	gretl_matrix_set(m, i, 2, c->q);
+	gretl_matrix_set(m, i, 3, c->P);
+	gretl_matrix_set(m, i, 4, S.D);
+	gretl_matrix_set(m, i, 5, c->Q);
+	gretl_matrix_set(m, i, 6, c->crit);
+    } else {
+	for (j=0; j<7; j++) {
+	    gretl_matrix_set(m, i, j, M_NA);
+	}
+    }
+
+    arma_search_free(&S);
+
+    return err == E_ALLOC ? err : 0;
+}
+
+/* Automatic ARIMA order selection for each of the series in
+   @ylist, as called by arma_auto_orders() in libgretl. When
+   there are several series these are handled in parallel, with
+   the search for each series run serially.
+*/
+
+gretl_matrix *arma_auto_select (const int *ylist,
+				const gretl_matrix *orders,
+				const char *crit,
+				const DATASET *dset,
+				int *err)
+{
+    const char *cnames[] = {
+	"p", "d", "q", "P", "D", "Q", NULL
+    };
+    gretl_matrix *m;
+    char **names;
+    int nv = ylist[0];
+    int i, n, ic;
+
+    n = gretl_vector_get_length(orders);
+    if (nv == 0 || (n != 3 && n != 6)) {
+	*err = E_INVARG;
+	return NULL;
+    }
+
+    for (i=0; i<n; i++) {
+	if (orders->val[i] < 0 || orders->val[i] != floor(orders->val[i])) {
+	    *err = E_INVARG;
+	    return NULL;
+	}
+    }
+
+    ic = arma_search_criterion(crit, err);
+    if (*err) {
+	return NULL;
+    }
+
+    m = gretl_matrix_alloc(nv, 7);
+    if (m == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+#if ARMA_MP
+    if (nv > 1 && libset_use_openmp((guint64) nv * dset->n * n)) {
+#pragma omp parallel for schedule(dynamic)
+	for (i=0; i<nv; i++) {
+	    int myerr = arma_auto_row(m, i, ylist[i+1], orders, ic,
+				      dset, 0);
+
+	    if (myerr) {
+#pragma omp critical
+		*err = myerr;
+	    }
+	}
+	goto finish;
+    }
+#endif
+
+    for (i=0; i<nv && !*err; i++) {
+	*err = arma_auto_row(m, i, ylist[i+1], orders, ic, dset, 1);
+    }
+
+#if ARMA_MP
+ finish:
+#endif
+
+    if (*err) {
+	gretl_matrix_free(m);
+	return NULL;
+    }
+
+    cnames[6] = arma_search_critname(ic);
+    names = strings_array_new(7);
+    if (names != NULL) {
+	for (i=0; i<7; i++) {
+	    names[i] = gretl_strdup(cnames[i]);
+	}
+	gretl_matrix_set_colnames(m, names);
+    }
+
+    names = strings_array_new(nv);
+    if (names != NULL) {
+	for (i=0; i<nv; i++) {
+	    names[i] = gretl_strdup(dset->varname[ylist[i+1]]);
+	}
+	gretl_matrix_set_rownames(m, names);
+    }
+
+    return m;
+}
+
+MODEL arma_model (const int *list, const int *pqspec,
+		  const DATASET *dset, gretlopt opt, 
+		  PRN *prn)
+{
+    if (opt & OPT_A) {
+	return arma_auto_model(list, pqspec, dset, opt, prn);
+    } else {
+	return real_arma_model(list, pqspec, dset, opt, NULL, prn);
+    }
+}
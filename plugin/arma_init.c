@@ -28,22 +28,17 @@
    goes: const, phi, Phi, theta, Theta, beta.
 */
 
-static void transform_arma_const (double *b, arma_info *ainfo)
+/* evaluate the (possibly seasonal) AR polynomial at 1, given
+   the non-seasonal AR coefficients in @phi, followed by the
+   seasonal ones */
+
+static double ar_poly_at_one (const double *phi, arma_info *ainfo)
 {
-    const double *phi = b + 1;
     const double *Phi = phi + ainfo->np;
     double narfac = 1.0;
     double sarfac = 1.0;
     int i, k = 0;
 
-    if (ainfo->np == 0 && ainfo->P == 0) {
-	return;
-    }
-
-#if AINIT_DEBUG
-    fprintf(stderr, "transform_arma_const: initially = %g\n", b[0]);
-#endif
-
     for (i=0; i<ainfo->p; i++) {
 	if (AR_included(ainfo, i)) {
 	    narfac -= phi[k++];
@@ -54,7 +49,31 @@ static void transform_arma_const (double *b, arma_info *ainfo)
 	sarfac -= Phi[i];
     }
 
-    b[0] /= (narfac * sarfac);
+    return narfac * sarfac;
+}
+
+/* AR polynomial values at 1 smaller than this (in absolute value)
+   are treated as a unit root, in which case the intercept and
+   regression coefficients are left as they are */
+
+#define AR_ONE_TOL 1.0e-8
+
+static void transform_arma_const (double *b, arma_info *ainfo)
+{
+    double arfac;
+
+    if (ainfo->np == 0 && ainfo->P == 0) {
+	return;
+    }
+
+#if AINIT_DEBUG
+    fprintf(stderr, "transform_arma_const: initially = %g\n", b[0]);
+#endif
+
+    arfac = ar_poly_at_one(b + 1, ainfo);
+    if (fabs(arfac) >= AR_ONE_TOL) {
+	b[0] /= arfac;
+    }
 }
 
 #define HR_MINLAGS 16
@@ -1227,6 +1246,47 @@ int ar_arma_init (double *coeff, const DATASET *dset,
     return err;
 }
 
+/* Initialize from conditional ML estimates @b of the same
+   specification, as produced by the automatic order search.
+   For exact ML we scale the constant and regression coefficients
+   to match any scaling of y. Further, conditional ML estimates
+   the ARMAX form, phi(L)y_t = c + x_t'b + ..., while exact ML
+   uses the regression with ARMA errors, phi(L)(y_t - mu - x_t'beta)
+   = ..., so the constant and regression coefficients are divided
+   by phi(1), as in transform_arma_const().
+*/
+
+void cml_arma_init (double *coeff, const double *b,
+		    arma_info *ainfo)
+{
+    int i, xi = ainfo->nc - ainfo->nexo;
+
+    for (i=0; i<ainfo->nc; i++) {
+	coeff[i] = b[i];
+    }
+
+    if (arma_exact_ml(ainfo)) {
+	double arfac = 1.0;
+
+	if (ainfo->np > 0 || ainfo->P > 0) {
+	    arfac = ar_poly_at_one(coeff + ainfo->ifc, ainfo);
+	    if (fabs(arfac) < AR_ONE_TOL) {
+		arfac = 1.0;
+	    }
+	}
+	if (ainfo->ifc) {
+	    maybe_set_yscale(ainfo);
+	    coeff[0] *= ainfo->yscale / arfac;
+	}
+	for (i=0; i<ainfo->nexo; i++) {
+	    coeff[xi + i] *= ainfo->yscale / arfac;
+	}
+    }
+
+    pprintf(ainfo->prn, "\n%s: %s\n\n", _("ARMA initialization"),
+	    _("conditional ML estimates"));
+}
+
 int arma_by_ls (const double *coeff, const DATASET *dset,
 		arma_info *ainfo, MODEL *pmod)
 {
@@ -119,6 +119,9 @@ int hr_arma_init (double *coeff, const DATASET *dset,
 int ar_arma_init (double *coeff, const DATASET *dset,
 		  arma_info *ainfo, MODEL *pmod);
 
+void cml_arma_init (double *coeff, const double *b,
+		    arma_info *ainfo);
+
 int arma_by_ls (const double *coeff, const DATASET *dset,
 		arma_info *ainfo, MODEL *pmod);
 
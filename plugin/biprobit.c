@@ -576,23 +576,18 @@ static int biprob_prelim (const double *theta, bp_container *bp)
     return err;
 }
 
-static double biprob_loglik (const double *theta, void *ptr)
-{
-    bp_container *bp = (bp_container *) ptr;
-    double rho, llt, a, b, P;
-    double ll = NADBL;
-    int i, eqt, err;
-
-    err = biprob_prelim(theta, bp);
+/* loglikelihood contributions of observations @s0 to @s1 - 1,
+   for use with ll_block_sum() */
 
-    if (err) {
-	return ll;
-    }
+static int biprob_ll_block (void *data, int s0, int s1,
+			    double *ll, double *g)
+{
+    bp_container *bp = data;
+    double rho = tanh(bp->arho);
+    double a, b, P;
+    int i, eqt;
 
-    ll = 0.0;
-    rho = tanh(bp->arho);
-    
-    for (i=0; i<bp->nobs; i++) {
+    for (i=s0; i<s1; i++) {
 	a = gretl_vector_get(bp->fitted1, i);
 	b = gretl_vector_get(bp->fitted2, i);
 	
@@ -601,35 +596,43 @@ static double biprob_loglik (const double *theta, void *ptr)
 	eqt = (bp->s1[i] == bp->s2[i]);
 	
 	P = bvnorm_cdf((eqt ? rho : -rho), a, b);
-	llt = log(P);
-	ll += llt;
+	*ll += log(P);
     }
 
-    bp->ll = ll;
-
-    return ll;
+    return 0;
 }
 
-static int biprob_score (double *theta, double *s, int npar, BFGS_CRIT_FUNC ll, 
-			 void *ptr)
+static double biprob_loglik (const double *theta, void *ptr)
 {
     bp_container *bp = (bp_container *) ptr;
-    double ca, sa, ssa;
-    double a, b, P, f, d1, d2, da, tmp, u_ab, u_ba;
-    int i, j, eqt;
+    double ll = NADBL;
     int err;
 
     err = biprob_prelim(theta, bp);
 
     if (err) {
-	return err;
+	return ll;
     }
 
-    ca = cosh(bp->arho);
-    sa = sinh(bp->arho);
-    gretl_matrix_zero(bp->sscore);
+    ll_block_sum(biprob_ll_block, bp, bp->nobs, 0, &ll, NULL);
+    bp->ll = ll;
+
+    return ll;
+}
+
+/* per-observation score for observations @s0 to @s1 - 1, written
+   into bp->score, with the column sums added to @g */
 
-    for (i=0; i<bp->nobs; i++) {
+static int biprob_score_block (void *data, int s0, int s1,
+			       double *ll, double *g)
+{
+    bp_container *bp = data;
+    double ca = cosh(bp->arho);
+    double sa = sinh(bp->arho);
+    double ssa, a, b, P, f, d1, d2, da, tmp, u_ab, u_ba;
+    int i, j, eqt;
+
+    for (i=s0; i<s1; i++) {
 	a = gretl_vector_get(bp->fitted1, i);
 	b = gretl_vector_get(bp->fitted2, i);
 	
@@ -657,30 +660,43 @@ static int biprob_score (double *theta, double *s, int npar, BFGS_CRIT_FUNC ll,
 	for (j=0; j<bp->k1; j++) {
 	    tmp = gretl_matrix_get(bp->reg1, i, j) * d1;
 	    gretl_matrix_set(bp->score, i, j, tmp);
-	    tmp += gretl_vector_get(bp->sscore, j);
-	    gretl_vector_set(bp->sscore, j, tmp);
+	    g[j] += tmp;
 	}
 	
 	for (j=0; j<bp->k2; j++) {
 	    tmp = gretl_matrix_get(bp->reg2, i, j) * d2;
 	    gretl_matrix_set(bp->score, i, bp->k1 + j, tmp);
-	    tmp += gretl_vector_get(bp->sscore, bp->k1 + j);
-	    gretl_vector_set(bp->sscore, bp->k1 + j, tmp);
+	    g[bp->k1 + j] += tmp;
 	}
 	
 	gretl_matrix_set(bp->score, i, bp->npar - 1, da);
-	tmp = da + gretl_vector_get(bp->sscore, bp->npar - 1);
-	gretl_vector_set(bp->sscore, bp->npar - 1, tmp);
+	g[bp->npar - 1] += da;
+    }
+
+    return 0;
+}
+
+static int biprob_score (double *theta, double *s, int npar, BFGS_CRIT_FUNC ll, 
+			 void *ptr)
+{
+    bp_container *bp = (bp_container *) ptr;
+    double llb;
+    int i, err;
 
+    err = biprob_prelim(theta, bp);
+
+    if (!err) {
+	err = ll_block_sum(biprob_score_block, bp, bp->nobs, bp->npar,
+			   &llb, bp->sscore->val);
     }
 
-    if (s != NULL) {
+    if (!err && s != NULL) {
 	for (i=0; i<npar; i++) {
 	    s[i] = gretl_vector_get(bp->sscore,i);
 	}
     }
 
-    return 0;
+    return err;
 }
 
 /* 
@@ -849,7 +849,10 @@ static int gmm_inst_lev (ddset *dpd, int bnum, const double *x,
    has the instruments in rows and the observations in columns.
 
    Note that each unit's Zi is the same size, padded with zero columns
-   for missing observations as needed. The number of columns in Zi
+   for missing observations as needed. Zi must be all zeros on entry:
+   stack_unit_data() clears the columns written here once their
+   contents have been transferred to ZT, which saves re-zeroing the
+   whole matrix for each unit. The number of columns in Zi
    equals the maximal span of the data for all units taken together,
    counting both observations in differences and observations in
    levels, if applicable.
@@ -898,8 +901,6 @@ static void build_Z (ddset *dpd, int *goodobs,
     int t0, t1, i0, i1;
     int i, j, col, row = 0;
 
-    gretl_matrix_zero(Zi);
-
     /* GMM-style instruments in levels for diffs equations */
     for (i=0; i<dpd->nzb; i++) {
 	x = dset->Z[dpd->d[i].v];
@@ -1044,32 +1045,41 @@ static int make_units_workspace (ddset *dpd, gretl_matrix **D,
 
 /* Stack the per-unit data matrices from unit @unum for future use, 
    skipping unused observations and recording the numbers of 
-   observations in differences and in levels.
+   observations in differences and in levels. The instruments
+   are transferred to the sparse ZT and the corresponding columns
+   of Zi are zeroed, ready for the next unit. In @map we record
+   the row of the stacked data corresponding to each column of
+   the per-unit matrices, or -1 if the column is not used.
 */
 
-static void stack_unit_data (ddset *dpd,
-			     const gretl_matrix *Yi, 
-			     const gretl_matrix *Xi,
-			     const gretl_matrix *Zi,
-			     int *goodobs, int unum,
-			     int *row)
+static int stack_unit_data (ddset *dpd,
+			    const gretl_matrix *Yi, 
+			    const gretl_matrix *Xi,
+			    gretl_matrix *Zi,
+			    int *goodobs, int unum,
+			    int *map, int *row)
 {
     unit_info *unit = &dpd->ui[unum];
+    double *zk;
     double x;
     int i, j, k, s = *row;
+    int err = 0;
 
-    for (i=2; i<=goodobs[0]; i++) {
+    for (k=0; k<Zi->cols; k++) {
+	map[k] = -1;
+    }
+
+    for (i=2; i<=goodobs[0] && !err; i++) {
 	k = goodobs[i] - dpd->dcolskip;
 	gretl_vector_set(dpd->Y, s, Yi->val[k]);
 	for (j=0; j<Xi->rows; j++) {
 	    x = gretl_matrix_get(Xi, j, k);
 	    gretl_matrix_set(dpd->X, s, j, x);
 	}
-	for (j=0; j<dpd->nz; j++) {
-	    x = gretl_matrix_get(Zi, j, k);
-	    gretl_matrix_set(dpd->ZT, j, s, x);
-	}
-	s++;
+	zk = Zi->val + k * Zi->rows;
+	err = zt_append_column(dpd, s, zk, 1);
+	memset(zk, 0, Zi->rows * sizeof *zk);
+	map[k] = s++;
     }
 
     /* record the indices of the first and last
@@ -1081,7 +1091,7 @@ static void stack_unit_data (ddset *dpd,
     unit->nobs = (goodobs[0] > 0)? (goodobs[0] - 1) : 0;
 
     if (gmm_sys(dpd)) {
-	for (i=1; i<=goodobs[0]; i++) {
+	for (i=1; i<=goodobs[0] && !err; i++) {
 	    k = goodobs[i] + dpd->lcol0;
 	    if (k >= Yi->cols) {
 		fprintf(stderr, "*** stack_unit_data: reading off "
@@ -1094,11 +1104,10 @@ static void stack_unit_data (ddset *dpd,
 		x = gretl_matrix_get(Xi, j, k);
 		gretl_matrix_set(dpd->X, s, j, x);
 	    }
-	    for (j=0; j<dpd->nz; j++) {
-		x = gretl_matrix_get(Zi, j, k);
-		gretl_matrix_set(dpd->ZT, j, s, x);
-	    }
-	    s++;
+	    zk = Zi->val + k * Zi->rows;
+	    err = zt_append_column(dpd, s, zk, 1);
+	    memset(zk, 0, Zi->rows * sizeof *zk);
+	    map[k] = s++;
 	}
 
 	/* record the number of levels obs and augment total */
@@ -1106,16 +1115,18 @@ static void stack_unit_data (ddset *dpd,
 	unit->nobs += unit->nlev;
     }
 
-#if WRITE_MATRICES
-    gretl_matrix_write_as_text(dpd->ZT, "dpdZT.mat", 0);
-#endif
-
     *row = s;
+
+    return err;
 }
 
 /* Main driver for system GMM: the core is a loop across
-   the panel units to build the data and instrument matrices
-   and cumulate A = \sum_i Z_i H_i Z_i'.
+   the panel units to build the data and instrument matrices.
+   The instruments are stored in sparse form, along with the
+   non-zero elements of the H_i matrices, and the loop is then
+   followed by the formation of A = \sum_i Z_i H_i Z_i' from
+   the non-zero elements alone: with GMM-style instruments
+   most of the elements of Z_i are zero.
 
    At this point we have already done the observations
    accounts, which are recorded in the Goodobs lists.
@@ -1131,6 +1142,8 @@ static int do_units (ddset *dpd, const DATASET *dset,
     gretl_matrix *Yi = NULL;
     gretl_matrix *Xi = NULL;
     gretl_matrix *Zi = NULL;
+    h_list hl = {NULL, 0, 0};
+    int *map = NULL;
     int i, t, Yrow;
     int err = 0;
 
@@ -1139,8 +1152,15 @@ static int do_units (ddset *dpd, const DATASET *dset,
 	return err;
     }
 
+    map = malloc(dpd->max_ni * sizeof *map);
+    if (map == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
     Zi = dpd->Zi;
     gretl_matrix_reuse(Zi, dpd->nz, dpd->max_ni);
+    gretl_matrix_zero(Zi);
     
     if (D == NULL) {
 	/* the H matrix will not vary by unit */
@@ -1155,7 +1175,6 @@ static int do_units (ddset *dpd, const DATASET *dset,
 
     /* initialize cumulators */
     gretl_matrix_zero(dpd->XZ);
-    gretl_matrix_zero(dpd->A);
     gretl_matrix_zero(dpd->ZY);
 
     /* initialize data stacker */
@@ -1166,7 +1185,6 @@ static int do_units (ddset *dpd, const DATASET *dset,
        working correctly */
     gretl_matrix_zero(dpd->Y);
     gretl_matrix_zero(dpd->X);
-    gretl_matrix_zero(dpd->ZT);
 #endif
 
     for (i=0; i<dpd->N; i++) {
@@ -1193,10 +1211,19 @@ static int do_units (ddset *dpd, const DATASET *dset,
 	if (D != NULL) {
 	    build_unit_H_matrix(dpd, goodobs, D);
 	}
-	gretl_matrix_qform(Zi, GRETL_MOD_NONE,
-			   dpd->H, dpd->A, GRETL_MOD_CUMULATE);
 	/* stack the individual data matrices for future use */
-	stack_unit_data(dpd, Yi, Xi, Zi, goodobs, i, &Yrow);
+	err = stack_unit_data(dpd, Yi, Xi, Zi, goodobs, i, map, &Yrow);
+	if (!err) {
+	    err = h_list_add(&hl, dpd->H, map, dpd->max_ni);
+	}
+	if (err) {
+	    break;
+	}
+    }
+
+    if (!err) {
+	zt_complete(dpd, Yrow);
+	dpd_make_A(dpd, &hl);
     }
 
 #if DPDEBUG
@@ -1209,9 +1236,13 @@ static int do_units (ddset *dpd, const DATASET *dset,
     gretl_matrix_write_as_text(dpd->X, "dpdX.mat", 0);
 #endif    
 
+ bailout:
+
     gretl_matrix_free(D);
     gretl_matrix_free(Yi);
     gretl_matrix_free(Xi);
+    free(map);
+    free(hl.e);
 
     return err;
 }
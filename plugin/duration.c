@@ -48,6 +48,7 @@ struct duration_info_ {
     int npar;              /* total number of parameters */
     int n;                 /* number of observations */
     double ll;             /* loglikelihood */    
+    double s;              /* scale at the current evaluation point */
     double *theta;         /* parameter array, length npar */
     gretl_matrix_block *B; /* workspace */
     gretl_vector *logt;    /* log of dependent variable (duration) */
@@ -116,6 +117,7 @@ static int duration_init (duration_info *dinfo, MODEL *pmod,
 
     dinfo->B = NULL;
     dinfo->theta = NULL;
+    dinfo->s = 1.0;
 
     if (opt & OPT_E) {
 	/* exponential */
@@ -217,30 +219,24 @@ static void duration_update_Xb (duration_info *dinfo, const double *theta)
    Analysis of Failure Time Data, 2e (Wiley, 2002), pp. 68-70.
 */
 
-static double duration_loglik (const double *theta, void *data)
+/* loglikelihood for observations @s0 to @s1 - 1: since this
+   may run in a worker thread, errno is checked here */
+
+static int duration_ll_block (void *data, int s0, int s1,
+			      double *llsum, double *g)
 {
     duration_info *dinfo = (duration_info *) data;
     double *ll = dinfo->llt->val;
-    double *Xb = dinfo->Xb->val;
-    double *logt = dinfo->logt->val;
-    double wi, s = 1.0, lns = 0.0;
+    const double *Xb = dinfo->Xb->val;
+    const double *logt = dinfo->logt->val;
+    double wi, s = dinfo->s;
+    double lns = log(s);
     double l1ew = 0.0;
     int i, di;
 
-    if (dinfo->dist != DUR_EXPON) {
-	s = theta[dinfo->k];
-	if (s <= 0) {
-	    return NADBL;
-	}
-	lns = log(s);
-    } 
-
-    duration_update_Xb(dinfo, theta);
-
-    dinfo->ll = 0.0;
     errno = 0;
 
-    for (i=0; i<dinfo->n; i++) {
+    for (i=s0; i<s1; i++) {
 	di = uncensored(dinfo, i);
 	wi = (logt[i] - Xb[i]) / s;
 	if (dinfo->dist == DUR_LOGLOG) {
@@ -264,10 +260,27 @@ static double duration_loglik (const double *theta, void *data)
 		ll[i] += wi - lns;
 	    }
 	}	
-	dinfo->ll += ll[i];
+	*llsum += ll[i];
+    }
+
+    return errno ? E_NAN : 0;
+}
+
+static double duration_loglik (const double *theta, void *data)
+{
+    duration_info *dinfo = (duration_info *) data;
+    int err;
+
+    if (dinfo->dist != DUR_EXPON && theta[dinfo->k] <= 0) {
+	return NADBL;
     }
 
-    if (errno) {
+    duration_update_Xb(dinfo, theta);
+    dinfo->s = dinfo->dist == DUR_EXPON ? 1.0 : theta[dinfo->k];
+
+    err = ll_block_sum(duration_ll_block, dinfo, dinfo->n, 0,
+		       &dinfo->ll, NULL);
+    if (err) {
 	dinfo->ll = NADBL;
     }
 
@@ -281,30 +294,20 @@ static double normal_h (double w)
     return normal_pdf(w) / normal_cdf(-w);
 }
 
-static int duration_score (double *theta, double *g, int np, 
-			   BFGS_CRIT_FUNC ll, void *data)
+/* score for observations @s0 to @s1 - 1, written into
+   dinfo->G and summed into @g */
+
+static int duration_score_block (void *data, int s0, int s1,
+				 double *ll, double *g)
 {
     duration_info *dinfo = (duration_info *) data;
     const double *logt = dinfo->logt->val;
     const double *Xb = dinfo->Xb->val;
-    double wi, ewi, ai, xij, gij, s = 1.0;
-    int i, j, di, err = 0;
-
-    if (dinfo->flags == DUR_UPDATE_XB) {
-	duration_update_Xb(dinfo, theta);
-    }
-
-    if (dinfo->dist != DUR_EXPON) {
-	s = theta[dinfo->k];
-    } 
-
-    if (g != NULL) {
-	for (j=0; j<np; j++) {
-	    g[j] = 0.0;
-	}
-    }  
+    double wi, ewi, ai, xij, gij, s = dinfo->s;
+    int np = dinfo->npar;
+    int i, j, di;
 
-    for (i=0; i<dinfo->n; i++) {
+    for (i=s0; i<s1; i++) {
 	di = uncensored(dinfo, i);
 	wi = (logt[i] - Xb[i]) / s;
 	ewi = exp(wi);
@@ -326,12 +329,41 @@ static int duration_score (double *theta, double *g, int np,
 	    }
 	    gij /= s;
 	    gretl_matrix_set(dinfo->G, i, j, gij);
-	    if (g != NULL) {
-		g[j] += gij;
-	    }
+	    g[j] += gij;
 	}
     }
 
+    return 0;
+}
+
+static int duration_score (double *theta, double *g, int np, 
+			   BFGS_CRIT_FUNC ll, void *data)
+{
+    duration_info *dinfo = (duration_info *) data;
+    double llsum, *gsum = g;
+    int err;
+
+    if (dinfo->flags == DUR_UPDATE_XB) {
+	duration_update_Xb(dinfo, theta);
+    }
+
+    dinfo->s = dinfo->dist == DUR_EXPON ? 1.0 : theta[dinfo->k];
+
+    if (g == NULL) {
+	/* we just want dinfo->G */
+	gsum = malloc(np * sizeof *gsum);
+	if (gsum == NULL) {
+	    return E_ALLOC;
+	}
+    }
+
+    err = ll_block_sum(duration_score_block, dinfo, dinfo->n, np,
+		       &llsum, gsum);
+
+    if (g == NULL) {
+	free(gsum);
+    }
+
     return err;
 }
 
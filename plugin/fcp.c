@@ -42,8 +42,6 @@ enum {
     FCP_HESS  /* just calculating the Hessian */
 };
 
-typedef struct fcpinfo_ fcpinfo;
-
 struct fcpinfo_ {
     int nc;
     int t1, t2;
@@ -71,6 +69,10 @@ struct fcpinfo_ {
     double ***H;
 
     gretl_matrix *V;
+
+    /* line-search state, carried between iterations */
+    double im_ll1, im_fs;
+    double h_ll1, h_fs;
 };
 
 static void free_H (double ***H, int np)
@@ -174,15 +176,16 @@ static void fcpinfo_destroy (fcpinfo *f)
 
     doubles_array_free(f->dhdp, f->npar);
     gretl_matrix_free(f->V);
-    free_H(f->H, f->npar);
+    if (f->H != NULL) {
+	free_H(f->H, f->npar);
+    }
 
     free(f);
 }
 
-static fcpinfo *fcpinfo_new (int q, int p, int t1, int t2, int T,
-			     const double *y, const double **X, int nc,
-			     double *theta, double *e, double *e2, double *h,
-			     double scale, int code)
+/* allocate workspace for series of length (at most) @T */
+
+static fcpinfo *fcpinfo_alloc (int q, int p, int T, int nc, int code)
 {
     fcpinfo *f = malloc(sizeof *f);
 
@@ -190,8 +193,6 @@ static fcpinfo *fcpinfo_new (int q, int p, int t1, int t2, int T,
 	return NULL;
     }
 
-    f->theta = theta;
-
     f->grad = NULL;
     f->parpre = NULL;
     f->gg = NULL;
@@ -200,25 +201,53 @@ static fcpinfo *fcpinfo_new (int q, int p, int t1, int t2, int T,
     f->asum2 = NULL;
     f->dhdp = NULL;
     f->V = NULL;
+    f->H = NULL;
 
     f->nc = nc;
-    f->t1 = t1;
-    f->t2 = t2;
-    f->T = T,
+    f->T = T;
     f->p = p;
     f->q = q;
+
+    f->npar = f->nc + 1 + q + p;
+
+    if (fcp_allocate(f, code)) {
+	fcpinfo_destroy(f);
+	f = NULL;
+    }
+
+    return f;
+}
+
+/* attach data to the workspace @f and reset its state */
+
+static void fcpinfo_set_data (fcpinfo *f, int t1, int t2,
+			      const double *y, const double **X,
+			      double *theta, double *e, double *e2,
+			      double *h, double scale)
+{
+    f->t1 = t1;
+    f->t2 = t2;
     f->y = y;
     f->X = X;
+    f->theta = theta;
     f->e = e;
     f->e2 = e2;
-    f->h = h;   
+    f->h = h;
     f->scale = scale;
 
-    f->npar = f->nc + 1 + q + p;
+    f->im_ll1 = f->im_fs = 0.0;
+    f->h_ll1 = f->h_fs = 0.0;
+}
 
-    if (fcp_allocate(f, code)) {
-	fcpinfo_destroy(f);
-	f = NULL;
+static fcpinfo *fcpinfo_new (int q, int p, int t1, int t2, int T,
+			     const double *y, const double **X, int nc,
+			     double *theta, double *e, double *e2, double *h,
+			     double scale, int code)
+{
+    fcpinfo *f = fcpinfo_alloc(q, p, T, nc, code);
+
+    if (f != NULL) {
+	fcpinfo_set_data(f, t1, t2, y, X, theta, e, e2, h, scale);
     }
 
     return f;
@@ -1016,7 +1045,6 @@ static int
 garch_info_matrix (fcpinfo *f, gretl_matrix *V, double toler, 
 		   int *count) 
 {
-    static double ll1 = 0.0, fs = 0.0;
     int err;
 
     vcv_setup(f, V, ML_IM);
@@ -1033,7 +1061,7 @@ garch_info_matrix (fcpinfo *f, gretl_matrix *V, double toler,
 
     if (count != NULL) {
 	/* not just calculating vcv at convergence */
-	fcp_iterate(f, V, &ll1, &fs, toler, *count);
+	fcp_iterate(f, V, &f->im_ll1, &f->im_fs, toler, *count);
     }
 
     gretl_matrix_switch_sign(V);
@@ -1045,7 +1073,6 @@ static int
 garch_hessian (fcpinfo *f, gretl_matrix *V, double toler, 
 	       int *count)
 {
-    static double ll1 = 0.0, fs = 0.0;
     int i, sign_done = 0;
     int err;
 
@@ -1077,7 +1104,7 @@ garch_hessian (fcpinfo *f, gretl_matrix *V, double toler,
     }
 
     if (count != NULL) {
-	fcp_iterate(f, V, &ll1, &fs, toler, *count);
+	fcp_iterate(f, V, &f->h_ll1, &f->h_fs, toler, *count);
     }
 
     if (!sign_done) {
@@ -1189,28 +1216,17 @@ static int converged (fcpinfo *f, double tol)
 
 */
 
-int garch_estimate (const double *y, const double **X, 
-		    int t1, int t2, int nobs, int nc,
-		    int p, int q, double *theta, gretl_matrix *V, 
-		    double *e, double *e2, double *h,
-		    double scale, double *pll, int *iters, 
-		    int vopt, PRN *prn)
+static int fcp_estimate (fcpinfo *f, gretl_matrix *V, double *pll,
+			 int *iters, int vopt, PRN *prn)
 {
-    fcpinfo *f;
     int it1, it2, ittot;
     int count = 0;
-    int npar = nc + 1 + p + q; 
+    int npar = f->npar;
     double tol1 = .05;  /* tolerance when using info matrix */
     double tol2 = 1e-8; /* tolerance when using Hessian */
     double ll, sumgra; 
     int i, err = 0;
 
-    f = fcpinfo_new(q, p, t1, t2, nobs, y, X, nc,
-		    theta, e, e2, h, scale, FCP_FULL);
-    if (f == NULL) {
-	return E_ALLOC;
-    }
-
     /* Step 1: iterate to a first approximation using the info matrix */
 
     for (it1=0; it1<100; it1++) {
@@ -1224,7 +1240,7 @@ int garch_estimate (const double *y, const double **X,
 
 	err = garch_info_matrix(f, f->V, tol1, &count);
 	if (err) {
-	    goto garch_exit;
+	    return err;
 	}
 
 	garch_iter_info(f, it1, ll, 0, prn);
@@ -1249,7 +1265,7 @@ int garch_estimate (const double *y, const double **X,
 
 	err = garch_hessian(f, f->V, tol2, &it2);
 	if (err) {
-	    goto garch_exit;
+	    return err;
 	}
 
 	garch_iter_info(f, ittot++, ll, 1, prn);
@@ -1288,13 +1304,66 @@ int garch_estimate (const double *y, const double **X,
 	err = make_garch_vcv(f, f->V, V, vopt);
     }
 
- garch_exit:
+    return err;
+}
+
+int garch_estimate (const double *y, const double **X, 
+		    int t1, int t2, int nobs, int nc,
+		    int p, int q, double *theta, gretl_matrix *V, 
+		    double *e, double *e2, double *h,
+		    double scale, double *pll, int *iters, 
+		    int vopt, PRN *prn)
+{
+    fcpinfo *f;
+    int err;
+
+    f = fcpinfo_new(q, p, t1, t2, nobs, y, X, nc,
+		    theta, e, e2, h, scale, FCP_FULL);
+    if (f == NULL) {
+	return E_ALLOC;
+    }
+
+    err = fcp_estimate(f, V, pll, iters, vopt, prn);
 
     fcpinfo_destroy(f);
 
     return err;
 }
 
+/* Workspace for estimating a given GARCH(p, q) specification,
+   with @nc regressors, on several series of length at most
+   @nobs in turn: see garch_estimate_ws().
+*/
+
+fcpinfo *garch_workspace_new (int nobs, int nc, int p, int q)
+{
+    return fcpinfo_alloc(q, p, nobs, nc, FCP_FULL);
+}
+
+void garch_workspace_free (fcpinfo *f)
+{
+    if (f != NULL) {
+	fcpinfo_destroy(f);
+    }
+}
+
+/* As garch_estimate(), but using the pre-allocated workspace
+   @f, which must match @nc, @p and @q. Since all the state of the
+   estimator lives in @f, distinct workspaces may be used in
+   parallel.
+*/
+
+int garch_estimate_ws (fcpinfo *f, const double *y, const double **X,
+		       int t1, int t2, double *theta, gretl_matrix *V,
+		       double *e, double *e2, double *h,
+		       double scale, double *pll, int *iters,
+		       int vopt, PRN *prn)
+{
+    fcpinfo_set_data(f, t1, t2, y, X, theta, e, e2, h, scale);
+
+    return fcp_estimate(f, V, pll, iters, vopt, prn);
+}
+
 gretl_matrix *
 garch_analytical_hessian (const double *y, const double **X, 
 			  int t1, int t2, int nobs, int nc,
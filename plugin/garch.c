@@ -28,6 +28,12 @@
 
 #include "garch.h"
 
+#if defined(_OPENMP) && !defined(OS_OSX)
+# define GARCH_MP 1
+#else
+# define GARCH_MP 0
+#endif
+
 #define VPARM_DEBUG 0
 
 #define PQ_MAX 7               /* max sum of GARCH p and q */
@@ -967,3 +973,338 @@ MODEL garch_model (const int *cmdlist, DATASET *dset,
 
     return model;
 }
+
+/* Batch estimation of a common GARCH(p, q) specification, with
+   a constant as the only regressor, for each series in a list.
+   This avoids the parts of garch_model() that modify the dataset
+   or call lsq(), so that the series can be handled in parallel;
+   each thread re-uses a single FCP workspace.
+*/
+
+typedef struct garch_batch_ garch_batch;
+typedef struct garch_bws_ garch_bws;
+
+struct garch_batch_ {
+    int p, q;            /* GARCH orders */
+    int npar;            /* number of parameters */
+    int maxlag;          /* max(p, q) */
+    int n;               /* length of working arrays */
+    int vopt;            /* variant of covariance matrix */
+    const DATASET *dset; /* the data */
+    gretl_matrix *coeff; /* npar x nv: estimates */
+    gretl_matrix *se;    /* npar x nv: standard errors */
+    gretl_matrix *lnL;   /* 1 x nv: loglikelihoods */
+    gretl_matrix *h;     /* T x nv: conditional variances */
+    gretl_matrix *errs;  /* 1 x nv: error codes */
+};
+
+/* per-thread workspace */
+
+struct garch_bws_ {
+    fcpinfo *f;
+    double *y;
+    double *one;
+    double *e, *e2, *h;
+    double *theta;
+    gretl_matrix *V;
+};
+
+static void garch_bws_free (garch_bws *w)
+{
+    garch_workspace_free(w->f);
+    free(w->y);
+    free(w->one);
+    free(w->e);
+    free(w->e2);
+    free(w->h);
+    free(w->theta);
+    gretl_matrix_free(w->V);
+}
+
+static int garch_bws_init (garch_bws *w, const garch_batch *gb)
+{
+    int t, n = gb->n;
+
+    w->f = garch_workspace_new(n, 1, gb->p, gb->q);
+    w->y = malloc(n * sizeof *w->y);
+    w->one = malloc(n * sizeof *w->one);
+    w->e = malloc(n * sizeof *w->e);
+    w->e2 = malloc(n * sizeof *w->e2);
+    w->h = malloc(n * sizeof *w->h);
+    w->theta = malloc(gb->npar * sizeof *w->theta);
+    w->V = gretl_zero_matrix_new(gb->npar, gb->npar);
+
+    if (w->f == NULL || w->y == NULL || w->one == NULL ||
+	w->e == NULL || w->e2 == NULL || w->h == NULL ||
+	w->theta == NULL || w->V == NULL) {
+	return E_ALLOC;
+    }
+
+    for (t=0; t<n; t++) {
+	w->one[t] = 1.0;
+	w->y[t] = w->e[t] = w->e2[t] = w->h[t] = 0.0;
+    }
+
+    return 0;
+}
+
+/* Estimate for series @v, writing the results into column @j
+   of the output matrices. The return value is the error code
+   for this series: failure on one series does not stop the
+   batch.
+*/
+
+static int garch_batch_series (garch_batch *gb, garch_bws *w,
+			       int j, int v)
+{
+    const DATASET *dset = gb->dset;
+    const double *x = dset->Z[v];
+    const double *X[1];
+    int glist[4] = {3, gb->p, gb->q, LISTSEP};
+    int t1 = dset->t1, t2 = dset->t2;
+    int off = gb->maxlag;
+    double ybar, s2, scale, sc2;
+    double ll = NADBL;
+    int i, t, T, iters = 0;
+    int err = 0;
+
+    while (t1 <= t2 && na(x[t1])) {
+	t1++;
+    }
+    while (t2 >= t1 && na(x[t2])) {
+	t2--;
+    }
+
+    T = t2 - t1 + 1;
+    if (T <= gb->npar + 1) {
+	return E_DF;
+    }
+
+    for (t=t1; t<=t2; t++) {
+	if (na(x[t])) {
+	    return E_MISSDATA;
+	}
+    }
+
+    /* OLS on a constant, then scale by sigma, as in garch_model() */
+    ybar = gretl_mean(t1, t2, x);
+    s2 = 0.0;
+    for (t=t1; t<=t2; t++) {
+	s2 += (x[t] - ybar) * (x[t] - ybar);
+    }
+    s2 /= T - 1;
+    if (s2 <= 0.0) {
+	return E_DATA;
+    }
+
+    scale = sqrt(s2);
+    sc2 = scale * scale;
+
+    for (t=t1; t<=t2; t++) {
+	w->y[t - t1 + off] = x[t] / scale;
+    }
+
+    w->theta[0] = ybar / scale;
+    garch_vparm_init(glist, 1.0, w->theta + 1);
+    X[0] = w->one;
+
+    err = garch_estimate_ws(w->f, w->y, X, off, off + T - 1,
+			    w->theta, w->V, w->e, w->e2, w->h,
+			    scale, &ll, &iters, gb->vopt, NULL);
+
+    if (!err) {
+	rescale_results(w->theta, w->V, scale, gb->npar, 1);
+	for (i=0; i<gb->npar; i++) {
+	    gretl_matrix_set(gb->coeff, i, j, w->theta[i]);
+	    gretl_matrix_set(gb->se, i, j,
+			     sqrt(gretl_matrix_get(w->V, i, i)));
+	}
+	gb->lnL->val[j] = ll;
+	for (t=t1; t<=t2; t++) {
+	    gretl_matrix_set(gb->h, t - dset->t1, j,
+			     w->h[t - t1 + off] * sc2);
+	}
+    }
+
+    return err;
+}
+
+static char **garch_batch_colnames (const int *list,
+				    const DATASET *dset)
+{
+    char **S = strings_array_new(list[0]);
+    int i;
+
+    if (S != NULL) {
+	for (i=0; i<list[0]; i++) {
+	    S[i] = gretl_strdup(dset->varname[list[i+1]]);
+	}
+    }
+
+    return S;
+}
+
+static char **garch_batch_rownames (int p, int q)
+{
+    char **S = strings_array_new_with_length(p + q + 2, 16);
+    int i, j = 0;
+
+    if (S != NULL) {
+	strcpy(S[j++], "const");
+	strcpy(S[j++], "alpha(0)");
+	for (i=0; i<q; i++) {
+	    sprintf(S[j++], "alpha(%d)", i + 1);
+	}
+	for (i=0; i<p; i++) {
+	    sprintf(S[j++], "beta(%d)", i + 1);
+	}
+    }
+
+    return S;
+}
+
+static gretl_bundle *garch_batch_bundle (garch_batch *gb,
+					 const int *ylist,
+					 int *err)
+{
+    gretl_bundle *b = gretl_bundle_new();
+    gretl_matrix *mats[] = {
+	gb->coeff, gb->se, gb->lnL, gb->h, gb->errs
+    };
+    const char *keys[] = {
+	"coeff", "stderr", "lnL", "h", "errcode"
+    };
+    int i;
+
+    if (b == NULL) {
+	*err = E_ALLOC;
+	return NULL;
+    }
+
+    gretl_matrix_set_rownames(gb->coeff, garch_batch_rownames(gb->p, gb->q));
+    gretl_matrix_set_rownames(gb->se, garch_batch_rownames(gb->p, gb->q));
+
+    for (i=0; i<5; i++) {
+	gretl_matrix_set_colnames(mats[i],
+				  garch_batch_colnames(ylist, gb->dset));
+	gretl_bundle_donate_data(b, keys[i], mats[i],
+				 GRETL_TYPE_MATRIX, 0);
+    }
+
+    gretl_bundle_set_int(b, "p", gb->p);
+    gretl_bundle_set_int(b, "q", gb->q);
+    gretl_bundle_set_int(b, "t1", gb->dset->t1 + 1);
+    gretl_bundle_set_int(b, "t2", gb->dset->t2 + 1);
+
+    return b;
+}
+
+/* Estimate GARCH(@p, @q) with a constant in the mean equation for
+   each series in @ylist via the FCP algorithm, in parallel if
+   possible. Returns a bundle holding the estimates, standard errors
+   and loglikelihoods, the conditional variances and per-series
+   error codes (estimates are NA for series with non-zero code).
+*/
+
+gretl_bundle *garch_batch_estimate (const int *ylist, int p, int q,
+				    const DATASET *dset, int *err)
+{
+    garch_batch gb;
+    garch_bws w;
+    int nv = ylist[0];
+    int T = dset->t2 - dset->t1 + 1;
+    int i;
+
+    if (nv == 0 || p < 0 || q < 0) {
+	*err = E_INVARG;
+	return NULL;
+    } else if (p > 0 && q == 0) {
+	gretl_errmsg_set(_("GARCH: p > 0 and q = 0: the model is unidentified"));
+	*err = E_DATA;
+	return NULL;
+    } else if (p + q > PQ_MAX) {
+	gretl_errmsg_sprintf(_("GARCH: p + q must not exceed %d"), PQ_MAX);
+	*err = E_DATA;
+	return NULL;
+    }
+
+    gb.p = p;
+    gb.q = q;
+    gb.npar = p + q + 2;
+    gb.maxlag = (p > q)? p : q;
+    gb.n = T + gb.maxlag;
+    gb.vopt = get_vopt(0);
+    gb.dset = dset;
+
+    gb.coeff = gretl_matrix_alloc(gb.npar, nv);
+    gb.se = gretl_matrix_alloc(gb.npar, nv);
+    gb.lnL = gretl_matrix_alloc(1, nv);
+    gb.h = gretl_matrix_alloc(T, nv);
+    gb.errs = gretl_zero_matrix_new(1, nv);
+
+    if (gb.coeff == NULL || gb.se == NULL || gb.lnL == NULL ||
+	gb.h == NULL || gb.errs == NULL) {
+	*err = E_ALLOC;
+	goto bailout;
+    }
+
+    for (i=0; i<gb.npar*nv; i++) {
+	gb.coeff->val[i] = gb.se->val[i] = M_NA;
+    }
+    for (i=0; i<nv; i++) {
+	gb.lnL->val[i] = M_NA;
+    }
+    for (i=0; i<T*nv; i++) {
+	gb.h->val[i] = M_NA;
+    }
+
+#if GARCH_MP
+    if (nv > 1 && libset_use_openmp((guint64) nv * T * gb.npar * gb.npar)) {
+	int allerr = 0;
+
+#pragma omp parallel private(w, i)
+	{
+	    int myerr = garch_bws_init(&w, &gb);
+
+#pragma omp for schedule(dynamic)
+	    for (i=0; i<nv; i++) {
+		if (!myerr) {
+		    gb.errs->val[i] = garch_batch_series(&gb, &w, i, ylist[i+1]);
+		}
+	    }
+
+	    if (myerr) {
+#pragma omp critical
+		allerr = myerr;
+	    }
+
+	    garch_bws_free(&w);
+	}
+
+	*err = allerr;
+	goto bailout;
+    }
+#endif
+
+    *err = garch_bws_init(&w, &gb);
+
+    for (i=0; i<nv && !*err; i++) {
+	gb.errs->val[i] = garch_batch_series(&gb, &w, i, ylist[i+1]);
+    }
+
+    garch_bws_free(&w);
+
+ bailout:
+
+    if (!*err) {
+	return garch_batch_bundle(&gb, ylist, err);
+    }
+
+    gretl_matrix_free(gb.coeff);
+    gretl_matrix_free(gb.se);
+    gretl_matrix_free(gb.lnL);
+    gretl_matrix_free(gb.h);
+    gretl_matrix_free(gb.errs);
+
+    return NULL;
+}
@@ -1,6 +1,8 @@
 #ifndef GARCH_H
 #define GARCH_H
 
+typedef struct fcpinfo_ fcpinfo;
+
 int garch_estimate (const double *y, const double **X, 
 		    int t1, int t2, int nobs, int nc,
 		    int p, int q, double *theta, gretl_matrix *V, 
@@ -8,6 +10,16 @@ int garch_estimate (const double *y, const double **X,
 		    double scale, double *pll, int *iters, 
 		    int vopt, PRN *prn);
 
+fcpinfo *garch_workspace_new (int nobs, int nc, int p, int q);
+
+void garch_workspace_free (fcpinfo *f);
+
+int garch_estimate_ws (fcpinfo *f, const double *y, const double **X,
+		       int t1, int t2, double *theta, gretl_matrix *V,
+		       double *e, double *e2, double *h,
+		       double scale, double *pll, int *iters,
+		       int vopt, PRN *prn);
+
 gretl_matrix *
 garch_analytical_hessian (const double *y, const double **X, 
 			  int t1, int t2, int nobs, int nc,
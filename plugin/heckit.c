@@ -67,6 +67,8 @@ struct h_container_ {
     double sigma;
     double rho;
     double lambda;	     /* rho*sigma by definition */
+    double ca, sa;	     /* cosh and sinh of atanh(rho) */
+    int *uidx;		     /* position of each obs in uncensored sample */
 
     gretl_matrix *vcv;	     /* Variance-covariance matrix */
     gretl_matrix *VProbit;   /* 1st stage probit covariance matrix */
@@ -91,6 +93,7 @@ static void h_container_destroy (h_container *HC)
 
     free(HC->Xlist);
     free(HC->Zlist);
+    free(HC->uidx);
 
     gretl_matrix_free(HC->y);
     gretl_matrix_free(HC->reg);
@@ -134,6 +137,7 @@ static h_container *h_container_new (const int *list)
 
     HC->Xlist = NULL;
     HC->Zlist = NULL;
+    HC->uidx = NULL;
 
     HC->y = NULL;
     HC->reg = NULL;
@@ -439,7 +443,23 @@ static int h_container_fill (h_container *HC, const int *Xl,
     }
 
     if (!err) {
+	int i, j = 0;
+
 	HC->ntot = gretl_matrix_rows(HC->d);
+	/* record the index into the uncensored sample of each
+	   selected observation, so that the likelihood can be
+	   evaluated for any subset of the observations */
+	HC->uidx = malloc(HC->ntot * sizeof *HC->uidx);
+	if (HC->uidx == NULL) {
+	    err = E_ALLOC;
+	} else {
+	    for (i=0; i<HC->ntot; i++) {
+		HC->uidx[i] = (HC->d->val[i] == 1.0)? j++ : -1;
+	    }
+	}
+    }
+
+    if (!err) {
 	/* Mills ratio vector */
 	tmplist[1] = HC->millsvar;
 	HC->mills = gretl_matrix_data_subset_masked(tmplist, dset,
@@ -588,61 +608,44 @@ static int h_common_setup (h_container *HC, const double *param,
 	err = E_NAN;
     } else {
 	HC->rho = tanh(arho);
-	*ca = cosh(arho);
-	*sa = sinh(arho);
+	*ca = HC->ca = cosh(arho);
+	*sa = HC->sa = sinh(arho);
 	err = setup_ndx_functions(HC);
     }
 
     return err;
 }
 
-static double h_loglik (const double *param, void *ptr)
-{
-    h_container *HC = (h_container *) ptr;
-    double ll0 = 0, ll1 = 0, ll2 = 0;
-    double ca, sa, ndxt, ut = 0;
-    double P, mills, tmp, psum;
-    double lnsig, x, ll = NADBL;
-    int sel, k, kmax, npar; 
-    int i, j, jj;
-    int err;
-
-    err = h_common_setup(HC, param, &ca, &sa);
-    if (err) {
-	return NADBL;
-    }
-
-    kmax = HC->kmain + HC->ksel;
-    npar = kmax + 2;
-
-    lnsig = log(HC->sigma);
-    
-#if HDEBUG > 1
-    gretl_matrix_print(HC->beta, "beta");
-    gretl_matrix_print(HC->gama, "gama");
-    fprintf(stderr, "sigma = %12.6f, rho = %12.6f\n", HC->sigma, HC->rho);
-#endif
-
-    gretl_matrix_zero(HC->score);
-    gretl_matrix_zero(HC->sscore);
+/* loglikelihood and score for observations @s0 to @s1 - 1,
+   for use with ll_block_sum(); the per-observation score is
+   written into HC->score */
 
-    /* i goes through all obs, while j keeps track of the uncensored
-       ones */
-    j = 0;
-    for (i=0; i<HC->ntot; i++) {
-	sel = (gretl_vector_get(HC->d, i) == 1.0);
+static int h_ll_block (void *data, int s0, int s1,
+		       double *ll, double *g)
+{
+    h_container *HC = data;
+    double ca = HC->ca, sa = HC->sa;
+    double lnsig = log(HC->sigma);
+    double ndxt, ut = 0;
+    double P, mills, tmp, x;
+    int npar = HC->kmain + HC->ksel + 2;
+    int sel, i, j, k, jj;
+
+    for (i=s0; i<s1; i++) {
+	j = HC->uidx[i];
+	sel = (j >= 0);
 	ndxt = gretl_vector_get(HC->ndx, i);
 	if (sel) {
 	    ut = gretl_vector_get(HC->u, j);
 	    x = ca * (ndxt + HC->rho*ut);
-	    ll1 -= LN_SQRT_2_PI + 0.5*ut*ut + lnsig;
+	    *ll -= LN_SQRT_2_PI + 0.5*ut*ut + lnsig;
 	    P = normal_cdf(x);
 	    mills = invmills(-x);
-	    ll2 += log(P);
+	    *ll += log(P);
 	} else {
 	    P = normal_cdf(-ndxt);
 	    mills = -invmills(ndxt);
-	    ll0 += log(P);
+	    *ll += log(P);
 	}
 
 	/* score for beta */
@@ -651,8 +654,7 @@ static double h_loglik (const double *param, void *ptr)
 	    for (k=0; k<HC->kmain; k++) {
 		x = tmp * gretl_matrix_get(HC->reg, j, k);
 		gretl_matrix_set(HC->score, i, k, x); 
-		psum = x + gretl_vector_get(HC->sscore, k);
-		gretl_vector_set(HC->sscore, k, psum);
+		g[k] += x;
 	    }
 	}
 
@@ -662,36 +664,50 @@ static double h_loglik (const double *param, void *ptr)
 	    jj = HC->kmain + k;
 	    x = tmp * gretl_matrix_get(HC->selreg, i, k);
 	    gretl_matrix_set(HC->score, i, jj, x); 
-	    psum = x + gretl_vector_get(HC->sscore, HC->kmain+k);
-	    gretl_vector_set(HC->sscore, jj, psum);
+	    g[jj] += x;
 	}
 
 	/* score for sigma and arho */
 	if (sel) {
 	    x = (ut * (ut - sa*mills) - 1) / HC->sigma;
 	    gretl_matrix_set(HC->score, i, npar-2, x); 
-	    psum = x + gretl_vector_get(HC->sscore, npar-2);
-	    gretl_vector_set(HC->sscore, npar-2, psum);
+	    g[npar-2] += x;
 
 	    x = mills * ca * (ut + HC->rho*ndxt);
 	    gretl_matrix_set(HC->score, i, npar-1, x); 
-	    psum = x + gretl_vector_get(HC->sscore, npar-1);
-	    gretl_vector_set(HC->sscore, npar-1, psum);
+	    g[npar-1] += x;
 	}
+    }
 
-	if (sel) {
-	    j++;
-	}
+    return 0;
+}
+
+static double h_loglik (const double *param, void *ptr)
+{
+    h_container *HC = (h_container *) ptr;
+    double ca, sa, ll = NADBL;
+    int err;
+
+    err = h_common_setup(HC, param, &ca, &sa);
+    if (err) {
+	return NADBL;
     }
+    
+#if HDEBUG > 1
+    gretl_matrix_print(HC->beta, "beta");
+    gretl_matrix_print(HC->gama, "gama");
+    fprintf(stderr, "sigma = %12.6f, rho = %12.6f\n", HC->sigma, HC->rho);
+#endif
 
-    ll = ll0 + ll1 + ll2;
+    gretl_matrix_zero(HC->score);
+    err = ll_block_sum(h_ll_block, HC, HC->ntot, HC->kmain + HC->ksel + 2,
+		       &ll, HC->sscore->val);
 
 #if HDEBUG
-    fprintf(stderr, "ll0 = %g, ll1 = %g, ll2 = %g: ll = %g (ntot = %d)\n", 
-	    ll0, ll1, ll2, ll, HC->ntot);
+    fprintf(stderr, "ll = %g (ntot = %d)\n", ll, HC->ntot);
 #endif
     
-    return ll;
+    return err ? NADBL : ll;
 }
 
 static int heckit_score (double *theta, double *s, int npar, BFGS_CRIT_FUNC ll, 
@@ -51,6 +51,7 @@ struct int_container_ {
     int nx;           /* number of explanatory variables */
     int k;            /* total number of parameters */
     double *theta;    /* real parameter estimates */
+    const double *th; /* parameters at current evaluation point */
     double *ndx;      /* index variable */
     double *uhat;     /* generalized residuals */
     double *dP;       /* probabilities */
@@ -104,6 +105,7 @@ static int_container *int_container_new (int *list, DATASET *dset,
     IC->dspace = NULL;
 
     IC->theta = IC->g = NULL;
+    IC->th = NULL;
     IC->X = IC->G = NULL;
     
     IC->obstype = NULL;
@@ -249,13 +251,14 @@ static int create_midpoint_y (int *list, DATASET *dset,
     return err;
 }
 
-static void loglik_prelim (const double *theta, int_container *IC)
+static void loglik_prelim_range (const double *theta, int_container *IC,
+				 int s0, int s1)
 {
     int i, t, k = IC->k;
     double ndxt, z0, z1, x0, x1, xti;
     double sigma = exp(theta[k-1]);
 
-    for (t=0; t<IC->nobs; t++) {
+    for (t=s0; t<s1; t++) {
 	ndxt = 0.0;
 	for (i=0; i<IC->nx; i++) {
 	    xti = gretl_matrix_get(IC->X, t, i);
@@ -306,23 +309,26 @@ static void loglik_prelim (const double *theta, int_container *IC)
     }
 }
 
-static double interval_loglik (const double *theta, void *ptr)
+static void loglik_prelim (const double *theta, int_container *IC)
+{
+    loglik_prelim_range(theta, IC, 0, IC->nobs);
+}
+
+/* loglikelihood and score for observations @s0 to @s1 - 1 */
+
+static int interval_ll_block (void *ptr, int s0, int s1,
+			      double *ll, double *g)
 {
     int_container *IC = (int_container *) ptr;
     double x0, x1, z0, z1, gti;
     double derivs = 0.0, derivb = 0.0;
-    double sigma, ndxt, ll = 0.0;
+    double sigma, ndxt;
     int i, t, k = IC->k;
 
-    sigma = exp(theta[k-1]);
-
-    for (i=0; i<k; i++) {
-	IC->g[i] = 0;
-    }
-
-    loglik_prelim(theta, IC);
+    sigma = exp(IC->th[k-1]);
+    loglik_prelim_range(IC->th, IC, s0, s1);
 
-    for (t=0; t<IC->nobs; t++) {
+    for (t=s0; t<s1; t++) {
 	x0 = IC->lo[t];
 	x1 = IC->hi[t];
 	ndxt = IC->ndx[t];
@@ -351,26 +357,46 @@ static double interval_loglik (const double *theta, void *ptr)
 	    derivs = z0*z0 - 1;
 	}
 
-	ll += log(IC->dP[t]);
+	*ll += log(IC->dP[t]);
 
 	for (i=0; i<IC->nx; i++) {
 	    gti = derivb * gretl_matrix_get(IC->X, t, i);
 	    gretl_matrix_set(IC->G, t, i, gti);
-	    IC->g[i] += gti; 
+	    g[i] += gti; 
 	}
 
 	gretl_matrix_set(IC->G, t, k-1, derivs);
-	IC->g[k-1] += derivs;
+	g[k-1] += derivs;
     }
 
+    return 0;
+}
+
+static double interval_loglik (const double *theta, void *ptr)
+{
+    int_container *IC = (int_container *) ptr;
+    double ll = NADBL;
+    int err;
+
+    IC->th = theta;
+    err = ll_block_sum(interval_ll_block, IC, IC->nobs, IC->k,
+		       &ll, IC->g);
+    IC->th = NULL;
+
+    if (err) {
+	return NADBL;
+    }
 
 #if INTDEBUG > 1
-    fprintf(stderr, "ll = %16.10f\n", ll);
+    {
+	int i;
 
-    for (i=0; i<IC->k; i++) {
-	fprintf(stderr, "g[%d] = %16.10f\t", i, IC->g[i]);
+	fprintf(stderr, "ll = %16.10f\n", ll);
+	for (i=0; i<IC->k; i++) {
+	    fprintf(stderr, "g[%d] = %16.10f\t", i, IC->g[i]);
+	}
+	fputc('\n', stderr);
     }
-    fputc('\n', stderr);
 #endif
 
     return ll;
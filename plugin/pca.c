@@ -402,7 +402,20 @@ int pca_from_cmatrix (VMatrix *cmat, DATASET *dset,
     gretl_matrix_print(C, "original C, in pca");
 #endif
 
-    evals = gretl_symm_matrix_eigenvals_descending(C, 1, &err);
+    if ((opt & OPT_Q) && !(opt & OPT_A) && nsave > 0 && nsave < k) {
+	/* results not printed and not all components wanted:
+	   we need only the leading @nsave eigenvectors */
+	gretl_matrix *V = NULL;
+
+	evals = gretl_symmetric_matrix_eigenvals_partial(C, nsave, &V, &err);
+	if (!err) {
+	    gretl_matrix_free(C);
+	    C = V;
+	    err = gretl_symmetric_eigen_sort(evals, C, 0);
+	}
+    } else {
+	evals = gretl_symm_matrix_eigenvals_descending(C, 1, &err);
+    }
 
 #if PCA_DEBUG
     gretl_matrix_print(C, "revised C (eigenvecs)");
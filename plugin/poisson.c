@@ -45,6 +45,7 @@ struct negbin_info_ {
     int type;              /* variance type: 1 or 2 */
     int flags;             /* control info */
     double ll;             /* loglikelihood */
+    double alpha;          /* alpha at the current evaluation point */
     int k;                 /* number of regressors */
     int T;                 /* number of observations */
     double *theta;         /* params array, length k + 1 */
@@ -167,27 +168,22 @@ static int negbin_update_mu (negbin_info *nbinfo, const double *theta)
     return err;
 }
 
-static double negbin_loglik (const double *theta, void *data)
+/* loglikelihood for observations @s0 to @s1 - 1: since this
+   may run in a worker thread, the error indicators are checked
+   here */
+
+static int negbin_ll_block (void *data, int s0, int s1,
+			    double *llsum, double *g)
 {
     negbin_info *nbinfo = (negbin_info *) data;
-    double alpha = theta[nbinfo->k];
+    double alpha = nbinfo->alpha;
     double *ll = nbinfo->llt->val;
-    double *mu = nbinfo->mu->val;
-    double *y = nbinfo->y->val;
+    const double *mu = nbinfo->mu->val;
+    const double *y = nbinfo->y->val;
     double psi = 0, lgpsi = 0;
     double mpp, rat;
-    int t, err = 0;
-
-    if (alpha <= 0) {
-	return NADBL;
-    }
-
-    err = negbin_update_mu(nbinfo, theta);
-    if (err) {
-	return NADBL;
-    }
+    int t;
 
-    nbinfo->ll = 0.0;
     errno = 0;
 
     if (nbinfo->type == 2) {
@@ -197,7 +193,7 @@ static double negbin_loglik (const double *theta, void *data)
 	lgpsi = ln_gamma(psi);
     }
 
-    for (t=0; t<nbinfo->T; t++) {
+    for (t=s0; t<s1; t++) {
 	if (nbinfo->type == 1) {
 	    psi = mu[t]/alpha;
 	    lgpsi = ln_gamma(psi);
@@ -208,39 +204,53 @@ static double negbin_loglik (const double *theta, void *data)
 
 	ll[t] = ln_gamma(y[t] + psi) - lgpsi - ln_gamma(y[t] + 1.0);
 	ll[t] += psi * log(rat) + y[t] * log(1-rat);
-	nbinfo->ll += ll[t];
+	*llsum += ll[t];
     }
 
-    if (errno || get_cephes_errno()) {
+    return (errno || get_cephes_errno()) ? E_NAN : 0;
+}
+
+static double negbin_loglik (const double *theta, void *data)
+{
+    negbin_info *nbinfo = (negbin_info *) data;
+    int err;
+
+    nbinfo->alpha = theta[nbinfo->k];
+    if (nbinfo->alpha <= 0) {
+	return NADBL;
+    }
+
+    err = negbin_update_mu(nbinfo, theta);
+    if (err) {
+	return NADBL;
+    }
+
+    err = ll_block_sum(negbin_ll_block, nbinfo, nbinfo->T, 0,
+		       &nbinfo->ll, NULL);
+    if (err) {
 	nbinfo->ll = NADBL;
     }
 
     return nbinfo->ll;
 }
 
-static int negbin_score (double *theta, double *g, int np, BFGS_CRIT_FUNC ll, 
-			 void *data)
+/* score for observations @s0 to @s1 - 1, written into
+   nbinfo->G and summed into @g */
+
+static int negbin_score_block (void *data, int s0, int s1,
+			       double *ll, double *g)
 {
     negbin_info *nbinfo = (negbin_info *) data;
     double dpsi_dmu, dmu_dbi, dpsi_da = 0;
     double dl_dpsi, dl_dmu, dl_da;
     const double *y = nbinfo->y->val;
     const double *mu = nbinfo->mu->val;
-    double alpha = theta[nbinfo->k];
+    double alpha = nbinfo->alpha;
     double a2 = alpha * alpha;
     double psi = 0, dgpsi = 0;
     double mpp, gti;
-    int i, t, err = 0;
-
-    if (nbinfo->flags == SCORE_UPDATE_MU) {
-	negbin_update_mu(nbinfo, theta);
-    }
-
-    if (g != NULL) {
-	for (i=0; i<np; i++) {
-	    g[i] = 0.0;
-	}
-    }    
+    int np = nbinfo->k + 1;
+    int i, t;
 
     if (nbinfo->type == 1) {
 	dpsi_dmu = 1/alpha;
@@ -251,7 +261,7 @@ static int negbin_score (double *theta, double *g, int np, BFGS_CRIT_FUNC ll,
 	dpsi_da = -1/a2;
     }	 
 
-    for (t=0; t<nbinfo->T; t++) {
+    for (t=s0; t<s1; t++) {
 	if (nbinfo->type == 1) {
 	    psi = mu[t]/alpha;
 	    dgpsi = digamma(psi);
@@ -272,12 +282,41 @@ static int negbin_score (double *theta, double *g, int np, BFGS_CRIT_FUNC ll,
 		gti = dl_da;
 	    }
 	    gretl_matrix_set(nbinfo->G, t, i, gti);
-	    if (g != NULL) {
-		g[i] += gti;
-	    }
+	    g[i] += gti;
 	}
     }
 
+    return 0;
+}
+
+static int negbin_score (double *theta, double *g, int np, BFGS_CRIT_FUNC ll, 
+			 void *data)
+{
+    negbin_info *nbinfo = (negbin_info *) data;
+    double llsum, *gsum = g;
+    int err;
+
+    if (nbinfo->flags == SCORE_UPDATE_MU) {
+	negbin_update_mu(nbinfo, theta);
+    }
+
+    nbinfo->alpha = theta[nbinfo->k];
+
+    if (g == NULL) {
+	/* we just want nbinfo->G */
+	gsum = malloc(np * sizeof *gsum);
+	if (gsum == NULL) {
+	    return E_ALLOC;
+	}
+    }
+
+    err = ll_block_sum(negbin_score_block, nbinfo, nbinfo->T, np,
+		       &llsum, gsum);
+
+    if (g == NULL) {
+	free(gsum);
+    }
+
     return err;
 }
 
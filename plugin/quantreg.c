@@ -31,6 +31,10 @@
 
 #include <errno.h>
 
+#if defined(_OPENMP)
+# include <omp.h>
+#endif
+
 #define QDEBUG 0
 
 /* Frisch-Newton algorithm: we use this if we're not computing
@@ -122,6 +126,11 @@ struct fn_info {
     double *coeff;
     integer nit[3];
     integer info;
+    int pfn, pfn_m;
+    guint64 pfn_state;
+    int warm;
+    double *bwarm;
+    gretl_matrix *L;
     void (*callback)();
 };
 
@@ -130,6 +139,8 @@ struct fn_info {
 static void fn_info_free (struct fn_info *rq)
 {
     free(rq->rspace);
+    free(rq->bwarm);
+    gretl_matrix_free(rq->L);
 }
 
 static void br_info_free (struct br_info *rq)
@@ -591,6 +602,7 @@ static int br_info_alloc (struct br_info *rq, int n, int p,
     rq->ispace = NULL;
     rq->ci = NULL;
     rq->tnmat = NULL;
+    rq->warning = 0;
 
     rq->n5 = n + 5;
     rq->p3 = p + 3;
@@ -633,7 +645,6 @@ static int br_info_alloc (struct br_info *rq, int n, int p,
     rq->s = rq->ispace;
     rq->h = rq->s + n;
 
-    rq->warning = 0;
     rq->n = n;
     rq->p = p;
     rq->tau = tau;
@@ -704,6 +715,60 @@ static int real_br_calc (gretl_matrix *y, gretl_matrix *X,
     return err;
 }
 
+/* Portnoy-Koenker "preprocessing" for large n: solve the problem
+   on a subsample of size m, use the subsample fit to identify
+   observations whose residuals are almost certainly negative
+   (or positive) at the full-sample solution, collapse each of
+   these sets into a single "globbed" pseudo-observation, and
+   solve the reduced problem. If the signs of the residuals of
+   the fixed observations turn out to be wrong, release the
+   offenders and try again; if there are too many of them, start
+   over with a larger subsample. See Portnoy and Koenker, "The
+   Gaussian Hare and the Laplacian Tortoise", Statistical
+   Science, 1997.
+*/
+
+#define PFN_MIN_N 100000
+#define PFN_MAX_BAD 3
+#define PFN_M_FACTOR 0.8
+
+static int pfn_subsample_size (int n, int p)
+{
+    return (int) floor(pow((p + 1.0) * n, 2.0/3) + 0.5);
+}
+
+#define pfn_wanted(n,p) ((n) >= PFN_MIN_N && 2 * pfn_subsample_size(n, p) < (n))
+
+/* Random subsamples for the preprocessing variant are drawn from
+   a private stream for each tau value (splitmix64), seeded from a
+   fixed constant mixed with the problem dimensions. The samples
+   therefore do not depend on thread scheduling, and estimation
+   leaves the user's RNG state untouched.
+*/
+
+static guint32 pfn_seed (int n, int p)
+{
+    return 0x7e1f2a6bu ^ ((guint32) n * 2654435761u) ^ (guint32) p;
+}
+
+static void pfn_stream_init (struct fn_info *rq, guint32 seed, int i)
+{
+    rq->pfn_state = ((guint64) seed << 32) ^ (guint64) i;
+}
+
+static double pfn_rand_01 (guint64 *state)
+{
+    guint64 z;
+
+    *state += G_GUINT64_CONSTANT(0x9E3779B97F4A7C15);
+    z = *state;
+    z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT(0x94D049BB133111EB);
+    z ^= z >> 31;
+
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
 /* allocate workspace for F-N algorithm */
 
 static int fn_info_alloc (struct fn_info *rq, int n, int p,
@@ -722,12 +787,26 @@ static int fn_info_alloc (struct fn_info *rq, int n, int p,
     pp4 = rp * (rp + 4);
     rsize = rp + n + n + n10 + pp4;
 
+    rq->bwarm = NULL;
+    rq->L = NULL;
+    rq->pfn_m = rq->warm = 0;
+    rq->pfn = pfn_wanted(n, p);
+    rq->pfn_state = 0;
+
     rq->rspace = malloc(rsize * sizeof *rq->rspace);
 
     if (rq->rspace == NULL) {
 	return E_ALLOC;
     }
 
+    if (rq->pfn) {
+	rq->bwarm = malloc(p * sizeof *rq->bwarm);
+	rq->L = gretl_matrix_alloc(p, p);
+	if (rq->bwarm == NULL || rq->L == NULL) {
+	    return E_ALLOC;
+	}
+    }
+
     rq->rhs = rq->rspace;
     rq->d   = rq->rhs + rp;
     rq->u   = rq->d + n;
@@ -793,6 +872,327 @@ static int rq_call_FN (integer *n, integer *p, gretl_matrix *XT,
 		  rq->callback);
 }
 
+/* select a random subsample of exactly @m of the @n observations,
+   in their original order (Knuth's "selection sampling")
+*/
+
+static gretl_matrix *pfn_subsample (const gretl_matrix *XT,
+				    const gretl_matrix *y,
+				    int m, guint64 *state,
+				    gretl_matrix **pys)
+{
+    gretl_matrix *XS;
+    int n = XT->cols;
+    int p = XT->rows;
+    int i, t, s = 0;
+
+    XS = gretl_matrix_alloc(p, m);
+    *pys = gretl_column_vector_alloc(m);
+
+    if (XS == NULL || *pys == NULL) {
+	gretl_matrix_free(XS);
+	gretl_matrix_free(*pys);
+	*pys = NULL;
+	return NULL;
+    }
+
+    for (t=0; t<n && s<m; t++) {
+	if ((n - t) * pfn_rand_01(state) < m - s) {
+	    for (i=0; i<p; i++) {
+		gretl_matrix_set(XS, i, s, gretl_matrix_get(XT, i, t));
+	    }
+	    (*pys)->val[s++] = y->val[t];
+	}
+    }
+
+    return XS;
+}
+
+/* Given the Cholesky factor L of the subsample X'X, write into
+   @band the quantity sqrt(x_t' (X'X)^{-1} x_t) for each
+   observation, via forward substitution.
+*/
+
+static void pfn_make_band (const gretl_matrix *XT,
+			   const gretl_matrix *L,
+			   double *v, double *band)
+{
+    int n = XT->cols;
+    int p = XT->rows;
+    double x, ss;
+    int i, j, t;
+
+    for (t=0; t<n; t++) {
+	ss = 0.0;
+	for (i=0; i<p; i++) {
+	    x = gretl_matrix_get(XT, i, t);
+	    for (j=0; j<i; j++) {
+		x -= gretl_matrix_get(L, i, j) * v[j];
+	    }
+	    v[i] = x / gretl_matrix_get(L, i, i);
+	    ss += v[i] * v[i];
+	}
+	band[t] = sqrt(ss);
+    }
+}
+
+static void pfn_residuals (const gretl_matrix *XT,
+			   const gretl_matrix *y,
+			   const double *b, double *r)
+{
+    int n = XT->cols;
+    int p = XT->rows;
+    int i, t;
+
+    for (t=0; t<n; t++) {
+	r[t] = y->val[t];
+	for (i=0; i<p; i++) {
+	    r[t] -= gretl_matrix_get(XT, i, t) * b[i];
+	}
+    }
+}
+
+/* Build the reduced problem: the observations not flagged in
+   @fix, plus up to two globs (sums of the observations flagged
+   as lying below, fix = 1, and above, fix = 2, the fit).
+*/
+
+static gretl_matrix *pfn_reduced_problem (const gretl_matrix *XT,
+					  const gretl_matrix *y,
+					  const char *fix,
+					  gretl_matrix **pyr)
+{
+    gretl_matrix *XR;
+    int n = XT->cols;
+    int p = XT->rows;
+    int nlo = 0, nhi = 0, nr = 0;
+    int g, i, s, t;
+
+    for (t=0; t<n; t++) {
+	if (fix[t] == 1) {
+	    nlo++;
+	} else if (fix[t] == 2) {
+	    nhi++;
+	} else {
+	    nr++;
+	}
+    }
+
+    nr += (nlo > 0) + (nhi > 0);
+
+    XR = gretl_zero_matrix_new(p, nr);
+    *pyr = gretl_zero_matrix_new(nr, 1);
+
+    if (XR == NULL || *pyr == NULL) {
+	gretl_matrix_free(XR);
+	gretl_matrix_free(*pyr);
+	*pyr = NULL;
+	return NULL;
+    }
+
+    s = 0;
+    for (t=0; t<n; t++) {
+	if (fix[t] == 0) {
+	    g = s++;
+	} else if (fix[t] == 1) {
+	    g = nr - 1 - (nhi > 0);
+	} else {
+	    g = nr - 1;
+	}
+	for (i=0; i<p; i++) {
+	    XR->val[g*p+i] += gretl_matrix_get(XT, i, t);
+	}
+	(*pyr)->val[g] += y->val[t];
+    }
+
+    return XR;
+}
+
+static int rq_call_PFN (integer *n, integer *p, gretl_matrix *XT,
+			gretl_matrix *y, struct fn_info *rq,
+			double tau)
+{
+    gretl_matrix *XS = NULL, *ys = NULL;
+    gretl_matrix *XR = NULL, *yr = NULL;
+    gretl_matrix *L = rq->L;
+    double *r = NULL, *band = NULL;
+    double *z = NULL, *b = NULL;
+    double M, q[2], eps = rq->eps;
+    char *fix = NULL;
+    int N = *n, P = *p;
+    int m = pfn_subsample_size(N, P);
+    int warm = rq->warm;
+    int optimal = 0;
+    int t, err = 0;
+
+    r = malloc(3 * N * sizeof *r);
+    fix = calloc(N, 1);
+
+    if (r == NULL || fix == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    band = r + N;
+    z = band + N;
+    b = rq->coeff;
+
+    while (!optimal && !err && m < N) {
+	integer ns = m, nr;
+	int nbad, bad_fixup = 0;
+
+	if (warm) {
+	    /* start from the solution at a neighbouring tau,
+	       re-using the band from its subsample */
+	    memcpy(b, rq->bwarm, P * sizeof *b);
+	    m = rq->pfn_m;
+	    warm = 0;
+	} else {
+	    /* fit on a random subsample */
+	    XS = pfn_subsample(XT, y, m, &rq->pfn_state, &ys);
+	    if (XS == NULL) {
+		err = E_ALLOC;
+		break;
+	    }
+	    err = rq_call_FN(&ns, p, XS, ys, rq, tau);
+	    if (!err) {
+		gretl_matrix_multiply_mod(XS, GRETL_MOD_NONE,
+					  XS, GRETL_MOD_TRANSPOSE,
+					  L, GRETL_MOD_NONE);
+		err = gretl_matrix_cholesky_decomp(L);
+	    }
+	    gretl_matrix_free(XS);
+	    gretl_matrix_free(ys);
+	    XS = ys = NULL;
+	    if (err) {
+		/* the subsample problem may be degenerate even
+		   when the full one is not: fall back on the latter */
+		err = 0;
+		break;
+	    }
+	}
+
+	/* find the observations whose residual signs are
+	   "certain", given the subsample fit */
+	pfn_residuals(XT, y, b, r);
+	pfn_make_band(XT, L, z, band);
+	for (t=0; t<N; t++) {
+	    z[t] = r[t] / (band[t] > eps ? band[t] : eps);
+	}
+	M = PFN_M_FACTOR * m;
+	q[0] = tau - M / (2.0 * N);
+	q[1] = tau + M / (2.0 * N);
+	q[0] = q[0] < 1.0 / N ? 1.0 / N : q[0];
+	q[1] = q[1] > (N - 1.0) / N ? (N - 1.0) / N : q[1];
+	gretl_array_quantiles(z, N, q, 2);
+	for (t=0; t<N; t++) {
+	    if (!na(q[0]) && r[t] < band[t] * q[0]) {
+		fix[t] = 1;
+	    } else if (!na(q[1]) && r[t] > band[t] * q[1]) {
+		fix[t] = 2;
+	    } else {
+		fix[t] = 0;
+	    }
+	}
+
+	while (!optimal && !err && bad_fixup < PFN_MAX_BAD) {
+	    XR = pfn_reduced_problem(XT, y, fix, &yr);
+	    if (XR == NULL) {
+		err = E_ALLOC;
+		break;
+	    }
+	    nr = XR->cols;
+	    err = rq_call_FN(&nr, p, XR, yr, rq, tau);
+	    gretl_matrix_free(XR);
+	    gretl_matrix_free(yr);
+	    XR = yr = NULL;
+	    if (err) {
+		break;
+	    }
+
+	    /* check the signs of the fixed residuals */
+	    pfn_residuals(XT, y, b, r);
+	    nbad = 0;
+	    for (t=0; t<N; t++) {
+		if ((fix[t] == 1 && r[t] > 0) || (fix[t] == 2 && r[t] < 0)) {
+		    fix[t] = 3;
+		    nbad++;
+		}
+	    }
+	    if (nbad == 0) {
+		optimal = 1;
+	    } else if (nbad > 0.1 * M) {
+		/* too many fixups: double the subsample size */
+		m *= 2;
+		break;
+	    } else {
+		for (t=0; t<N; t++) {
+		    if (fix[t] == 3) {
+			fix[t] = 0;
+		    }
+		}
+		if (++bad_fixup == PFN_MAX_BAD) {
+		    /* repeated fixups: try a bigger subsample, or
+		       the full problem if @m reaches @N */
+		    m *= 2;
+		}
+	    }
+	}
+#if QDEBUG
+	fprintf(stderr, "rq_call_PFN: m = %d, optimal = %d\n", m, optimal);
+#endif
+    }
+
+    if (!err && !optimal) {
+	/* fall back on the full problem */
+	err = rq_call_FN(n, p, XT, y, rq, tau);
+    } else if (!err) {
+	/* pass back full-sample residuals, as from rq_call_FN */
+	for (t=0; t<N; t++) {
+	    rq->resid[t] = r[t];
+	}
+	rq->pfn_m = m;
+    }
+
+ bailout:
+
+    free(r);
+    free(fix);
+
+    return err;
+}
+
+/* Solve the problem on the full sample, using the preprocessing
+   variant if this was flagged as worthwhile at allocation time;
+   artificial sub-problems go straight to Frisch-Newton.
+*/
+
+static int rq_solve (integer *n, integer *p, gretl_matrix *XT,
+		     gretl_matrix *y, struct fn_info *rq,
+		     double tau)
+{
+    if (rq->pfn && *n == rq->n) {
+	return rq_call_PFN(n, p, XT, y, rq, tau);
+    } else {
+	return rq_call_FN(n, p, XT, y, rq, tau);
+    }
+}
+
+/* Record the full-sample solution just obtained so that the
+   preprocessing solves at tau +/- h for the covariance matrix can
+   start from it instead of from a fresh subsample. This is not
+   carried across tau values, so as to keep the results for each
+   tau independent of the order in which they're computed.
+*/
+
+static void rq_set_warm_start (struct fn_info *rq)
+{
+    if (rq->pfn && rq->pfn_m > 0) {
+	memcpy(rq->bwarm, rq->coeff, rq->p * sizeof *rq->bwarm);
+	rq->warm = 1;
+    }
+}
+
 static int rq_write_variance (const gretl_matrix *V,
 			      MODEL *pmod, double *se)
 {
@@ -962,7 +1362,7 @@ static int rq_fn_nid_VCV (MODEL *pmod, gretl_matrix *y,
 	goto bailout;
     }
 	
-    err = rq_call_FN(&n, &p, XT, y, rq, tau + h);
+    err = rq_solve(&n, &p, XT, y, rq, tau + h);
     if (err) {
 	fprintf(stderr, "tau + h: info = %d\n", rq->info);
 	goto bailout;
@@ -973,7 +1373,7 @@ static int rq_fn_nid_VCV (MODEL *pmod, gretl_matrix *y,
 	p1->val[i] = rq->coeff[i];
     }
 
-    err = rq_call_FN(&n, &p, XT, y, rq, tau - h);
+    err = rq_solve(&n, &p, XT, y, rq, tau - h);
     if (err) {
 	fprintf(stderr, "tau - h: info = %d\n", rq->info);
 	goto bailout;
@@ -1105,6 +1505,91 @@ write_tbeta_block_fn (gretl_matrix *tbeta, int nt, double *x,
     return 0;
 }
 
+/* B-R estimation at a given tau, including the confidence
+   intervals */
+
+static int rq_br_tau_step (gretl_matrix *y, gretl_matrix *X,
+			   double tau, gretlopt opt,
+			   struct br_info *rq)
+{
+    int err;
+
+    rq->tau = tau;
+
+    /* preliminary calculations relating to confidence intervals */
+    if (opt & OPT_R) {
+	/* robust variant */
+	err = make_nid_qn(y, X, rq);
+    } else {
+	/* assuming iid errors */
+	err = make_iid_qn(X, rq->qn);
+    }
+
+    if (!err) {
+	/* get the actual estimates */
+	err = real_br_calc(y, X, tau, rq, 1);
+    }
+
+    if (!err) {
+	/* post-process confidence intervals */
+	err = rq_interpolate_intervals(rq);
+    }
+
+    return err;
+}
+
+#if defined(_OPENMP)
+
+/* Handle multiple tau values in parallel, giving each thread
+   its own workspace */
+
+static int rq_br_process_mp (gretl_matrix *y, gretl_matrix *X,
+			     const gretl_vector *tauvec,
+			     double alpha, gretlopt opt,
+			     gretl_matrix *tbeta, int *warning)
+{
+    int ntau = gretl_vector_get_length(tauvec);
+    int n = y->rows;
+    int p = X->cols;
+    int err = 0;
+
+#pragma omp parallel
+    {
+	struct br_info rq;
+	int i, myerr;
+
+	myerr = br_info_alloc(&rq, n, p, tauvec->val[0], alpha, opt);
+	rq.callback = NULL;
+
+#pragma omp for schedule(static)
+	for (i=0; i<ntau; i++) {
+	    if (!myerr) {
+		myerr = rq_br_tau_step(y, X, tauvec->val[i], opt, &rq);
+	    }
+	    if (!myerr) {
+		myerr = write_tbeta_block_br(tbeta, ntau, rq.coeff,
+					     rq.ci, i);
+	    }
+	}
+
+#pragma omp critical
+	{
+	    if (myerr && !err) {
+		err = myerr;
+	    }
+	    if (rq.warning) {
+		*warning = 1;
+	    }
+	}
+
+	br_info_free(&rq);
+    }
+
+    return err;
+}
+
+#endif /* _OPENMP */
+
 /* Sub-driver for Barrodale-Roberts estimation, with confidence
    intervals.
 */
@@ -1119,6 +1604,7 @@ static int rq_fit_br (gretl_matrix *y, gretl_matrix *X,
     integer p = X->cols;
     double tau, alpha = 0;
     int i, ntau;
+    int warning = 0;
     int err = 0;
 
     err = get_ci_alpha(&alpha);
@@ -1129,44 +1615,34 @@ static int rq_fit_br (gretl_matrix *y, gretl_matrix *X,
     ntau = gretl_vector_get_length(tauvec);
     tau = gretl_vector_get(tauvec, 0);
 
-    err = br_info_alloc(&rq, n, p, tau, alpha, opt);
-
-    if (!err && ntau > 1) {
+    if (ntau > 1) {
 	tbeta = gretl_zero_matrix_new(p * ntau, 3);
 	if (tbeta == NULL) {
-	    err = E_ALLOC;
-	} 
+	    return E_ALLOC;
+	}
 #if QDEBUG
 	fprintf(stderr, "p = %d, ntau = %d, alpha = %g\n", p, ntau, alpha);
 	fprintf(stderr, "tbeta = %d x %d\n", tbeta->rows, tbeta->cols);
 #endif
-    } 
+#if defined(_OPENMP)
+	if (libset_use_openmp((guint64) ntau * n * p)) {
+	    err = rq_br_process_mp(y, X, tauvec, alpha, opt,
+				   tbeta, &warning);
+	    goto finish;
+	}
+#endif
+    }
+
+    err = br_info_alloc(&rq, n, p, tau, alpha, opt);
 
     for (i=0; i<ntau && !err; i++) {
-	tau = rq.tau = gretl_vector_get(tauvec, i);
+	tau = gretl_vector_get(tauvec, i);
 
 #if QDEBUG
 	fprintf(stderr, "rq_fit_br: i = %d, tau = %g\n", i, tau);
 #endif
 
-	/* preliminary calculations relating to confidence intervals */
-	if (opt & OPT_R) {
-	    /* robust variant */
-	    err = make_nid_qn(y, X, &rq);
-	} else {
-	    /* assuming iid errors */
-	    err = make_iid_qn(X, rq.qn);
-	}
-
-	if (!err) {
-	    /* get the actual estimates */
-	    err = real_br_calc(y, X, tau, &rq, 1);
-	}
-
-	if (!err) {
-	    /* post-process confidence intervals */
-	    err = rq_interpolate_intervals(&rq);
-	}
+	err = rq_br_tau_step(y, X, tau, opt, &rq);
 
 	if (!err) {
 	    if (ntau == 1) {
@@ -1183,7 +1659,16 @@ static int rq_fit_br (gretl_matrix *y, gretl_matrix *X,
 	} 
     }
 
-    if (!err && rq.warning) {
+    if (!err) {
+	warning = rq.warning;
+    }
+    br_info_free(&rq);
+
+#if defined(_OPENMP)
+ finish:
+#endif
+
+    if (!err && warning) {
 	gretl_model_set_int(pmod, "nonunique", 1);
     }
 
@@ -1196,11 +1681,101 @@ static int rq_fit_br (gretl_matrix *y, gretl_matrix *X,
 	}
     }
 
-    br_info_free(&rq);
+    return err;
+}
+
+/* estimate at the @i-th of @ntau values of tau, writing the
+   coefficients and standard errors into @tbeta */
+
+static int rq_fn_tau_step (gretl_matrix *y, gretl_matrix *XT,
+			   double tau, gretlopt opt,
+			   struct fn_info *rq, double *se,
+			   gretl_matrix *tbeta, int ntau, int i,
+			   guint32 seed)
+{
+    integer n = y->rows;
+    integer p = XT->rows;
+    int err;
+
+    rq->tau = tau;
+    rq->warm = 0;
+    pfn_stream_init(rq, seed, i);
+
+    err = rq_solve(&n, &p, XT, y, rq, tau);
+    if (err) {
+	fprintf(stderr, "rqfn gave info = %d\n", rq->info);
+	return err;
+    }
+
+    write_tbeta_block_fn(tbeta, ntau, rq->coeff, p, i, 0);
+    rq_set_warm_start(rq);
+
+    if (opt & OPT_R) {
+	err = rq_fn_nid_VCV(NULL, y, XT, tau, rq, se);
+    } else {
+	err = rq_fn_iid_VCV(NULL, y, XT, tau, rq, se);
+    }
+
+    if (!err) {
+	write_tbeta_block_fn(tbeta, ntau, se, p, i, 1);
+    }
+
+    return err;
+}
+
+#if defined(_OPENMP)
+
+/* Handle multiple tau values in parallel: each thread gets its
+   own workspace and a contiguous block of tau values.
+*/
+
+static int rq_fn_process_mp (gretl_matrix *y, gretl_matrix *XT,
+			     const gretl_vector *tauvec,
+			     gretlopt opt, gretl_matrix *tbeta,
+			     guint32 seed)
+{
+    int ntau = gretl_vector_get_length(tauvec);
+    int n = y->rows;
+    int p = XT->rows;
+    int err = 0;
+
+#pragma omp parallel
+    {
+	struct fn_info rq;
+	double *se;
+	int i, myerr;
+
+	myerr = fn_info_alloc(&rq, n, p, tauvec->val[0], opt);
+	se = malloc(p * sizeof *se);
+	if (!myerr && se == NULL) {
+	    myerr = E_ALLOC;
+	}
+	rq.callback = NULL;
+
+#pragma omp for schedule(static)
+	for (i=0; i<ntau; i++) {
+	    if (!myerr) {
+		myerr = rq_fn_tau_step(y, XT, tauvec->val[i], opt,
+				       &rq, se, tbeta, ntau, i, seed);
+	    }
+	}
+
+#pragma omp critical
+	{
+	    if (myerr && !err) {
+		err = myerr;
+	    }
+	}
+
+	fn_info_free(&rq);
+	free(se);
+    }
 
     return err;
 }
 
+#endif /* _OPENMP */
+
 /* sub-driver for Frisch-Newton interior point variant */
 
 static int rq_fit_fn (gretl_matrix *y, gretl_matrix *XT, 
@@ -1212,6 +1787,7 @@ static int rq_fit_fn (gretl_matrix *y, gretl_matrix *XT,
     double *se = NULL;
     integer n = y->rows;
     integer p = XT->rows;
+    guint32 seed = 0;
     double tau;
     int i, ntau;
     int err = 0;
@@ -1219,58 +1795,67 @@ static int rq_fit_fn (gretl_matrix *y, gretl_matrix *XT,
     ntau = gretl_vector_get_length(tauvec);
     tau = gretl_vector_get(tauvec, 0);
 
-    err = fn_info_alloc(&rq, n, p, tau, opt);
-    if (err) {
-	return err;
+    if (pfn_wanted(n, p)) {
+	/* seed for the subsampling streams */
+	seed = pfn_seed(n, p);
     }
 
     if (ntau > 1) {
 	tbeta = gretl_zero_matrix_new(p * ntau, 2);
+	if (tbeta == NULL) {
+	    return E_ALLOC;
+	}
+#if defined(_OPENMP)
+	if (libset_use_openmp((guint64) ntau * n * p)) {
+	    err = rq_fn_process_mp(y, XT, tauvec, opt, tbeta, seed);
+	    goto finish;
+	}
+#endif
+    }
+
+    err = fn_info_alloc(&rq, n, p, tau, opt);
+    if (!err && ntau > 1) {
 	se = malloc(p * sizeof *se);
-	if (tbeta == NULL || se == NULL) {
+	if (se == NULL) {
 	    err = E_ALLOC;
-	} 
-    } 
-
-    for (i=0; i<ntau && !err; i++) {
-	tau = rq.tau = gretl_vector_get(tauvec, i);
+	}
+    }
 
+    if (!err && ntau > 1) {
+	for (i=0; i<ntau && !err; i++) {
+	    tau = gretl_vector_get(tauvec, i);
 #if QDEBUG
-	fprintf(stderr, "rq_fit_fn: i = %d, tau = %g\n", i, tau);
+	    fprintf(stderr, "rq_fit_fn: i = %d, tau = %g\n", i, tau);
 #endif
-
+	    err = rq_fn_tau_step(y, XT, tau, opt, &rq, se,
+				 tbeta, ntau, i, seed);
+	}
+    } else if (!err) {
 	/* get coefficients and residuals */
-	err = rq_call_FN(&n, &p, XT, y, &rq, tau);
+	pfn_stream_init(&rq, seed, 0);
+	err = rq_solve(&n, &p, XT, y, &rq, tau);
 	if (err) {
 	    fprintf(stderr, "rqfn gave info = %d\n", rq.info);
-	}
-
-	if (!err) {
-	    if (ntau == 1) {
-		/* save coeffs, residuals, etc., before computing VCV */
-		rq_transcribe_results(pmod, y, tau, rq.coeff, rq.resid, 
-				      RQ_STAGE_1);
-	    } else {
-		/* write coeffs for this tau value */
-		write_tbeta_block_fn(tbeta, ntau, rq.coeff, p, i, 0);
-	    }
-	}
-
-	if (!err) {
-	    /* compute covariance matrix */
+	} else {
+	    rq_set_warm_start(&rq);
+	    /* save coeffs, residuals, etc., before computing VCV */
+	    rq_transcribe_results(pmod, y, tau, rq.coeff, rq.resid, 
+				  RQ_STAGE_1);
 	    if (opt & OPT_R) {
-		err = rq_fn_nid_VCV(pmod, y, XT, tau, &rq, se);
+		err = rq_fn_nid_VCV(pmod, y, XT, tau, &rq, NULL);
 	    } else {
-		err = rq_fn_iid_VCV(pmod, y, XT, tau, &rq, se);
+		err = rq_fn_iid_VCV(pmod, y, XT, tau, &rq, NULL);
 	    }
 	}
-
-	if (!err && ntau > 1) {
-	    /* write std errs for this tau */
-	    write_tbeta_block_fn(tbeta, ntau, se, p, i, 1);
-	}
     }
 
+    fn_info_free(&rq);
+    free(se);
+
+#if defined(_OPENMP)
+ finish:
+#endif
+
     if (tbeta != NULL) {
 	/* multiple tau values */
 	if (err) {
@@ -1280,9 +1865,6 @@ static int rq_fit_fn (gretl_matrix *y, gretl_matrix *XT,
 	}
     }
 
-    fn_info_free(&rq);
-    free(se);
-
     return err;
 }
 
@@ -1510,6 +2092,116 @@ static int *good_observations_array (MODEL *pmod)
 
 #define ITERS 500
 
+/* create random sample index array */
+
+static void lad_bootstrap_sample (MODEL *pmod, const int *goodobs,
+				  int *sample)
+{
+    int i, j, n = pmod->nobs;
+
+    for (i=0; i<n; i++) {
+	j = gretl_rand_int_max(n);
+	if (goodobs != NULL) {
+	    sample[i] = goodobs[j];
+	} else {
+	    sample[i] = pmod->t1 + j;
+	}
+    }
+}
+
+#if defined(_OPENMP)
+
+/* Run the bootstrap replications in batches of one per thread.
+   The resampling arrays for each batch are drawn serially, in
+   the same order as in the serial case, so the results do not
+   depend on the number of threads.
+*/
+
+static int lad_bootstrap_mp (MODEL *pmod, DATASET *dset,
+			     double **coeffs, const int *goodobs)
+{
+    struct br_info *rq = NULL;
+    gretl_matrix **y = NULL;
+    gretl_matrix **X = NULL;
+    int *samples = NULL;
+    int *berr = NULL;
+    int n = pmod->nobs;
+    int nc = pmod->ncoeff;
+    int nt = omp_get_max_threads();
+    int i, j, k, nb;
+    int err = 0;
+
+    nt = (nt > ITERS)? ITERS : nt;
+
+    rq = calloc(nt, sizeof *rq);
+    y = calloc(nt, sizeof *y);
+    X = calloc(nt, sizeof *X);
+    berr = calloc(nt, sizeof *berr);
+    samples = malloc((size_t) nt * n * sizeof *samples);
+
+    if (rq == NULL || y == NULL || X == NULL || berr == NULL ||
+	samples == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    for (j=0; j<nt && !err; j++) {
+	y[j] = gretl_matrix_alloc(n, 1);
+	X[j] = gretl_matrix_alloc(n, nc);
+	if (y[j] == NULL || X[j] == NULL) {
+	    err = E_ALLOC;
+	} else {
+	    err = br_info_alloc(&rq[j], n, nc, 0.5, 0.0, OPT_L);
+	    rq[j].callback = NULL;
+	}
+    }
+
+    for (k=0; k<ITERS && !err; k+=nb) {
+	nb = (ITERS - k < nt)? ITERS - k : nt;
+
+	for (j=0; j<nb; j++) {
+	    lad_bootstrap_sample(pmod, goodobs, samples + j * n);
+	}
+
+#pragma omp parallel for private(j)
+	for (j=0; j<nb; j++) {
+	    rq_refill_matrices(pmod, dset, y[j], X[j], samples + j * n);
+	    berr[j] = real_br_calc(y[j], X[j], 0.5, &rq[j], 0);
+	}
+
+	for (j=0; j<nb && !err; j++) {
+	    err = berr[j];
+	    for (i=0; i<nc && !err; i++) {
+		coeffs[i][k+j] = rq[j].coeff[i];
+	    }
+	}
+    }
+
+ bailout:
+
+    if (rq != NULL) {
+	for (j=0; j<nt; j++) {
+	    br_info_free(&rq[j]);
+	}
+    }
+    if (y != NULL) {
+	for (j=0; j<nt; j++) {
+	    gretl_matrix_free(y[j]);
+	    gretl_matrix_free(X[j]);
+	}
+    }
+
+    free(rq);
+    free(y);
+    free(X);
+    free(berr);
+    free(samples);
+
+    return err;
+}
+
+#endif /* _OPENMP */
+
 /* obtain bootstrap estimates of LAD covariance matrix */
 
 static int lad_bootstrap_vcv (MODEL *pmod, DATASET *dset,
@@ -1524,6 +2216,7 @@ static int lad_bootstrap_vcv (MODEL *pmod, DATASET *dset,
     int i, j, k;
     int nc = pmod->ncoeff;
     int nvcv, n = pmod->nobs;
+    int done = 0;
     int err = 0;
 
     /* note: new_vcv sets all entries to zero */
@@ -1555,16 +2248,15 @@ static int lad_bootstrap_vcv (MODEL *pmod, DATASET *dset,
 	} 
     }
 
-    for (k=0; k<ITERS && !err; k++) {
-	/* create random sample index array */
-	for (i=0; i<n; i++) {
-	    j = gretl_rand_int_max(n);
-	    if (goodobs != NULL) {
-		sample[i] = goodobs[j];
-	    } else {
-		sample[i] = pmod->t1 + j;
-	    }
-	}
+#if defined(_OPENMP)
+    if (libset_use_openmp((guint64) ITERS * n * nc)) {
+	err = lad_bootstrap_mp(pmod, dset, coeffs, goodobs);
+	done = 1;
+    }
+#endif
+
+    for (k=0; k<ITERS && !err && !done; k++) {
+	lad_bootstrap_sample(pmod, goodobs, sample);
 
 	rq_refill_matrices(pmod, dset, y, X, sample);
 
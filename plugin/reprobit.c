@@ -24,10 +24,6 @@
 #include "gretl_normal.h"
 #include "libset.h"
 
-#ifdef _OPENMP
-# include <omp.h>
-#endif
-
 typedef struct reprob_container_ reprob_container;
 
 struct reprob_container_ {
@@ -45,7 +41,7 @@ struct reprob_container_ {
     int *unit_start;         /* array of starting indices for units */
     int nobs;                /* total number of observations */
     int qp;                  /* number of quadrature points */
-    int parallel;
+    int cost;                /* relative cost of evaluation per unit */
 
     int *y;	             /* dependent var (0/1) */
     gretl_matrix *X;	     /* main eq. regressors */
@@ -59,7 +55,6 @@ struct reprob_container_ {
     gretl_matrix *lik;       /* probabilities (by individual) */
     gretl_vector *beta;      /* parameters (excluding log of variance 
 				of individual effect) */
-    gretl_matrix *qi;        /* storage for score caculation */
 };
 
 reprob_container *rep_container_new (const int *list)
@@ -73,8 +68,7 @@ reprob_container *rep_container_new (const int *list)
 	C->ll = NADBL;
 	C->N = 0;
 	C->nobs = 0;
-	C->parallel = 0;
-	C->qi = NULL;
+	C->cost = 1;
 
 	C->unit_obs = NULL;
 	C->unit_start = NULL;
@@ -96,7 +90,6 @@ static void rep_container_destroy (reprob_container *C)
 	gretl_matrix_free(C->X);
 	gretl_matrix_free(C->R);
 	gretl_matrix_block_destroy(C->B);
-	gretl_matrix_free(C->qi);
 	free(C);
     }
 }
@@ -291,19 +284,9 @@ static int rep_container_fill (reprob_container *C,
 	gretl_matrix_free(tmp);
     }
 
-#if defined(_OPENMP)
-    if (C->nobs * C->qp > 900 && get_omp_n_threads() > 1) {
-	/* FIXME threshold? */
-	C->parallel = 1;
-    }
-#endif
-
-    if (!C->parallel) {
-	C->qi = gretl_matrix_alloc(1, C->qp);
-	if (C->qi == NULL) {
-	    err = E_ALLOC;
-	}
-    }
+    /* for the purpose of splitting the likelihood calculation
+       into blocks of units */
+    C->cost = (C->nobs * C->qp) / C->N;
 
     return err;
 }
@@ -335,30 +318,33 @@ static double quick_dot_product (const double *x,
     return ret;
 }
 
-static int reprobit_score (double *theta, double *g, int npar, 
-			   BFGS_CRIT_FUNC ll, void *p)
+/* Compute the Q (P) and R matrices for units @s0 to @s1 - 1,
+   and the associated individual likelihoods, then add the
+   contributions of these units to the score, @g.
+*/
+
+static int rep_score_block (void *data, int s0, int s1,
+			    double *ll, double *g)
 {
-    reprob_container *C = (reprob_container *) p;
+    reprob_container *C = data;
     gretl_matrix *Q = C->P; /* re-use existing storage */
     const double *nodes = C->nodes->val;
-    int i, j, k, t;
-    int done = 0;
-    int err = 0;
-
-    k = C->npar - 1;
-    update_ndx(C, theta);
+    const double *wts = C->wts->val;
+    double x, qij, rtj, node, ndxi;
+    double *qi;
+    int i, ii, j, t, sign;
+    int k = C->npar - 1;
 
-    /* form the Q and R matrices */
+    qi = malloc(C->qp * sizeof *qi);
+    if (qi == NULL) {
+	return E_ALLOC;
+    }
 
-#if defined(_OPENMP)
-#pragma omp parallel for private(i, j, t) if (C->parallel)
-#endif    
-    for (i=0; i<C->N; i++) {
+    for (i=s0; i<s1; i++) {
 	int Ti = C->unit_obs[i];
 	int t0 = C->unit_start[i];
-	double x, qij, node, ndxi;
-	int sign;
 
+	C->lik->val[i] = 0.0;
 	for (j=0; j<C->qp; j++) {
 	    node = C->scale * nodes[j];
 	    qij = 1.0;
@@ -371,129 +357,64 @@ static int reprobit_score (double *theta, double *g, int npar,
 		gretl_matrix_set(C->R, t0+t, j, x);
 	    }
 	    gretl_matrix_set(Q, i, j, qij);
+	    C->lik->val[i] += qij * wts[j];
 	}
-    }
-
-    gretl_matrix_multiply(Q, C->wts, C->lik);
-
-    for (i=0; i<C->npar; i++) {
-	g[i] = 0.0;
-    }
-
-#if defined(_OPENMP)
-    if (C->parallel) {
-	double *qi, *all_qi = NULL;
-	
-#pragma omp parallel private(i, j, t, qi)
-	{
-	    int nt = omp_get_num_threads();
-	    int tid = omp_get_thread_num();
-
-	    if (tid == 0) {
-		/* master: allocate workspace for all */
-		all_qi = malloc(nt * C->qp * sizeof *all_qi);
-		if (all_qi == NULL) {
-		    err = E_ALLOC;
-		}
-	    }
-
-#pragma omp barrier	    
-	    qi = err ? NULL : all_qi + tid * C->qp;
-
-#pragma omp for
-	    for (i=0; i<C->N; i++) {
-		int ii, Ti = C->unit_obs[i];
-		int t0 = C->unit_start[i];
-		double x, qij, rtj;
 
-		if (qi == NULL) {
-		    continue;
+	for (ii=0; ii<=k; ii++) {
+	    for (j=0; j<C->qp; j++) {
+		x = qi[j] = 0.0;
+		qij = gretl_matrix_get(Q, i, j);
+		if (ii == k) {
+		    x = C->scale * nodes[j];
 		}
-
-		for (ii=0; ii<=k; ii++) {
-		    for (j=0; j<C->qp; j++) {
-			x = qi[j] = 0.0;
-			qij = gretl_matrix_get(Q, i, j);
-			if (ii == k) {
-			    x = C->scale * nodes[j];
-			}
-			for (t=0; t<Ti; t++) {
-			    if (ii < k) {
-				x = gretl_matrix_get(C->X, t0+t, ii);
-			    }
-			    rtj = gretl_matrix_get(C->R, t0+t, j);
-			    qi[j] += x * rtj * qij;
-			}
-			qi[j] /= C->lik->val[i];
+		for (t=0; t<Ti; t++) {
+		    if (ii < k) {
+			x = gretl_matrix_get(C->X, t0+t, ii);
 		    }
-		    x = quick_dot_product(qi, C->wts->val, C->qp);
-#pragma omp atomic		
-		    g[ii] += x;
+		    rtj = gretl_matrix_get(C->R, t0+t, j);
+		    qi[j] += x * rtj * qij;
 		}
+		qi[j] /= C->lik->val[i];
 	    }
+	    g[ii] += quick_dot_product(qi, wts, C->qp);
 	}
-	free(all_qi);
-	done = 1;
     }
-#endif /* _OPENMP */
 
-    if (!done) {
-	/* single-threaded variant */
-	double *qi = C->qi->val;
-	
-	for (i=0; i<C->N; i++) {
-	    int ii, Ti = C->unit_obs[i];
-	    int t0 = C->unit_start[i];
-	    double x, qij, rtj;
-
-	    for (ii=0; ii<=k; ii++) {
-		for (j=0; j<C->qp; j++) {
-		    x = qi[j] = 0.0;
-		    qij = gretl_matrix_get(Q, i, j);
-		    if (ii == k) {
-			x = C->scale * nodes[j];
-		    }
-		    for (t=0; t<Ti; t++) {
-			if (ii < k) {
-			    x = gretl_matrix_get(C->X, t0+t, ii);
-			}
-			rtj = gretl_matrix_get(C->R, t0+t, j);
-			qi[j] += x * rtj * qij;
-		    }
-		    qi[j] /= C->lik->val[i];
-		}
-		g[ii] += quick_dot_product(qi, C->wts->val, C->qp);
-	    }
-	}
-    }
+    free(qi);
 
-    g[k] /= 2;
+    return 0;
+}
+
+static int reprobit_score (double *theta, double *g, int npar, 
+			   BFGS_CRIT_FUNC ll, void *p)
+{
+    reprob_container *C = (reprob_container *) p;
+    double llsum;
+    int err;
+
+    update_ndx(C, theta);
+    err = ll_block_sum_units(rep_score_block, C, C->N, C->npar * C->cost,
+			     C->npar, &llsum, g);
+    g[C->npar-1] /= 2;
     
     return err;
 }
 
-static double reprobit_ll (const double *theta, void *p)
+/* loglikelihood contributions of units @s0 to @s1 - 1 */
+
+static int rep_ll_block (void *data, int s0, int s1,
+			 double *ll, double *g)
 {
-    reprob_container *C = (reprob_container *) p;
+    reprob_container *C = data;
+    const double *wts = C->wts->val;
     double x, pij, node;
     int i, j, t;
-    int err = 0;
 
-    if (theta[C->npar-1] < -9.0) {
-	fprintf(stderr, "reprobit_ll: scale too small\n");
-	return NADBL;
-    }
-
-    update_ndx(C, theta);
-    gretl_matrix_zero(C->P);
-
-#if defined(_OPENMP)
-#pragma omp parallel for private(i, j, t, node, pij, x) if (C->parallel)
-#endif
-    for (i=0; i<C->N; i++) {
+    for (i=s0; i<s1; i++) {
 	int Ti = C->unit_obs[i];
 	int t0 = C->unit_start[i];
 
+	C->lik->val[i] = 0.0;
 	for (j=0; j<C->qp; j++) {
 	    node = gretl_vector_get(C->nodes, j);
 	    pij = 1.0;
@@ -506,29 +427,28 @@ static double reprobit_ll (const double *theta, void *p)
 		}
 	    }
 	    gretl_matrix_set(C->P, i, j, pij);
+	    C->lik->val[i] += pij * wts[j];
 	}
+	*ll += log(C->lik->val[i]);
     }
 
-    err = gretl_matrix_multiply(C->P, C->wts, C->lik);
+    return 0;
+}
 
-#if 0
-    if (1) {
-	/* for analysing the behavior of f(x) */
-	static int iter;
-	char pname[8];
+static double reprobit_ll (const double *theta, void *p)
+{
+    reprob_container *C = (reprob_container *) p;
+    int err;
 
-	sprintf(pname, "P%d.mat", iter);
-	gretl_matrix_write_as_text(C->P, pname, 0);
-	iter++;
+    if (theta[C->npar-1] < -9.0) {
+	fprintf(stderr, "reprobit_ll: scale too small\n");
+	return NADBL;
     }
-#endif
 
-    if (!err) {
-	C->ll = 0.0;
-	for (i=0; i<C->N; i++) {
-	    C->ll += log(C->lik->val[i]);
-	}
-    } else {
+    update_ndx(C, theta);
+    err = ll_block_sum_units(rep_ll_block, C, C->N, C->cost,
+			     0, &C->ll, NULL);
+    if (err) {
 	C->ll = NADBL;
     }
 
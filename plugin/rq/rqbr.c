@@ -18,7 +18,7 @@ int rqbr_ (int n, int pp, double *x, double *y, double tau,
 	   double big, int rmax, int ci1,
 	   void (*callback)(void))
 {
-    static double d, a1, b1;
+    double d, a1, b1;
     int i, j, k, l, jj;
     int n1, n2, n3, n4, p1, p2;
     int kd, kl = 0, in = 0, kr = 0;
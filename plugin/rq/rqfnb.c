@@ -98,11 +98,11 @@ static int lpfnb_ (integer *n, integer *p, doublereal *a, doublereal *c__,
     integer a_dim1 = *p, ada_dim1 = *p;
     integer a_offset = 1 + a_dim1, ada_offset = 1 + ada_dim1;
     doublereal d1, d2;
-    static doublereal g;
-    static integer i;
-    static doublereal mu, gap;
-    static doublereal dsdw, dxdz;
-    static doublereal deltad, deltap;
+    doublereal g;
+    integer i;
+    doublereal mu, gap;
+    doublereal dsdw, dxdz;
+    doublereal deltad, deltap;
     int main_iters = 0;
     int err = 0;
 
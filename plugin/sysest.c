@@ -125,11 +125,25 @@ static int make_liml_X_block (gretl_matrix *X, const MODEL *pmod,
     return err;
 }
 
-/* construct the X data block pertaining to a specific equation, using
-   either the original data or fitted values from regression on a set
-   of instruments 
+/* retrieve the series supplying regressor @i of the equation
+   estimated in @pmod: either the original data or fitted values
+   from regression on a set of instruments
 */
 
+static const double *sys_X_series (const MODEL *pmod, DATASET *dset,
+				   int i, int method)
+{
+    if (method == SYS_METHOD_3SLS || 
+	method == SYS_METHOD_FIML || 
+	method == SYS_METHOD_TSLS) {
+	return model_get_Xi(pmod, dset, i);
+    } else {
+	return dset->Z[pmod->list[i+2]];
+    }
+}
+
+/* construct the X data block pertaining to a specific equation */
+
 static int 
 make_sys_X_block (gretl_matrix *X, const MODEL *pmod,
 		  DATASET *dset, int t1, int method)
@@ -140,13 +154,7 @@ make_sys_X_block (gretl_matrix *X, const MODEL *pmod,
     X->cols = pmod->ncoeff;
 
     for (i=0; i<X->cols && !err; i++) {
-	if (method == SYS_METHOD_3SLS || 
-	    method == SYS_METHOD_FIML || 
-	    method == SYS_METHOD_TSLS) {
-	    Xi = model_get_Xi(pmod, dset, i);
-	} else {
-	    Xi = dset->Z[pmod->list[i+2]];
-	}
+	Xi = sys_X_series(pmod, dset, i, method);
 	if (Xi == NULL) {
 	    err = E_DATA;
 	} else {
@@ -159,6 +167,249 @@ make_sys_X_block (gretl_matrix *X, const MODEL *pmod,
     return err;
 }
 
+/* The GLS system estimators require X'(S^{-1} (x) I)X and
+   X'(S^{-1} (x) I)y, where X is block-diagonal in the per-equation
+   regressor matrices X_i. Block (i,j) of the first is s^{ij} X_i'X_j
+   and block i of the second is sum_l s^{il} X_i'y_l, so all the
+   dependence on the data is carried by the cross-products X_i'X_j
+   and X_i'y_l, which do not change when S is re-estimated. Here
+   we compute them once: on return @G holds the X_i'X_j blocks
+   (mk x mk) and @H the X_i'y_l columns (mk x m). If @cross is
+   zero only the diagonal blocks, and X_i'y_i, are computed.
+*/
+
+static int make_sys_moments (equation_system *sys, DATASET *dset,
+			     int mk, int cross, gretl_matrix **pG,
+			     gretl_matrix **pH)
+{
+    MODEL **models = sys->models;
+    int m = sys->neqns;
+    int T = sys->T;
+    gretl_matrix *W, *Y, *G, *H;
+    gretl_matrix Wi, Mi;
+    const double *x;
+    int i, j, l, t, off;
+    int err = 0;
+
+    W = gretl_matrix_alloc(T, mk);
+    Y = gretl_matrix_alloc(T, m);
+    G = gretl_zero_matrix_new(mk, mk);
+    H = gretl_zero_matrix_new(mk, m);
+
+    if (W == NULL || Y == NULL || G == NULL || H == NULL) {
+	err = E_ALLOC;
+	goto bailout;
+    }
+
+    /* stack the regressors of all equations side by side,
+       and likewise the dependent variables */
+    off = 0;
+    for (i=0; i<m && !err; i++) {
+	for (j=0; j<models[i]->ncoeff && !err; j++) {
+	    x = sys_X_series(models[i], dset, j, sys->method);
+	    if (x == NULL) {
+		err = E_DATA;
+	    } else {
+		memcpy(W->val + (off + j) * T, x + sys->t1, 
+		       T * sizeof *x);
+	    }
+	}
+	off += models[i]->ncoeff;
+	x = dset->Z[system_get_depvar(sys, i)];
+	memcpy(Y->val + i * T, x + sys->t1, T * sizeof *x);
+    }
+
+    if (err) {
+	goto bailout;
+    }
+
+    if (cross) {
+	err = gretl_matrix_multiply_mod(W, GRETL_MOD_TRANSPOSE,
+					W, GRETL_MOD_NONE,
+					G, GRETL_MOD_NONE);
+	if (!err) {
+	    err = gretl_matrix_multiply_mod(W, GRETL_MOD_TRANSPOSE,
+					    Y, GRETL_MOD_NONE,
+					    H, GRETL_MOD_NONE);
+	}
+    } else {
+	int k = system_max_indep_vars(sys);
+	const double *yi;
+	double hj;
+
+	gretl_matrix_init(&Wi);
+	gretl_matrix_init(&Mi);
+	Mi.val = malloc(k * k * sizeof *Mi.val);
+	if (Mi.val == NULL) {
+	    err = E_ALLOC;
+	    goto bailout;
+	}
+	Wi.rows = T;
+	off = 0;
+	for (i=0; i<m && !err; i++) {
+	    Wi.cols = Mi.rows = Mi.cols = models[i]->ncoeff;
+	    Wi.val = W->val + off * T;
+	    yi = Y->val + i * T;
+	    err = gretl_matrix_multiply_mod(&Wi, GRETL_MOD_TRANSPOSE,
+					    &Wi, GRETL_MOD_NONE,
+					    &Mi, GRETL_MOD_NONE);
+	    for (j=0; j<Wi.cols && !err; j++) {
+		for (l=0; l<Wi.cols; l++) {
+		    gretl_matrix_set(G, off + l, off + j,
+				     Mi.val[j * Mi.rows + l]);
+		}
+		x = Wi.val + j * T;
+		hj = 0.0;
+		for (t=0; t<T; t++) {
+		    hj += x[t] * yi[t];
+		}
+		gretl_matrix_set(H, off + j, i, hj);
+	    }
+	    off += Wi.cols;
+	}
+	free(Mi.val);
+    }
+
+ bailout:
+
+    gretl_matrix_free(W);
+    gretl_matrix_free(Y);
+
+    if (err) {
+	gretl_matrix_free(G);
+	gretl_matrix_free(H);
+    } else {
+	*pG = G;
+	*pH = H;
+    }
+
+    return err;
+}
+
+/* Write the leading mk x mk block of @X and the first mk elements
+   of @y, using the cross-products in @G and @H (see
+   make_sys_moments() above). The blocks are scaled by the elements
+   of @S, or by 1.0 if @S is NULL; if @diag is non-zero the
+   cross-equation terms are omitted.
+*/
+
+static void fill_sys_from_moments (equation_system *sys,
+				   const gretl_matrix *G,
+				   const gretl_matrix *H,
+				   const gretl_matrix *S,
+				   int diag, gretl_matrix *X,
+				   gretl_matrix *y)
+{
+    MODEL **models = sys->models;
+    int m = sys->neqns;
+    int i, j, l, r, c;
+    int roff = 0, coff;
+    double sij, yr;
+
+    for (i=0; i<m; i++) {
+	int ki = models[i]->ncoeff;
+
+	coff = 0;
+	for (j=0; j<m; j++) {
+	    int kj = models[j]->ncoeff;
+
+	    if (diag && j != i) {
+		sij = 0.0;
+	    } else {
+		sij = (S == NULL)? 1.0 : gretl_matrix_get(S, i, j);
+	    }
+	    for (c=0; c<kj; c++) {
+		for (r=0; r<ki; r++) {
+		    gretl_matrix_set(X, roff + r, coff + c, sij *
+				     gretl_matrix_get(G, roff + r, coff + c));
+		}
+	    }
+	    coff += kj;
+	}
+
+	for (r=0; r<ki; r++) {
+	    if (diag) {
+		sij = (S == NULL)? 1.0 : gretl_matrix_get(S, i, i);
+		yr = sij * gretl_matrix_get(H, roff + r, i);
+	    } else {
+		yr = 0.0;
+		for (l=0; l<m; l++) {
+		    sij = (S == NULL)? 1.0 : gretl_matrix_get(S, i, l);
+		    yr += sij * gretl_matrix_get(H, roff + r, l);
+		}
+	    }
+	    gretl_vector_set(y, roff + r, yr);
+	}
+
+	roff += ki;
+    }
+}
+
+/* LIML: form the single-equation k-class moment matrices
+   X_i'Z_i and X_i'y_i, where Z_i and y_i hold the transformed
+   data placed on the models by liml_driver().
+*/
+
+static int fill_liml_system (equation_system *sys, DATASET *dset,
+			     gretl_matrix *X, gretl_matrix *y)
+{
+    MODEL **models = sys->models;
+    gretl_matrix *Xi = NULL;
+    gretl_matrix *Zi = NULL;
+    gretl_matrix *M = NULL;
+    const double *yl;
+    double yv;
+    int T = sys->T;
+    int k = system_max_indep_vars(sys);
+    int i, j, t, v = 0;
+    int err = 0;
+
+    Xi = gretl_matrix_alloc(T, k);
+    Zi = gretl_matrix_alloc(T, k);
+    M = gretl_matrix_alloc(k, k);
+
+    if (Xi == NULL || Zi == NULL || M == NULL) {
+	err = E_ALLOC;
+    } else {
+	gretl_matrix_zero(X);
+    }
+
+    for (i=0; i<sys->neqns && !err; i++) {
+	err = make_sys_X_block(Xi, models[i], dset, sys->t1, 
+			       SYS_METHOD_LIML);
+	if (!err) {
+	    err = make_liml_X_block(Zi, models[i], dset, sys->t1);
+	}
+	if (!err) {
+	    M->rows = Xi->cols;
+	    M->cols = Zi->cols;
+	    err = gretl_matrix_multiply_mod(Xi, GRETL_MOD_TRANSPOSE,
+					    Zi, GRETL_MOD_NONE, 
+					    M, GRETL_MOD_NONE);
+	}
+	if (!err) {
+	    insert_sys_X_block(X, M, v, v, 1.0);
+	    yl = gretl_model_get_data(models[i], "liml_y");
+	    if (yl == NULL) {
+		err = E_DATA;
+	    }
+	}
+	for (j=0; j<Xi->cols && !err; j++) {
+	    yv = 0.0;
+	    for (t=0; t<T; t++) {
+		yv += gretl_matrix_get(Xi, t, j) * yl[t + sys->t1];
+	    }
+	    gretl_vector_set(y, v++, yv);
+	}
+    }
+
+    gretl_matrix_free(Xi);
+    gretl_matrix_free(Zi);
+    gretl_matrix_free(M);
+
+    return err;
+}
+
 /* Populate the cross-equation covariance matrix, @S, based on
    the per-equation residuals: if @do_diag is non-zero we also
    want to compute the Breusch-Pagan test for diagonality
@@ -819,37 +1070,20 @@ static gretlopt sys_tsls_opt (const equation_system *sys)
     return opt;
 }
 
-static int allocate_Xi_etc (gretl_matrix **Xi,
-			    gretl_matrix **Xj,
-			    gretl_matrix **M,
-			    int T, int k)
-{
-    *Xi = gretl_matrix_alloc(T, k);
-    *Xj = gretl_matrix_alloc(T, k);
-    *M = gretl_matrix_alloc(k, k);
-
-    if (*Xi == NULL || *Xj == NULL || *M == NULL) {
-	return E_ALLOC;
-    } else {
-	return 0;
-    }
-}
-
 /* general function that forms the basis for all specific system
    estimators */
 
 int system_estimate (equation_system *sys, DATASET *dset, 
 		     gretlopt opt, PRN *prn)
 {
-    int i, j, k, T, t;
-    int v, l, mk, krow, nr;
+    int i, T, t;
+    int mk, nr;
     int orig_t1 = dset->t1;
     int orig_t2 = dset->t2;
     gretl_matrix *X = NULL;
     gretl_matrix *y = NULL;
-    gretl_matrix *Xi = NULL;
-    gretl_matrix *Xj = NULL;
-    gretl_matrix *M = NULL;
+    gretl_matrix *G = NULL;
+    gretl_matrix *H = NULL;
     MODEL **models = NULL;
     int method = sys->method;
     double llbak = -1.0e9;
@@ -897,9 +1131,6 @@ int system_estimate (equation_system *sys, DATASET *dset,
     dset->t1 = sys->t1;
     dset->t2 = sys->t2;
 
-    /* max indep vars per equation */
-    k = system_max_indep_vars(sys);
-
     /* total indep vars, all equations */
     mk = system_n_indep_vars(sys);
 
@@ -1005,11 +1236,8 @@ int system_estimate (equation_system *sys, DATASET *dset,
 #endif
 
     if (method == SYS_METHOD_WLS) {
-	gretl_matrix_zero(X);
 	err = gretl_invert_diagonal_matrix(sys->S);
-    } else if (single_equation || rsingle) {
-	gretl_matrix_zero(X);
-    } else {
+    } else if (!single_equation && !rsingle) {
 	err = gretl_invert_symmetric_matrix(sys->S);    
     }
 
@@ -1017,61 +1245,30 @@ int system_estimate (equation_system *sys, DATASET *dset,
     fprintf(stderr, "system_estimate: on invert, err=%d\n", err);
 #endif
 
-    if (!err && Xi == NULL) {
-	/* the test against NULL here allows for the possibility
-	   that we're iterating 
-	*/
-	err = allocate_Xi_etc(&Xi, &Xj, &M, T, k);
-    }
-
     if (err) goto cleanup;
 
-    /* form the big stacked X matrix: Xi = data matrix for equation i, 
-       specified in lists[i] 
+    /* form the big stacked X matrix and y vector: if we're
+       iterating, the per-equation cross-products computed on the
+       first pass are reused and only the scaling by the elements
+       of sigma-inverse changes
     */
 
-    krow = 0;
-    for (i=0; i<sys->neqns && !err; i++) {
-	int kcol = 0;
-
-	err = make_sys_X_block(Xi, models[i], dset, sys->t1, method);
-
-	for (j=0; j<=i && !err; j++) { 
-	    const gretl_matrix *Xk;
-	    double sij;
-
-	    if (i != j) {
-		if (single_equation || rsingle) {
-		    kcol += models[j]->ncoeff;
-		    continue;
-		}
-		err = make_sys_X_block(Xj, models[j], dset, sys->t1, method);
-		Xk = Xj;
-	    } else if (method == SYS_METHOD_LIML) {
-		err = make_liml_X_block(Xj, models[i], dset, sys->t1);
-		Xk = Xj;
-	    } else {
-		Xk = Xi;
-	    }
-
-	    M->rows = Xi->cols;
-	    M->cols = Xk->cols;
-
-	    err = gretl_matrix_multiply_mod(Xi, GRETL_MOD_TRANSPOSE,
-					    Xk, GRETL_MOD_NONE, 
-					    M, GRETL_MOD_NONE);
+    if (method == SYS_METHOD_LIML) {
+	err = fill_liml_system(sys, dset, X, y);
+    } else {
+	if (G == NULL) {
+	    err = make_sys_moments(sys, dset, mk, !single_equation,
+				   &G, &H);
+	}
+	if (!err) {
+	    const gretl_matrix *S = sys->S;
 
 	    if (rsingle || (single_equation && method != SYS_METHOD_WLS)) {
-		sij = 1.0;
-	    } else {
-		sij = gretl_matrix_get(sys->S, i, j);
+		S = NULL;
 	    }
-
-	    insert_sys_X_block(X, M, krow, kcol, sij);
-	    kcol += models[j]->ncoeff;
+	    fill_sys_from_moments(sys, G, H, S, single_equation || rsingle,
+				  X, y);
 	}
-
-	krow += models[i]->ncoeff;
     }
 
     if (err) {
@@ -1082,67 +1279,6 @@ int system_estimate (equation_system *sys, DATASET *dset,
     if (nr > 0) {
 	/* there are restrictions to be imposed */
 	augment_X_with_restrictions(X, mk, sys);
-    }
-
-    if (!do_iteration && !rsingle) {
-	/* we're not coming back this way, so free some storage */
-	gretl_matrix_free(Xj);
-	Xj = NULL;
-	gretl_matrix_free(M);
-	M = NULL;
-    }
-
-    /* form stacked Y column vector (m x k) */
-
-    v = 0;
-    for (i=0; i<sys->neqns; i++) { 
-
-	/* loop over the m vertically-arranged blocks */
-
-	make_sys_X_block(Xi, models[i], dset, sys->t1, method);
-
-	for (j=0; j<models[i]->ncoeff; j++) { 
-	    /* loop over the rows within each of the m blocks */
-	    double yv = 0.0;
-	    int lmin = 0, lmax = sys->neqns;
-
-	    if (single_equation || rsingle) {
-		/* no cross terms wanted */
-		lmin = i;
-		lmax = i + 1;
-	    }
-
-	    for (l=lmin; l<lmax; l++) { 
-		/* loop over the components that must be
-		   added to form each element */
-		const double *yl = NULL;
-		double sil, xx = 0.0;
-
-		if (method == SYS_METHOD_LIML) {
-		    yl = gretl_model_get_data(models[l], "liml_y");
-		} else {
-		    yl = dset->Z[system_get_depvar(sys, l)];
-		}
-
-		/* multiply X'[l] into y */
-		for (t=0; t<T; t++) {
-		    xx += gretl_matrix_get(Xi, t, j) * yl[t + sys->t1];
-		}
-
-		if (rsingle || (single_equation && method != SYS_METHOD_WLS)) {
-		    sil = 1.0;
-		} else {
-		    sil = gretl_matrix_get(sys->S, i, l);
-		}
-
-		yv += xx * sil;
-	    }
-	    gretl_vector_set(y, v++, yv);
-	}
-    }
-
-    if (nr > 0) {
-	/* there are restrictions */
 	augment_y_with_restrictions(y, mk, nr, sys);
     }
 
@@ -1193,9 +1329,8 @@ int system_estimate (equation_system *sys, DATASET *dset,
 
  cleanup:
 
-    gretl_matrix_free(Xi);
-    gretl_matrix_free(Xj);
-    gretl_matrix_free(M);
+    gretl_matrix_free(G);
+    gretl_matrix_free(H);
     gretl_matrix_free(X);
     gretl_matrix_free(y);
 